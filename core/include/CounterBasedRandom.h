@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+/// Random numbers which only depend on a key and a counter, so that they can
+/// be generated in any order and by any number of threads
+namespace CounterBasedRandom {
+const uint64_t goldenGamma = 0x9e3779b97f4a7c15ULL;
+
+/// SplitMix64 finaliser
+inline uint64_t mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+/// @return - key for a stream of random numbers
+inline uint64_t getKey(const uint64_t seed, const uint64_t streamNumber) {
+  return mix(seed + mix(streamNumber + goldenGamma));
+}
+
+/// @return - the random number at the given position in the stream
+inline uint64_t get(const uint64_t key, const uint64_t counter) {
+  return mix(key + (counter + 1) * goldenGamma);
+}
+
+/// Map a 32-bit random number onto [0, range) with a multiply instead of a
+/// division, the bias is negligible for the ranges used here
+inline uint32_t reduce(const uint32_t random, const uint32_t range) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(random) * range) >> 32);
+}
+} // namespace CounterBasedRandom
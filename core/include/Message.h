@@ -1,15 +1,41 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstring>
 #include <flatbuffers/flatbuffers.h>
 
 namespace Streamer {
 
+/// Allocator for messages which refer to a buffer owned by something else, it
+/// never frees the buffer
+class UnownedAllocator : public flatbuffers::Allocator {
+public:
+  uint8_t *allocate(size_t) override { return nullptr; }
+  void deallocate(uint8_t *, size_t) override {}
+};
+
 class Message {
 public:
   explicit Message(flatbuffers::DetachedBuffer InputBuffer)
       : Buffer(std::move(InputBuffer)) {}
 
+  /// Create a message which refers to a buffer owned by something else, for
+  /// example a cache of serialised messages, which must outlive the message
+  static Message fromUnownedBuffer(uint8_t *Data, size_t Size) {
+    static UnownedAllocator Allocator;
+    return Message(
+        flatbuffers::DetachedBuffer(&Allocator, false, Data, Size, Data, Size));
+  }
+
+  /// Create a message which owns a copy of a serialised message
+  static Message fromCopy(const uint8_t *Data, size_t Size) {
+    static flatbuffers::DefaultAllocator Allocator;
+    auto Copy = Allocator.allocate(Size);
+    std::memcpy(Copy, Data, Size);
+    return Message(
+        flatbuffers::DetachedBuffer(&Allocator, false, Copy, Size, Copy, Size));
+  }
+
   char *data() { return reinterpret_cast<char *>(Buffer.data()); }
   size_t size() { return Buffer.size(); }
 
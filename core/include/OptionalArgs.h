@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 struct OptionalArgs {
   std::pair<int32_t, int32_t> minMaxDetectorNums = {0, 0};
@@ -9,10 +10,38 @@ struct OptionalArgs {
   std::string broker;
   std::string instrumentName = "test";
   std::string compression;
+  std::vector<std::string> topicProducerOptions;
   std::string jsonDescription;
+  std::string recordFilename;
+  std::string replayFilename;
+  std::string publisherType = "kafka";
+  std::string outputDirectory = ".";
+  std::string ringFilename;
   bool slow = false;
   bool quietMode = false;
   bool singleRun = false;
+  uint32_t runPauseMs = 2000;
+  bool useSidecarIndex = false;
+  bool mergeGroups = false;
+  bool detSpecMapOnOwnTopic = false;
+  uint32_t maxEventsPerMessage = 0;
+  std::vector<uint32_t> splitDetectorIDs;
+  bool ev44 = false;
+  uint32_t ev44BatchWindowMs = 0;
+  uint32_t replayCacheSizeMB = 0;
+  uint32_t ringLaneSizeMB = 64;
+  uint32_t ringConsumerTimeoutMs = 5000;
   int32_t fakeEventsPerPulse = 0;
+  uint64_t fakeEventSeed = 0;
+  std::string fakeEventSampling = "uniform";
+  uint32_t amplificationFactor = 1;
+  uint32_t amplificationDetectorIDOffset = 0;
+  uint32_t amplificationTimeOfFlightJitterNs = 0;
+  double syntheticPulseRateHz = 0;
+  uint32_t syntheticRunDurationS = 0;
+  std::string syntheticEventDistribution = "poisson";
   uint32_t histogramUpdatePeriodMs = 0;
+  uint32_t sampleEnvBatchSize = 0;
+  uint32_t sampleEnvBatchIntervalMs = 1000;
+  std::vector<std::string> logFilters;
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Samples indices in proportion to a list of weights in constant time, using
+ * Vose's alias method. Each column holds the probability of keeping its own
+ * index and the index to use otherwise.
+ */
+class AliasTable {
+public:
+  explicit AliasTable(const std::vector<double> &weights);
+
+  /**
+   * @param columnRandom - uniformly distributed, chooses the column
+   * @param acceptRandom - uniformly distributed, chooses between the column
+   * and its alias
+   * @return - an index into the weights
+   */
+  uint32_t sample(const uint32_t columnRandom,
+                  const uint32_t acceptRandom) const {
+    const auto &column = m_columns[static_cast<uint32_t>(
+        (static_cast<uint64_t>(columnRandom) * m_columns.size()) >> 32)];
+    return acceptRandom < column.threshold ? column.index : column.alias;
+  }
+
+  size_t size() const { return m_columns.size(); }
+
+private:
+  struct Column {
+    /// Probability of keeping the index, scaled to 2^32
+    uint32_t threshold;
+    uint32_t index;
+    uint32_t alias;
+  };
+  std::vector<Column> m_columns;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "AliasTable.h"
+
+struct HistogramFrame;
+class DetectorSpectrumMapData;
+
+/*
+ * Distributions of detector IDs and times of flight of events, measured from
+ * a real file, which fake events are sampled from in constant time. Detector
+ * IDs and times of flight are sampled independently of each other, so hot
+ * pixels and time of flight peaks are reproduced but not the correlation
+ * between them.
+ */
+class EventDistribution {
+public:
+  EventDistribution(std::vector<uint32_t> detectorIDs,
+                    const std::vector<double> &detectorWeights,
+                    std::vector<uint32_t> timeOfFlightBinEdges,
+                    const std::vector<double> &timeOfFlightWeights);
+
+  static EventDistribution
+  fromHistograms(const std::vector<HistogramFrame> &histograms,
+                 const DetectorSpectrumMapData *detSpecMap);
+
+  /**
+   * Sample an event from two uniformly distributed random numbers
+   *
+   * @param detectorRandom - chooses the detector ID
+   * @param timeOfFlightRandom - chooses the time of flight
+   * @param detectorID - output detector ID
+   * @param timeOfFlight - output time of flight in nanoseconds
+   */
+  void sample(const uint64_t detectorRandom, const uint64_t timeOfFlightRandom,
+              uint32_t &detectorID, uint32_t &timeOfFlight) const {
+    detectorID = m_detectorIDs[m_detectorTable.sample(
+        static_cast<uint32_t>(detectorRandom >> 32),
+        static_cast<uint32_t>(detectorRandom))];
+    const auto columnRandom = static_cast<uint32_t>(timeOfFlightRandom >> 32);
+    const auto bin = m_timeOfFlightTable.sample(
+        columnRandom, static_cast<uint32_t>(timeOfFlightRandom));
+    // The remainder of choosing the column is uniformly distributed, so use
+    // it for the position within the bin
+    const auto positionInBin = static_cast<uint32_t>(
+        static_cast<uint64_t>(columnRandom) * m_timeOfFlightTable.size());
+    const auto binWidth = m_timeOfFlightBinEdges[bin + 1] -
+                          m_timeOfFlightBinEdges[bin];
+    timeOfFlight = m_timeOfFlightBinEdges[bin] +
+                   static_cast<uint32_t>(
+                       (static_cast<uint64_t>(positionInBin) * binWidth) >> 32);
+  }
+
+  const std::vector<uint32_t> &getDetectorIDs() const {
+    return m_detectorIDs;
+  }
+  const std::vector<uint32_t> &getTimeOfFlightBinEdges() const {
+    return m_timeOfFlightBinEdges;
+  }
+
+private:
+  std::vector<uint32_t> m_detectorIDs;
+  AliasTable m_detectorTable;
+  /// In nanoseconds, one more than the number of bins
+  std::vector<uint32_t> m_timeOfFlightBinEdges;
+  AliasTable m_timeOfFlightTable;
+};
+
+/*
+ * Counts events by detector ID and time of flight, to build an
+ * EventDistribution from event data which is read in chunks
+ */
+class EventDistributionBuilder {
+public:
+  void addEvents(const std::vector<uint32_t> &detectorIDs,
+                 const std::vector<uint32_t> &timeOfFlights);
+  uint64_t getNumberOfEvents() const { return m_numberOfEvents; }
+  EventDistribution build() const;
+
+  /// Width of the time of flight bins in nanoseconds
+  static const uint32_t timeOfFlightBinWidth = 1000;
+  /// Later times of flight are counted in the last bin, this is 1 second
+  static const uint32_t maxNumberOfTimeOfFlightBins = 1000000;
+
+private:
+  std::unordered_map<uint32_t, uint64_t> m_detectorCounts;
+  std::vector<uint64_t> m_timeOfFlightCounts;
+  uint64_t m_numberOfEvents = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../../core/include/EventDataFrame.h"
+#include "EventDistribution.h"
+
+/*
+ * Generates fake events with uniformly distributed detector IDs and times of
+ * flight, or sampled from distributions measured from a real file. Each event
+ * is derived from a counter-based random number generator keyed by the seed,
+ * the stream number and the index of the event, so that large pulses can be
+ * generated by several threads directly into the output buffers and the events
+ * only depend on the seed and stream number, not on the number of threads.
+ */
+class FakeEventGenerator {
+public:
+  FakeEventGenerator(const std::vector<int32_t> &detectorNumbers,
+                     uint64_t seed, uint32_t numberOfThreads = 0);
+  FakeEventGenerator(std::shared_ptr<const EventDistribution> distribution,
+                     uint64_t seed, uint32_t numberOfThreads = 0);
+
+  EventDataFrame generate(uint64_t streamNumber, size_t numberOfEvents) const;
+  void generate(uint64_t streamNumber, uint32_t *detectorIDs,
+                uint32_t *timeOfFlights, size_t numberOfEvents) const;
+
+  static const uint32_t minTimeOfFlight = 10000;
+  static const uint32_t maxTimeOfFlight = 100000;
+
+private:
+  void generateRange(uint64_t key, uint32_t *detectorIDs,
+                     uint32_t *timeOfFlights, size_t firstEvent,
+                     size_t lastEvent) const;
+
+  void sampleRange(uint64_t key, uint32_t *detectorIDs,
+                   uint32_t *timeOfFlights, size_t firstEvent,
+                   size_t lastEvent) const;
+
+  const uint64_t m_seed;
+  uint32_t m_numberOfThreads;
+  /// Events are sampled from this if it is set, otherwise they are uniform
+  std::shared_ptr<const EventDistribution> m_distribution;
+  /// Detector numbers as the IDs published, empty if they are a contiguous
+  /// range, in which case an ID is computed from the first number instead of
+  /// being looked up
+  std::vector<uint32_t> m_detectorNumbers;
+  uint32_t m_firstDetectorNumber = 0;
+  uint32_t m_numberOfDetectors = 0;
+};
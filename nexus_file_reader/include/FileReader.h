@@ -2,11 +2,8 @@
 
 #include <cmath>
 #include <h5cpp/hdf5.hpp>
-#include <unordered_map>
 
-#include "../../serialisation/include/SampleEnvironmentEvent.h"
-
-using sEEventVector = std::vector<std::shared_ptr<SampleEnvironmentEvent>>;
+#include "../../serialisation/include/SampleEnvironmentLogs.h"
 
 struct EventDataFrame;
 struct HistogramFrame;
@@ -26,7 +23,7 @@ public:
                                            size_t eventGroupNumber) = 0;
   virtual uint64_t getFrameTime(hsize_t frameNumber) = 0;
   virtual std::string getInstrumentName() = 0;
-  virtual std::unordered_map<hsize_t, sEEventVector> getSEEventMap() = 0;
+  virtual SampleEnvironmentLogs getSampleEnvLogs() = 0;
   virtual int32_t getNumberOfPeriods() = 0;
   virtual uint64_t getRelativeFrameTimeMilliseconds(hsize_t frameNumber) = 0;
   virtual bool isISISFile() = 0;
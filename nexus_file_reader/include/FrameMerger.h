@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// A frame of a single NXevent_data group
+struct GroupFrame {
+  uint32_t eventGroupNumber;
+  uint64_t frameNumber;
+};
+
+/*
+ * Merges the frames of NXevent_data groups which do not contain the same
+ * frames into a single sequence of frames in pulse time order. Each merged
+ * frame contains the frames of every group which have the same pulse time.
+ */
+class FrameMerger {
+public:
+  FrameMerger() = default;
+  /// @param groupPulseTimesNs - sorted pulse times of the frames of each
+  /// group, in nanoseconds relative to the same reference
+  explicit FrameMerger(
+      const std::vector<std::vector<uint64_t>> &groupPulseTimesNs);
+
+  bool empty() const { return m_pulseTimesNs.empty(); }
+  size_t getNumberOfFrames() const { return m_pulseTimesNs.size(); }
+  const std::vector<uint64_t> &getPulseTimes() const { return m_pulseTimesNs; }
+  uint64_t getNumberOfFramesInGroup(size_t eventGroupNumber) const {
+    return m_numberOfFramesInGroup[eventGroupNumber];
+  }
+  /// Number of group frames in all of the merged frames
+  size_t getNumberOfGroupFrames() const { return m_groupFrames.size(); }
+
+  /// Group frames in the given merged frame, in order of group number
+  std::vector<GroupFrame> getGroupFrames(size_t mergedFrameNumber) const {
+    return {m_groupFrames.cbegin() + m_mergedFrameOffsets[mergedFrameNumber],
+            m_groupFrames.cbegin() +
+                m_mergedFrameOffsets[mergedFrameNumber + 1]};
+  }
+
+private:
+  /// Pulse time of each merged frame
+  std::vector<uint64_t> m_pulseTimesNs;
+  /// Group frames of merged frame n are from m_mergedFrameOffsets[n] to
+  /// m_mergedFrameOffsets[n + 1]
+  std::vector<size_t> m_mergedFrameOffsets;
+  std::vector<GroupFrame> m_groupFrames;
+  std::vector<uint64_t> m_numberOfFramesInGroup;
+};
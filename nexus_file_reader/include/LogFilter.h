@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../../serialisation/include/SampleEnvironmentLogs.h"
+
+/// Thresholds for reducing the number of samples published from an NXlog,
+/// a sample is kept only if it passes every enabled check
+struct LogFilterSettings {
+  /// Log names to apply the filter to, may contain * and ? wildcards
+  std::string namePattern;
+  /// Minimum absolute change from the last kept value, 0 disables
+  double deadBand = 0.0;
+  /// Minimum change relative to the last kept value, 0 disables
+  double relativeDeadBand = 0.0;
+  /// Minimum time in seconds since the last kept sample, 0 disables
+  float minIntervalSeconds = 0.0f;
+  /// Only consider every Nth sample, 1 disables
+  uint32_t decimation = 1;
+};
+
+/*
+ * Selects which samples of each NXlog are published, using the first
+ * filter whose name pattern matches the name of the log.
+ */
+class LogFilter {
+public:
+  LogFilter() = default;
+  explicit LogFilter(const std::vector<std::string> &filterSpecs);
+
+  static LogFilterSettings parseFilterSpec(const std::string &filterSpec);
+  static bool matchesPattern(const std::string &name,
+                             const std::string &pattern);
+
+  std::vector<uint32_t> selectSamples(const std::string &name,
+                                      const std::vector<float> &times,
+                                      const LogValues &values,
+                                      size_t numberOfSamples) const;
+
+private:
+  std::vector<LogFilterSettings> m_filters;
+};
@@ -2,14 +2,17 @@
 
 #include <h5cpp/hdf5.hpp>
 #include <memory>
-#include <random>
 #include <spdlog/spdlog.h>
-#include <unordered_map>
 #include <vector>
 
 #include "../../core/include/OptionalArgs.h"
-#include "../../serialisation/include/SampleEnvironmentEvent.h"
+#include "../../serialisation/include/SampleEnvironmentLogs.h"
+#include "FakeEventGenerator.h"
 #include "FileReader.h"
+#include "FrameMerger.h"
+#include "LogFilter.h"
+#include "PulseTimeIndex.h"
+#include "SidecarIndex.h"
 
 class NexusFileReader : public FileReader {
 public:
@@ -29,7 +32,7 @@ public:
                                    size_t eventGroupNumber) override;
   uint64_t getFrameTime(hsize_t frameNumber) override;
   std::string getInstrumentName() override;
-  std::unordered_map<hsize_t, sEEventVector> getSEEventMap() override;
+  SampleEnvironmentLogs getSampleEnvLogs() override;
   int32_t getNumberOfPeriods() override;
   uint64_t getRelativeFrameTimeMilliseconds(hsize_t frameNumber) override;
   bool isISISFile() override;
@@ -48,6 +51,13 @@ private:
                                        size_t eventGroupNumber);
   std::vector<uint32_t> getEventTofs(hsize_t frameNumber,
                                      size_t eventGroupNumber);
+  EventDataFrame getPrefetchedEvents(hsize_t frameNumber,
+                                     size_t eventGroupNumber);
+  void prefetchEvents(hsize_t frameNumber, size_t eventGroupNumber);
+  std::vector<EventDataFrame> getFakeEventData(hsize_t frameNumber);
+  std::unique_ptr<FakeEventGenerator>
+  createFakeEventGenerator(const std::vector<int32_t> &detectorNumbers);
+  EventDistribution scanEventDistribution();
   static void getEntryGroup(const hdf5::node::Group &rootGroup,
                             hdf5::node::Group &entryGroupOutput);
   void getGroups(const hdf5::node::Group &parentGroup,
@@ -58,16 +68,36 @@ private:
       const hdf5::node::Group &group,
       const std::vector<std::string> &requiredDatasets,
       const std::string &className) const;
-  static size_t findFrameNumberOfTime(float time);
   std::vector<hdf5::node::Group> findNXLogs();
   template <typename T>
   T getSingleValueFromDataset(const hdf5::node::Group &group,
                               const std::string &dataset, hsize_t offset);
   hsize_t getFrameStart(hsize_t frameNumber, size_t eventGroupNumber);
+  hsize_t getNumberOfFramesInGroup(size_t eventGroupNumber) const;
   bool testIfIsISISFile();
+  void writeSidecarIndex();
 
   size_t m_numberOfFrames;
   uint64_t m_frameStartOffset;
+  /// Pulse times of the frames, from the first NXevent_data group
+  PulseTimeIndex m_pulseTimeIndex;
+  /// Only used if the NXevent_data groups do not all contain the same frames,
+  /// in which case frame numbers refer to the merged frames
+  FrameMerger m_frameMerger;
+  /// Events of consecutive frames of one group, read ahead of the merged frame
+  /// being published
+  struct EventPrefetchBuffer {
+    hsize_t firstFrame = 0;
+    /// Offset of the events of each frame in the buffer, followed by the end
+    /// of the last frame
+    std::vector<hsize_t> frameOffsets;
+    std::vector<uint32_t> detIds;
+    std::vector<uint32_t> tofs;
+  };
+  /// One prefetch buffer per NXevent_data group, only used if frames are merged
+  std::vector<EventPrefetchBuffer> m_prefetchBuffers;
+  /// Index of the file from a previous run, if enabled and up to date
+  SidecarIndex m_sidecarIndex;
 
   hdf5::file::File m_file;
   hdf5::node::Group m_entryGroup;
@@ -78,15 +108,15 @@ private:
   uint64_t m_runStart;
   const int32_t m_fakeEventsPerPulse;
 
-  std::vector<int32_t> m_detectorNumbers;
-
-  /// Tools for generating events
-  std::uniform_int_distribution<uint32_t> m_timeOfFlightDist;
-  std::uniform_int_distribution<uint32_t> m_detectorIDDist;
-  std::default_random_engine RandomEngine;
+  /// Only used if fake events are requested
+  std::unique_ptr<FakeEventGenerator> m_fakeEventGenerator;
+  /// Number of pulses of fake events generated so far
+  uint64_t m_numberOfFakeEventStreams = 0;
 
   bool m_isisFile;
 
   std::shared_ptr<spdlog::logger> m_logger = spdlog::get("LOG");
   OptionalArgs m_settings;
+  /// Selects which NXlog samples are published
+  LogFilter m_logFilter;
 };
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * Index of frame boundaries built from the pulse times (event_time_zero) of
+ * the frames in the file. Used to find which frame a log sample falls in
+ * without assuming a source frequency.
+ */
+class PulseTimeIndex {
+public:
+  /// Returned for times which do not fall within the run
+  static constexpr size_t noFrame = std::numeric_limits<size_t>::max();
+
+  PulseTimeIndex() = default;
+  /// @param pulseTimesNs - pulse time of each frame in nanoseconds, relative
+  /// to the same reference as the log times, must be sorted
+  explicit PulseTimeIndex(std::vector<uint64_t> pulseTimesNs);
+
+  size_t getNumberOfFrames() const { return m_pulseTimesNs.size(); }
+  uint64_t getPulseTime(size_t frameNumber) const {
+    return m_pulseTimesNs[frameNumber];
+  }
+  const std::vector<uint64_t> &getPulseTimes() const { return m_pulseTimesNs; }
+
+  size_t findFrameNumber(uint64_t timeNs) const;
+  std::vector<size_t>
+  findFrameNumbers(const std::vector<float> &timesSeconds) const;
+
+private:
+  std::vector<uint64_t> m_pulseTimesNs;
+  /// Times after this are later than the end of the last frame
+  uint64_t m_endOfLastFrameNs = 0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Information about a NeXus file which is slow to find by reading the file
+struct SidecarIndexContents {
+  /// HDF5 paths of the NXevent_data groups to publish
+  std::vector<std::string> eventGroupPaths;
+  /// HDF5 paths of the NXlog groups in the file
+  std::vector<std::string> logGroupPaths;
+  /// Pulse time of each frame in nanoseconds
+  std::vector<uint64_t> pulseTimesNs;
+  /// Event index of the start of each frame, for each NXevent_data group
+  std::vector<std::vector<uint64_t>> frameOffsets;
+};
+
+/*
+ * Binary index file stored next to a NeXus file, so that the file does not
+ * have to be searched and its pulse times and event indices read every time
+ * it is opened. The index is memory mapped and is only used if the size and
+ * modification time of the NeXus file match those recorded in the index.
+ */
+class SidecarIndex {
+public:
+  SidecarIndex() = default;
+  ~SidecarIndex();
+  SidecarIndex(const SidecarIndex &) = delete;
+  SidecarIndex &operator=(const SidecarIndex &) = delete;
+  SidecarIndex(SidecarIndex &&other) noexcept;
+  SidecarIndex &operator=(SidecarIndex &&other) noexcept;
+
+  static std::string getIndexFilename(const std::string &nexusFilename);
+  static void write(const std::string &nexusFilename,
+                    const SidecarIndexContents &contents);
+
+  bool load(const std::string &nexusFilename);
+  bool isLoaded() const { return m_mapping != nullptr; }
+
+  const std::vector<std::string> &getEventGroupPaths() const {
+    return m_eventGroupPaths;
+  }
+  const std::vector<std::string> &getLogGroupPaths() const {
+    return m_logGroupPaths;
+  }
+  std::vector<uint64_t> getPulseTimes() const;
+  uint64_t getFrameOffset(size_t eventGroupNumber, size_t frameNumber) const {
+    return m_frameOffsets[eventGroupNumber * m_numberOfFrames + frameNumber];
+  }
+
+private:
+  void unmap();
+
+  void *m_mapping = nullptr;
+  size_t m_mappingSize = 0;
+  uint64_t m_numberOfFrames = 0;
+  const uint64_t *m_pulseTimesNs = nullptr;
+  const uint64_t *m_frameOffsets = nullptr;
+  std::vector<std::string> m_eventGroupPaths;
+  std::vector<std::string> m_logGroupPaths;
+};
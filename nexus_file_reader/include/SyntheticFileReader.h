@@ -0,0 +1,57 @@
+#pragma once
+
+#include <random>
+
+#include "../../core/include/OptionalArgs.h"
+#include "FakeEventGenerator.h"
+#include "FileReader.h"
+
+/*
+ * Source of randomly generated events which needs no NeXus file, for soak
+ * testing downstream services. Pulses follow each other at a fixed frequency,
+ * and runs can go on indefinitely. The number of events in each pulse is
+ * either constant or drawn from a Poisson distribution, the events are made
+ * by FakeEventGenerator.
+ */
+class SyntheticFileReader : public FileReader {
+public:
+  SyntheticFileReader(uint64_t runStartTimeNanoseconds,
+                      const std::vector<int32_t> &detectorNumbers,
+                      const OptionalArgs &settings);
+
+  hsize_t getFileSize() override { return 0; }
+  uint64_t getTotalEventCount() override;
+  uint32_t getPeriodNumber() override { return 0; }
+  float getProtonCharge(hsize_t) override { return 0; }
+  std::vector<EventDataFrame> getEventData(hsize_t frameNumber) override;
+  std::vector<HistogramFrame> getHistoData() override;
+  size_t getNumberOfFrames() override { return m_numberOfFrames; }
+  hsize_t getNumberOfEventsInFrame(hsize_t frameNumber,
+                                   size_t eventGroupNumber) override;
+  uint64_t getFrameTime(hsize_t frameNumber) override;
+  std::string getInstrumentName() override { return m_instrumentName; }
+  SampleEnvironmentLogs getSampleEnvLogs() override { return {}; }
+  int32_t getNumberOfPeriods() override { return 1; }
+  uint64_t getRelativeFrameTimeMilliseconds(hsize_t frameNumber) override;
+  bool isISISFile() override { return false; }
+  uint64_t getTotalEventsInGroup(size_t eventGroupNumber) override;
+  uint32_t getRunDurationMs() override;
+  bool hasHistogramData() override { return false; }
+
+private:
+  uint32_t getNumberOfEventsInPulse();
+
+  const uint64_t m_runStart;
+  const double m_pulsePeriodNs;
+  const size_t m_numberOfFrames;
+  const uint32_t m_meanEventsPerPulse;
+  const bool m_poissonEventCounts;
+  const std::string m_instrumentName;
+
+  /// Tools for generating events
+  FakeEventGenerator m_eventGenerator;
+  /// Number of pulses generated so far, so later runs do not repeat events
+  uint64_t m_numberOfPulsesGenerated = 0;
+  std::poisson_distribution<uint32_t> m_eventCountDist;
+  std::default_random_engine RandomEngine;
+};
@@ -0,0 +1,66 @@
+#include <limits>
+#include <stdexcept>
+
+#include "AliasTable.h"
+
+/**
+ * Build the table, weights do not need to be normalised
+ *
+ * @param weights - relative probability of each index, at least one must be
+ * positive
+ */
+AliasTable::AliasTable(const std::vector<double> &weights) {
+  if (weights.empty() ||
+      weights.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Alias table needs between 1 and 2^32 weights");
+  }
+  double totalWeight = 0;
+  for (const auto weight : weights) {
+    if (weight < 0) {
+      throw std::runtime_error("Alias table weights must not be negative");
+    }
+    totalWeight += weight;
+  }
+  if (totalWeight <= 0) {
+    throw std::runtime_error("Alias table needs a positive weight");
+  }
+
+  const auto numberOfColumns = weights.size();
+  std::vector<double> probabilities(numberOfColumns);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t index = 0; index < numberOfColumns; ++index) {
+    // Scale so that the mean probability is 1
+    probabilities[index] =
+        weights[index] * static_cast<double>(numberOfColumns) / totalWeight;
+    if (probabilities[index] < 1) {
+      small.push_back(index);
+    } else {
+      large.push_back(index);
+    }
+  }
+
+  m_columns.resize(numberOfColumns);
+  while (!small.empty() && !large.empty()) {
+    const auto smallIndex = small.back();
+    small.pop_back();
+    const auto largeIndex = large.back();
+    // Fill the rest of the small column with the large index
+    m_columns[smallIndex] = {
+        static_cast<uint32_t>(probabilities[smallIndex] * 4294967296.0),
+        smallIndex, largeIndex};
+    probabilities[largeIndex] -= 1 - probabilities[smallIndex];
+    if (probabilities[largeIndex] < 1) {
+      large.pop_back();
+      small.push_back(largeIndex);
+    }
+  }
+  // Whatever is left has a probability of 1 up to rounding errors, so always
+  // keeps its own index
+  for (const auto index : large) {
+    m_columns[index] = {std::numeric_limits<uint32_t>::max(), index, index};
+  }
+  for (const auto index : small) {
+    m_columns[index] = {std::numeric_limits<uint32_t>::max(), index, index};
+  }
+}
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+#include "../../core/include/HistogramFrame.h"
+#include "../../serialisation/include/DetectorSpectrumMapData.h"
+#include "EventDistribution.h"
+
+/**
+ * @param detectorIDs - detector IDs to give events
+ * @param detectorWeights - relative probability of each detector ID
+ * @param timeOfFlightBinEdges - bin edges in nanoseconds, one more than the
+ * number of weights
+ * @param timeOfFlightWeights - relative probability of each time of flight bin
+ */
+EventDistribution::EventDistribution(
+    std::vector<uint32_t> detectorIDs,
+    const std::vector<double> &detectorWeights,
+    std::vector<uint32_t> timeOfFlightBinEdges,
+    const std::vector<double> &timeOfFlightWeights)
+    : m_detectorIDs(std::move(detectorIDs)),
+      m_detectorTable(detectorWeights),
+      m_timeOfFlightBinEdges(std::move(timeOfFlightBinEdges)),
+      m_timeOfFlightTable(timeOfFlightWeights) {
+  if (m_detectorIDs.size() != detectorWeights.size()) {
+    throw std::runtime_error(
+        "Number of detector IDs and detector weights differ");
+  }
+  if (m_timeOfFlightBinEdges.size() != timeOfFlightWeights.size() + 1) {
+    throw std::runtime_error("Number of time of flight bin edges must be one "
+                             "more than the number of weights");
+  }
+  if (!std::is_sorted(m_timeOfFlightBinEdges.cbegin(),
+                      m_timeOfFlightBinEdges.cend())) {
+    throw std::runtime_error("Time of flight bin edges must be increasing");
+  }
+}
+
+/**
+ * Build the distributions from histograms of counts, in which the last
+ * dimension is time of flight. The time of flight distribution is taken from
+ * the first histogram only, as histograms can have different bins.
+ *
+ * @param histograms - histograms from NXdata groups, with time of flight bin
+ * edges in microseconds
+ * @param detSpecMap - used to share the counts of each spectrum between its
+ * detectors, if null the spectrum numbers are used as detector IDs
+ * @return - distributions of detector IDs and times of flight
+ */
+EventDistribution
+EventDistribution::fromHistograms(const std::vector<HistogramFrame> &histograms,
+                                  const DetectorSpectrumMapData *detSpecMap) {
+  std::map<uint32_t, double> spectrumCounts;
+  std::vector<double> timeOfFlightWeights;
+  std::vector<uint32_t> timeOfFlightBinEdges;
+  for (const auto &histogram : histograms) {
+    if (histogram.countsShape.empty() || histogram.detectorIDs.empty()) {
+      continue;
+    }
+    const auto numberOfBins = histogram.countsShape.back();
+    const auto numberOfSpectra = histogram.detectorIDs.size();
+    if (numberOfBins == 0 || histogram.timeOfFlight.size() < numberOfBins) {
+      continue;
+    }
+    const bool firstHistogram = timeOfFlightWeights.empty();
+    if (firstHistogram) {
+      timeOfFlightWeights.resize(numberOfBins);
+    }
+    for (size_t index = 0; index < histogram.counts.size(); ++index) {
+      const auto count =
+          static_cast<double>(std::max(0, histogram.counts[index]));
+      const auto spectrum = histogram.detectorIDs[(index / numberOfBins) %
+                                                  numberOfSpectra];
+      spectrumCounts[static_cast<uint32_t>(spectrum)] += count;
+      if (firstHistogram) {
+        timeOfFlightWeights[index % numberOfBins] += count;
+      }
+    }
+    if (firstHistogram) {
+      for (const auto edge : histogram.timeOfFlight) {
+        timeOfFlightBinEdges.push_back(
+            static_cast<uint32_t>(std::max(0.0f, edge) * 1000 + 0.5f));
+      }
+      if (timeOfFlightBinEdges.size() == numberOfBins) {
+        // Only the start of each bin is given, assume the last bin is as
+        // wide as the one before it
+        const auto lastBinWidth =
+            numberOfBins > 1 ? timeOfFlightBinEdges[numberOfBins - 1] -
+                                   timeOfFlightBinEdges[numberOfBins - 2]
+                             : 1;
+        timeOfFlightBinEdges.push_back(timeOfFlightBinEdges.back() +
+                                       lastBinWidth);
+      }
+      timeOfFlightBinEdges.resize(numberOfBins + 1);
+    }
+  }
+  if (spectrumCounts.empty()) {
+    throw std::runtime_error(
+        "No histogram data to build a fake event distribution from");
+  }
+
+  std::vector<uint32_t> detectorIDs;
+  std::vector<double> detectorWeights;
+  if (detSpecMap == nullptr) {
+    for (const auto &spectrumCount : spectrumCounts) {
+      detectorIDs.push_back(spectrumCount.first);
+      detectorWeights.push_back(spectrumCount.second);
+    }
+  } else {
+    const auto &detectors = detSpecMap->getDetectors();
+    const auto &spectra = detSpecMap->getSpectra();
+    std::map<uint32_t, size_t> detectorsInSpectrum;
+    for (const auto spectrum : spectra) {
+      ++detectorsInSpectrum[static_cast<uint32_t>(spectrum)];
+    }
+    for (size_t i = 0; i < detectors.size(); ++i) {
+      const auto spectrum = static_cast<uint32_t>(spectra[i]);
+      const auto spectrumCount = spectrumCounts.find(spectrum);
+      if (spectrumCount != spectrumCounts.end()) {
+        detectorIDs.push_back(static_cast<uint32_t>(detectors[i]));
+        detectorWeights.push_back(spectrumCount->second /
+                                  detectorsInSpectrum[spectrum]);
+      }
+    }
+  }
+  return {std::move(detectorIDs), detectorWeights,
+          std::move(timeOfFlightBinEdges), timeOfFlightWeights};
+}
+
+const uint32_t EventDistributionBuilder::timeOfFlightBinWidth;
+const uint32_t EventDistributionBuilder::maxNumberOfTimeOfFlightBins;
+
+/**
+ * Count events
+ *
+ * @param detectorIDs - detector ID of each event
+ * @param timeOfFlights - time of flight of each event in nanoseconds
+ */
+void EventDistributionBuilder::addEvents(
+    const std::vector<uint32_t> &detectorIDs,
+    const std::vector<uint32_t> &timeOfFlights) {
+  for (const auto detectorID : detectorIDs) {
+    ++m_detectorCounts[detectorID];
+  }
+  for (const auto timeOfFlight : timeOfFlights) {
+    const auto bin = std::min(timeOfFlight / timeOfFlightBinWidth,
+                              maxNumberOfTimeOfFlightBins - 1);
+    if (bin >= m_timeOfFlightCounts.size()) {
+      m_timeOfFlightCounts.resize(bin + 1);
+    }
+    ++m_timeOfFlightCounts[bin];
+  }
+  m_numberOfEvents += detectorIDs.size();
+}
+
+/// @return - distributions of the events counted so far
+EventDistribution EventDistributionBuilder::build() const {
+  if (m_numberOfEvents == 0) {
+    throw std::runtime_error(
+        "No event data to build a fake event distribution from");
+  }
+  // Sort the detector IDs so the distribution does not depend on the order
+  // of the hash map, which keeps fake events reproducible
+  std::vector<std::pair<uint32_t, uint64_t>> detectorCounts(
+      m_detectorCounts.cbegin(), m_detectorCounts.cend());
+  std::sort(detectorCounts.begin(), detectorCounts.end());
+  std::vector<uint32_t> detectorIDs;
+  std::vector<double> detectorWeights;
+  detectorIDs.reserve(detectorCounts.size());
+  detectorWeights.reserve(detectorCounts.size());
+  for (const auto &detectorCount : detectorCounts) {
+    detectorIDs.push_back(detectorCount.first);
+    detectorWeights.push_back(static_cast<double>(detectorCount.second));
+  }
+
+  std::vector<uint32_t> timeOfFlightBinEdges;
+  std::vector<double> timeOfFlightWeights;
+  for (size_t bin = 0; bin < m_timeOfFlightCounts.size(); ++bin) {
+    timeOfFlightBinEdges.push_back(static_cast<uint32_t>(bin) *
+                                   timeOfFlightBinWidth);
+    timeOfFlightWeights.push_back(
+        static_cast<double>(m_timeOfFlightCounts[bin]));
+  }
+  timeOfFlightBinEdges.push_back(
+      static_cast<uint32_t>(m_timeOfFlightCounts.size()) *
+      timeOfFlightBinWidth);
+  return {std::move(detectorIDs), detectorWeights,
+          std::move(timeOfFlightBinEdges), timeOfFlightWeights};
+}
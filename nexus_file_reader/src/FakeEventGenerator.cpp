@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "../../core/include/CounterBasedRandom.h"
+#include "FakeEventGenerator.h"
+
+using CounterBasedRandom::reduce;
+
+namespace {
+uint32_t getNumberOfThreads(const uint32_t numberOfThreads) {
+  if (numberOfThreads == 0) {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+  return numberOfThreads;
+}
+
+/// Pulses smaller than this are not worth starting threads for
+const size_t minEventsPerThread = 1 << 18;
+} // namespace
+
+const uint32_t FakeEventGenerator::minTimeOfFlight;
+const uint32_t FakeEventGenerator::maxTimeOfFlight;
+
+/**
+ * Create a generator of fake events
+ *
+ * @param detectorNumbers - detector IDs to give events
+ * @param seed - events are reproducible for the same seed
+ * @param numberOfThreads - maximum number of threads to generate a large pulse
+ * with, 0 means use all hardware threads
+ */
+FakeEventGenerator::FakeEventGenerator(
+    const std::vector<int32_t> &detectorNumbers, const uint64_t seed,
+    const uint32_t numberOfThreads)
+    : m_seed(seed), m_numberOfThreads(getNumberOfThreads(numberOfThreads)),
+      m_numberOfDetectors(static_cast<uint32_t>(detectorNumbers.size())) {
+  if (detectorNumbers.empty()) {
+    throw std::runtime_error(
+        "Fake events need a detector ID range or detector-spectrum map");
+  }
+  m_firstDetectorNumber = static_cast<uint32_t>(detectorNumbers[0]);
+  for (size_t i = 1; i < detectorNumbers.size(); ++i) {
+    if (detectorNumbers[i] != detectorNumbers[i - 1] + 1) {
+      m_detectorNumbers.assign(detectorNumbers.begin(), detectorNumbers.end());
+      break;
+    }
+  }
+}
+
+/**
+ * Create a generator of fake events sampled from measured distributions
+ *
+ * @param distribution - distributions of detector IDs and times of flight
+ * @param seed - events are reproducible for the same seed
+ * @param numberOfThreads - maximum number of threads to generate a large pulse
+ * with, 0 means use all hardware threads
+ */
+FakeEventGenerator::FakeEventGenerator(
+    std::shared_ptr<const EventDistribution> distribution,
+    const uint64_t seed, const uint32_t numberOfThreads)
+    : m_seed(seed), m_numberOfThreads(getNumberOfThreads(numberOfThreads)),
+      m_distribution(std::move(distribution)) {
+  if (m_distribution == nullptr) {
+    throw std::runtime_error("Fake event distribution must not be null");
+  }
+}
+
+/**
+ * Generate the events of a pulse
+ *
+ * @param streamNumber - identifies the pulse, different streams give
+ * independent events
+ * @param numberOfEvents - number of events to generate
+ * @return - detector IDs and times of flight of the events
+ */
+EventDataFrame FakeEventGenerator::generate(const uint64_t streamNumber,
+                                            const size_t numberOfEvents) const {
+  std::vector<uint32_t> detectorIDs(numberOfEvents);
+  std::vector<uint32_t> timeOfFlights(numberOfEvents);
+  generate(streamNumber, detectorIDs.data(), timeOfFlights.data(),
+           numberOfEvents);
+  return {std::move(detectorIDs), std::move(timeOfFlights)};
+}
+
+/**
+ * Generate the events of a pulse into the given buffers, large pulses are
+ * split between threads
+ *
+ * @param streamNumber - identifies the pulse, different streams give
+ * independent events
+ * @param detectorIDs - output buffer for numberOfEvents detector IDs
+ * @param timeOfFlights - output buffer for numberOfEvents times of flight
+ * @param numberOfEvents - number of events to generate
+ */
+void FakeEventGenerator::generate(const uint64_t streamNumber,
+                                  uint32_t *detectorIDs,
+                                  uint32_t *timeOfFlights,
+                                  const size_t numberOfEvents) const {
+  const auto key = CounterBasedRandom::getKey(m_seed, streamNumber);
+  const auto usefulThreads =
+      std::max<size_t>(1, numberOfEvents / minEventsPerThread);
+  const auto numberOfThreads =
+      static_cast<size_t>(std::min<uint64_t>(m_numberOfThreads, usefulThreads));
+  const auto generateEvents = m_distribution != nullptr
+                                  ? &FakeEventGenerator::sampleRange
+                                  : &FakeEventGenerator::generateRange;
+  if (numberOfThreads == 1) {
+    (this->*generateEvents)(key, detectorIDs, timeOfFlights, 0, numberOfEvents);
+    return;
+  }
+
+  const auto eventsPerThread =
+      (numberOfEvents + numberOfThreads - 1) / numberOfThreads;
+  std::vector<std::thread> threads;
+  threads.reserve(numberOfThreads - 1);
+  for (size_t thread = 1; thread < numberOfThreads; ++thread) {
+    const auto firstEvent = std::min(numberOfEvents, thread * eventsPerThread);
+    const auto lastEvent =
+        std::min(numberOfEvents, firstEvent + eventsPerThread);
+    threads.emplace_back(generateEvents, this, key, detectorIDs, timeOfFlights,
+                         firstEvent, lastEvent);
+  }
+  (this->*generateEvents)(key, detectorIDs, timeOfFlights, 0, eventsPerThread);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * Generate the events with indices in [firstEvent, lastEvent), each event
+ * only depends on the key and its index
+ */
+void FakeEventGenerator::generateRange(const uint64_t key,
+                                       uint32_t *detectorIDs,
+                                       uint32_t *timeOfFlights,
+                                       const size_t firstEvent,
+                                       const size_t lastEvent) const {
+  const uint32_t timeOfFlightRange = maxTimeOfFlight - minTimeOfFlight + 1;
+  // One 64-bit random number gives both the detector and the time of flight
+  if (m_detectorNumbers.empty()) {
+    for (size_t i = firstEvent; i < lastEvent; ++i) {
+      const auto random = CounterBasedRandom::get(key, i);
+      detectorIDs[i] =
+          m_firstDetectorNumber +
+          reduce(static_cast<uint32_t>(random >> 32), m_numberOfDetectors);
+      timeOfFlights[i] = minTimeOfFlight + reduce(static_cast<uint32_t>(random),
+                                                  timeOfFlightRange);
+    }
+  } else {
+    for (size_t i = firstEvent; i < lastEvent; ++i) {
+      const auto random = CounterBasedRandom::get(key, i);
+      detectorIDs[i] = m_detectorNumbers[reduce(
+          static_cast<uint32_t>(random >> 32), m_numberOfDetectors)];
+      timeOfFlights[i] = minTimeOfFlight + reduce(static_cast<uint32_t>(random),
+                                                  timeOfFlightRange);
+    }
+  }
+}
+
+/**
+ * Sample the events with indices in [firstEvent, lastEvent) from the
+ * distributions, each event uses two random numbers which only depend on the
+ * key and its index
+ */
+void FakeEventGenerator::sampleRange(const uint64_t key, uint32_t *detectorIDs,
+                                     uint32_t *timeOfFlights,
+                                     const size_t firstEvent,
+                                     const size_t lastEvent) const {
+  const auto &distribution = *m_distribution;
+  for (size_t i = firstEvent; i < lastEvent; ++i) {
+    distribution.sample(CounterBasedRandom::get(key, 2 * i),
+                        CounterBasedRandom::get(key, 2 * i + 1),
+                        detectorIDs[i], timeOfFlights[i]);
+  }
+}
@@ -0,0 +1,53 @@
+#include <functional>
+#include <queue>
+#include <tuple>
+
+#include "FrameMerger.h"
+
+/**
+ * Merge the frames of each group using a heap holding the next frame of each
+ * group, so that each group's pulse times are walked once in order
+ *
+ * @param groupPulseTimesNs - sorted pulse times of the frames of each group
+ */
+FrameMerger::FrameMerger(
+    const std::vector<std::vector<uint64_t>> &groupPulseTimesNs) {
+  size_t totalGroupFrames = 0;
+  for (const auto &pulseTimes : groupPulseTimesNs) {
+    m_numberOfFramesInGroup.push_back(pulseTimes.size());
+    totalGroupFrames += pulseTimes.size();
+  }
+  m_groupFrames.reserve(totalGroupFrames);
+
+  // Pulse time, group number and frame number of the next frame of a group,
+  // ordered so that ties in pulse time are broken by group number
+  using Cursor = std::tuple<uint64_t, uint32_t, uint64_t>;
+  std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>>
+      nextFrames;
+  for (uint32_t groupNumber = 0; groupNumber < groupPulseTimesNs.size();
+       ++groupNumber) {
+    if (!groupPulseTimesNs[groupNumber].empty()) {
+      nextFrames.emplace(groupPulseTimesNs[groupNumber][0], groupNumber, 0);
+    }
+  }
+
+  while (!nextFrames.empty()) {
+    uint64_t pulseTime;
+    uint32_t groupNumber;
+    uint64_t frameNumber;
+    std::tie(pulseTime, groupNumber, frameNumber) = nextFrames.top();
+    nextFrames.pop();
+
+    if (m_pulseTimesNs.empty() || pulseTime != m_pulseTimesNs.back()) {
+      m_pulseTimesNs.push_back(pulseTime);
+      m_mergedFrameOffsets.push_back(m_groupFrames.size());
+    }
+    m_groupFrames.push_back({groupNumber, frameNumber});
+
+    const auto &pulseTimes = groupPulseTimesNs[groupNumber];
+    if (++frameNumber < pulseTimes.size()) {
+      nextFrames.emplace(pulseTimes[frameNumber], groupNumber, frameNumber);
+    }
+  }
+  m_mergedFrameOffsets.push_back(m_groupFrames.size());
+}
@@ -0,0 +1,237 @@
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "LogFilter.h"
+
+namespace {
+/**
+ * Find the samples to keep, in a single pass over the values
+ *
+ * @param settings - thresholds to apply
+ * @param times - times of the samples in seconds
+ * @param values - values of the samples
+ * @param numberOfSamples - number of samples with both a time and a value
+ * @return - indices of the samples to keep, in order
+ */
+template <typename T>
+std::vector<uint32_t> applyFilter(const LogFilterSettings &settings,
+                                  const std::vector<float> &times,
+                                  const std::vector<T> &values,
+                                  const size_t numberOfSamples) {
+  std::vector<uint32_t> keptIndices;
+  if (numberOfSamples == 0) {
+    return keptIndices;
+  }
+  keptIndices.reserve(numberOfSamples / settings.decimation + 1);
+
+  const auto useDeadBand =
+      settings.deadBand > 0.0 || settings.relativeDeadBand > 0.0;
+  const auto useInterval = settings.minIntervalSeconds > 0.0f;
+
+  // Always keep the first sample so that the initial value is published
+  keptIndices.push_back(0);
+  auto lastValue = static_cast<double>(values[0]);
+  auto lastTime = times[0];
+  for (size_t sampleIndex = settings.decimation; sampleIndex < numberOfSamples;
+       sampleIndex += settings.decimation) {
+    if (useInterval &&
+        times[sampleIndex] - lastTime < settings.minIntervalSeconds) {
+      continue;
+    }
+    const auto value = static_cast<double>(values[sampleIndex]);
+    if (useDeadBand) {
+      const auto change = std::abs(value - lastValue);
+      if (change <= settings.deadBand ||
+          change <= settings.relativeDeadBand * std::abs(lastValue)) {
+        continue;
+      }
+    }
+    keptIndices.push_back(static_cast<uint32_t>(sampleIndex));
+    lastValue = value;
+    lastTime = times[sampleIndex];
+  }
+  return keptIndices;
+}
+
+std::runtime_error invalidValueError(const std::string &key,
+                                     const std::string &value) {
+  return std::runtime_error("Invalid value for log filter threshold \"" + key +
+                            "\": " + value);
+}
+
+/**
+ * Parse a threshold which must be a non-negative number, rejecting trailing
+ * characters which std::stod on its own would ignore
+ *
+ * @param key - name of the threshold, for error messages
+ * @param value - text of the value
+ * @return - the value
+ */
+double parseNonNegativeNumber(const std::string &key,
+                              const std::string &value) {
+  size_t parsedLength = 0;
+  double number;
+  try {
+    number = std::stod(value, &parsedLength);
+  } catch (const std::logic_error &) {
+    throw invalidValueError(key, value);
+  }
+  // Written this way round so that NaN is rejected too
+  if (parsedLength != value.size() || !(number >= 0.0)) {
+    throw invalidValueError(key, value);
+  }
+  return number;
+}
+
+/**
+ * Parse a decimation factor, which must be a whole number of at least 1
+ *
+ * @param key - name of the threshold, for error messages
+ * @param value - text of the value
+ * @return - the decimation factor
+ */
+uint32_t parseDecimation(const std::string &key, const std::string &value) {
+  size_t parsedLength = 0;
+  long long decimation;
+  try {
+    decimation = std::stoll(value, &parsedLength);
+  } catch (const std::logic_error &) {
+    throw invalidValueError(key, value);
+  }
+  if (parsedLength != value.size()) {
+    throw invalidValueError(key, value);
+  }
+  if (decimation < 1) {
+    throw std::runtime_error("Log filter threshold \"every\" must be at least "
+                             "1: " +
+                             value);
+  }
+  if (decimation > std::numeric_limits<uint32_t>::max()) {
+    throw invalidValueError(key, value);
+  }
+  return static_cast<uint32_t>(decimation);
+}
+} // namespace
+
+/**
+ * Create a filter from specifications given on the command line
+ *
+ * @param filterSpecs - specifications in the form described by parseFilterSpec
+ */
+LogFilter::LogFilter(const std::vector<std::string> &filterSpecs) {
+  for (const auto &filterSpec : filterSpecs) {
+    m_filters.push_back(parseFilterSpec(filterSpec));
+  }
+}
+
+/**
+ * Parse a filter specification of the form
+ * PATTERN:deadband=X,rel-deadband=X,min-interval=X,every=N
+ * where each of the thresholds is optional, the dead-bands and minimum
+ * interval must not be negative and every must be at least 1
+ *
+ * @param filterSpec - the specification to parse
+ * @return - the parsed filter settings
+ */
+LogFilterSettings LogFilter::parseFilterSpec(const std::string &filterSpec) {
+  const auto separator = filterSpec.rfind(':');
+  if (separator == std::string::npos || separator == 0) {
+    throw std::runtime_error("Log filter \"" + filterSpec +
+                             "\" must be of the form PATTERN:THRESHOLDS");
+  }
+
+  LogFilterSettings settings;
+  settings.namePattern = filterSpec.substr(0, separator);
+  std::istringstream thresholds(filterSpec.substr(separator + 1));
+  std::string threshold;
+  while (std::getline(thresholds, threshold, ',')) {
+    const auto equals = threshold.find('=');
+    if (equals == std::string::npos) {
+      throw std::runtime_error("Log filter threshold \"" + threshold +
+                               "\" must be of the form KEY=VALUE");
+    }
+    const auto key = threshold.substr(0, equals);
+    const auto value = threshold.substr(equals + 1);
+    if (key == "deadband") {
+      settings.deadBand = parseNonNegativeNumber(key, value);
+    } else if (key == "rel-deadband") {
+      settings.relativeDeadBand = parseNonNegativeNumber(key, value);
+    } else if (key == "min-interval") {
+      settings.minIntervalSeconds =
+          static_cast<float>(parseNonNegativeNumber(key, value));
+    } else if (key == "every") {
+      settings.decimation = parseDecimation(key, value);
+    } else {
+      throw std::runtime_error("Unknown log filter threshold \"" + key + "\"");
+    }
+  }
+  return settings;
+}
+
+/**
+ * Test whether a log name matches a pattern, where * matches any sequence of
+ * characters and ? matches any single character
+ *
+ * @param name - the log name
+ * @param pattern - the pattern
+ * @return - true if the whole name matches the pattern
+ */
+bool LogFilter::matchesPattern(const std::string &name,
+                               const std::string &pattern) {
+  size_t nameIndex = 0;
+  size_t patternIndex = 0;
+  // Position to backtrack to after the most recent *
+  auto starIndex = std::string::npos;
+  size_t starMatchIndex = 0;
+  while (nameIndex < name.size()) {
+    if (patternIndex < pattern.size() &&
+        (pattern[patternIndex] == '?' ||
+         pattern[patternIndex] == name[nameIndex])) {
+      ++nameIndex;
+      ++patternIndex;
+    } else if (patternIndex < pattern.size() && pattern[patternIndex] == '*') {
+      starIndex = patternIndex++;
+      starMatchIndex = nameIndex;
+    } else if (starIndex != std::string::npos) {
+      patternIndex = starIndex + 1;
+      nameIndex = ++starMatchIndex;
+    } else {
+      return false;
+    }
+  }
+  while (patternIndex < pattern.size() && pattern[patternIndex] == '*') {
+    ++patternIndex;
+  }
+  return patternIndex == pattern.size();
+}
+
+/**
+ * Select the samples of a log which should be published
+ *
+ * @param name - name of the log
+ * @param times - times of the samples in seconds
+ * @param values - values of the samples
+ * @param numberOfSamples - number of samples with both a time and a value
+ * @return - indices of the samples to publish, in order
+ */
+std::vector<uint32_t> LogFilter::selectSamples(const std::string &name,
+                                               const std::vector<float> &times,
+                                               const LogValues &values,
+                                               size_t numberOfSamples) const {
+  for (const auto &settings : m_filters) {
+    if (matchesPattern(name, settings.namePattern)) {
+      return nonstd::visit(
+          [&settings, &times, numberOfSamples](const auto &typedValues) {
+            return applyFilter(settings, times, typedValues, numberOfSamples);
+          },
+          values);
+    }
+  }
+
+  std::vector<uint32_t> allIndices(numberOfSamples);
+  std::iota(allIndices.begin(), allIndices.end(), 0);
+  return allIndices;
+}
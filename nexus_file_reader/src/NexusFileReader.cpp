@@ -1,41 +1,123 @@
+#include <algorithm>
 #include <fmt/format.h>
 
 #include "../../core/include/EventDataFrame.h"
 #include "../../core/include/HistogramFrame.h"
-#include "../../serialisation/include/SampleEnvironmentEventDouble.h"
-#include "../../serialisation/include/SampleEnvironmentEventInt.h"
-#include "../../serialisation/include/SampleEnvironmentEventLong.h"
-#include "../../serialisation/include/SampleEnvironmentEventUInt.h"
-#include "../../serialisation/include/SampleEnvironmentEventULong.h"
+#include "../../serialisation/include/DetectorSpectrumMapData.h"
 #include "../include/NexusFileReader.h"
 #include "UnitConversion.h"
 
 namespace {
+/// Limits how much of a file is read to sample fake events from
+const size_t maxEventsToScan = 10000000;
+
+template <typename T>
+std::vector<T> readDataset(hdf5::node::Dataset dataset) {
+  std::vector<T> values(static_cast<size_t>(dataset.dataspace().size()));
+  dataset.read(values);
+  return values;
+}
+
+/**
+ * Read the pulse time of every frame from an event_time_zero dataset
+ *
+ * @param pulseTimeDataset - event_time_zero dataset of an NXevent_data group
+ * @return - pulse times in nanoseconds relative to the offset in the file
+ */
+std::vector<uint64_t>
+readPulseTimesNanoseconds(hdf5::node::Dataset pulseTimeDataset) {
+  if (pulseTimeDataset.attributes.exists("units")) {
+    std::string units;
+    pulseTimeDataset.attributes["units"].read(units);
+    if (units == "ns" || units == "nanoseconds") {
+      return readDataset<uint64_t>(pulseTimeDataset);
+    }
+    // else assume seconds
+  }
+  return secondsToNanoseconds(readDataset<double>(pulseTimeDataset));
+}
+
+/// Number of pulse times read from each group at a time when comparing frames
+const size_t pulseTimeChunkSize = 65536;
+
+/// Most frames and events read ahead from a group when frames are merged
+const hsize_t maxPrefetchFrames = 256;
+const hsize_t maxPrefetchEvents = 1 << 20;
+
+/// Thrown if the NXevent_data groups do not contain the same frames, as
+/// opposed to failing to read them
+class InconsistentFramesError : public std::runtime_error {
+public:
+  InconsistentFramesError()
+      : std::runtime_error("NXevent_data groups in the file do not contain "
+                           "the same frames as each other.") {}
+};
+
+/// Convert times of flight in microseconds to nanoseconds
+std::vector<uint32_t> tofsToNanoseconds(const std::vector<float> &tofFloats) {
+  std::vector<uint32_t> tofs(tofFloats.size());
+  std::transform(tofFloats.cbegin(), tofFloats.cend(), tofs.begin(),
+                 [](float tof) {
+                   return static_cast<uint32_t>(floor((tof * 1000) + 0.5));
+                 });
+  return tofs;
+}
+
 /**
  * We can only currently deal with multiple NXevent_data groups if they contain
  * exactly the same frames
- * If this is not the case then throw an error
+ * If this is not the case then throw an InconsistentFramesError
+ *
+ * The pulse times are compared a chunk at a time, so memory use does not depend
+ * on the length of the run, and the comparison stops at the first mismatch
  *
  * @param eventGroups - the NXevent_data groups found in the file
  */
 void checkEventDataGroupsHaveConsistentFrames(
     std::vector<hdf5::node::Group> const &eventGroups) {
-  if (eventGroups.size() > 1) {
-    auto firstGroupPulseDataset = eventGroups[0].get_dataset("event_time_zero");
-    std::vector<double> firstGroupPulseTimes(
-        static_cast<size_t>(firstGroupPulseDataset.dataspace().size()));
-    firstGroupPulseDataset.read(firstGroupPulseTimes);
-    auto firstPulseTimesNs = secondsToNanoseconds(firstGroupPulseTimes);
-    for (auto const &eventGroup : eventGroups) {
-      auto pulseTimesDataset = eventGroup.get_dataset("event_time_zero");
-      std::vector<double> pulseTimes(
-          static_cast<size_t>(pulseTimesDataset.dataspace().size()));
-      pulseTimesDataset.read(pulseTimes);
-      auto pulseTimesNs = secondsToNanoseconds(pulseTimes);
-      if (firstPulseTimesNs != pulseTimesNs) {
-        throw std::runtime_error("NXevent_data groups in the file do not "
-                                 "contain the same frames as each other, this "
-                                 "is not currently supported.");
+  if (eventGroups.size() < 2) {
+    return;
+  }
+
+  std::vector<hdf5::node::Dataset> pulseTimeDatasets;
+  for (auto const &eventGroup : eventGroups) {
+    pulseTimeDatasets.emplace_back(eventGroup.get_dataset("event_time_zero"));
+  }
+
+  // Comparing lengths first avoids reading anything in the common case of
+  // groups with different numbers of frames
+  const auto numberOfFrames = pulseTimeDatasets[0].dataspace().size();
+  for (auto const &pulseTimeDataset : pulseTimeDatasets) {
+    if (pulseTimeDataset.dataspace().size() != numberOfFrames) {
+      throw InconsistentFramesError();
+    }
+  }
+
+  // HDF5 is not built thread-safe so the groups are read in turn, but each
+  // chunk of the first group is read only once and compared against the same
+  // chunk of every other group before moving on
+  std::vector<double> firstPulseTimes;
+  std::vector<double> pulseTimes;
+  for (hssize_t chunkStart = 0; chunkStart < numberOfFrames;
+       chunkStart += pulseTimeChunkSize) {
+    const auto chunkSize = static_cast<size_t>(std::min<hssize_t>(
+        pulseTimeChunkSize, numberOfFrames - chunkStart));
+    const hdf5::dataspace::Hyperslab slab({static_cast<hsize_t>(chunkStart)},
+                                          {chunkSize}, {1});
+    firstPulseTimes.resize(chunkSize);
+    pulseTimes.resize(chunkSize);
+    pulseTimeDatasets[0].read(firstPulseTimes, slab);
+    for (size_t groupNumber = 1; groupNumber < pulseTimeDatasets.size();
+         ++groupNumber) {
+      pulseTimeDatasets[groupNumber].read(pulseTimes, slab);
+      const auto matches = std::equal(
+          firstPulseTimes.cbegin(), firstPulseTimes.cend(),
+          pulseTimes.cbegin(), [](double firstPulseTime, double pulseTime) {
+            return secondsToNanoseconds(firstPulseTime) ==
+                   secondsToNanoseconds(pulseTime);
+          });
+      if (!matches) {
+        throw InconsistentFramesError();
       }
     }
   }
@@ -54,15 +136,25 @@ NexusFileReader::NexusFileReader(hdf5::file::File file,
                                  const std::vector<int32_t> &detectorNumbers,
                                  const OptionalArgs &settings)
     : m_file(std::move(file)), m_runStart(runStartTimeNanoseconds),
-      m_fakeEventsPerPulse(fakeEventsPerPulse),
-      m_detectorNumbers(detectorNumbers), m_timeOfFlightDist(10000, 100000),
-      m_detectorIDDist(0, static_cast<uint32_t>(detectorNumbers.size() - 1)),
-      m_settings(settings) {
+      m_fakeEventsPerPulse(fakeEventsPerPulse), m_settings(settings),
+      m_logFilter(settings.logFilters) {
   if (!m_file.is_valid()) {
     throw std::runtime_error("Failed to open specified NeXus file");
   }
   getEntryGroup(m_file.root(), m_entryGroup);
-  getEventGroups(m_entryGroup, m_eventGroups);
+
+  const auto indexLoaded =
+      m_settings.useSidecarIndex && m_sidecarIndex.load(m_settings.filename);
+  if (indexLoaded) {
+    m_logger->info("Using index file {}",
+                   SidecarIndex::getIndexFilename(m_settings.filename));
+    for (const auto &groupPath : m_sidecarIndex.getEventGroupPaths()) {
+      m_eventGroups.emplace_back(
+          hdf5::node::get_group(m_file.root(), hdf5::Path(groupPath)));
+    }
+  } else {
+    getEventGroups(m_entryGroup, m_eventGroups);
+  }
   getGroups(m_entryGroup, m_histoGroups, "NXdata",
             {"time_of_flight", "counts"});
 
@@ -73,26 +165,105 @@ NexusFileReader::NexusFileReader(hdf5::file::File file,
 
   m_isisFile = testIfIsISISFile();
 
-  try {
-    checkEventDataGroupsHaveConsistentFrames(m_eventGroups);
-  } catch (const std::runtime_error &e) {
-    m_logger->warn(e.what());
-    m_logger->warn(
-        "Only data from one NXevent_data group will be published to Kafka: {}",
-        m_eventGroups[0].link().path().name());
-    m_eventGroups.resize(1);
+  if (indexLoaded) {
+    // Groups in the index have already been checked for consistent frames
+    m_pulseTimeIndex = PulseTimeIndex(m_sidecarIndex.getPulseTimes());
+  } else {
+    try {
+      checkEventDataGroupsHaveConsistentFrames(m_eventGroups);
+      if (!m_eventGroups.empty()) {
+        m_pulseTimeIndex = PulseTimeIndex(readPulseTimesNanoseconds(
+            m_eventGroups[0].get_dataset("event_time_zero")));
+      }
+    } catch (const InconsistentFramesError &e) {
+      m_logger->info("{} Frames from all groups will be merged in pulse time "
+                     "order.",
+                     e.what());
+      std::vector<std::vector<uint64_t>> groupPulseTimesNs;
+      for (const auto &eventGroup : m_eventGroups) {
+        groupPulseTimesNs.emplace_back(readPulseTimesNanoseconds(
+            eventGroup.get_dataset("event_time_zero")));
+      }
+      m_frameMerger = FrameMerger(groupPulseTimesNs);
+      m_pulseTimeIndex = PulseTimeIndex(m_frameMerger.getPulseTimes());
+      m_prefetchBuffers.resize(m_eventGroups.size());
+    }
   }
+  m_numberOfFrames = m_pulseTimeIndex.getNumberOfFrames();
 
-  if (m_eventGroups.empty()) {
-    m_numberOfFrames = 0;
-  } else {
-    auto frameTimes = m_eventGroups[0].get_dataset("event_time_zero");
-    m_numberOfFrames = static_cast<size_t>(frameTimes.dataspace().size());
+  if (m_settings.useSidecarIndex && !indexLoaded && m_frameMerger.empty()) {
+    writeSidecarIndex();
   }
   // Use pulse times relative to start time rather than using the `offset`
   // attribute from the NeXus file, this makes the timestamps look as if this
   // data is coming from a live instrument
   m_frameStartOffset = m_runStart;
+
+  if (m_fakeEventsPerPulse > 0) {
+    m_fakeEventGenerator = createFakeEventGenerator(detectorNumbers);
+  }
+}
+
+/**
+ * Create the generator for fake events, which are either uniformly
+ * distributed or sampled from the distributions of the events or histograms
+ * in the file
+ *
+ * @param detectorNumbers - detector IDs for uniformly distributed events
+ * @return - generator of fake events
+ */
+std::unique_ptr<FakeEventGenerator> NexusFileReader::createFakeEventGenerator(
+    const std::vector<int32_t> &detectorNumbers) {
+  if (m_settings.fakeEventSampling == "events") {
+    return std::make_unique<FakeEventGenerator>(
+        std::make_shared<const EventDistribution>(scanEventDistribution()),
+        m_settings.fakeEventSeed);
+  }
+  if (m_settings.fakeEventSampling == "histogram") {
+    std::shared_ptr<const DetectorSpectrumMapData> detSpecMap;
+    if (!m_settings.detSpecFilename.empty()) {
+      detSpecMap =
+          DetectorSpectrumMapData::loadShared(m_settings.detSpecFilename);
+    }
+    return std::make_unique<FakeEventGenerator>(
+        std::make_shared<const EventDistribution>(
+            EventDistribution::fromHistograms(getHistoData(),
+                                              detSpecMap.get())),
+        m_settings.fakeEventSeed);
+  }
+  return std::make_unique<FakeEventGenerator>(detectorNumbers,
+                                              m_settings.fakeEventSeed);
+}
+
+/**
+ * Count the detector IDs and times of flight of the events at the start of
+ * each NXevent_data group, up to maxEventsToScan events in total
+ *
+ * @return - distributions of the events in the file
+ */
+EventDistribution NexusFileReader::scanEventDistribution() {
+  EventDistributionBuilder builder;
+  const hsize_t chunkSize = 1 << 20;
+  for (auto &eventGroup : m_eventGroups) {
+    auto detIdDataset = eventGroup.get_dataset("event_id");
+    auto tofDataset = eventGroup.get_dataset("event_time_offset");
+    const auto numberOfEvents =
+        std::min(static_cast<hsize_t>(detIdDataset.dataspace().size()),
+                 static_cast<hsize_t>(maxEventsToScan / m_eventGroups.size()));
+    for (hsize_t offset = 0; offset < numberOfEvents; offset += chunkSize) {
+      const auto count = std::min(chunkSize, numberOfEvents - offset);
+      auto slab = hdf5::dataspace::Hyperslab({offset}, {count}, {1});
+      std::vector<uint32_t> detIds(count);
+      detIdDataset.read(detIds, slab);
+      std::vector<float> tofFloats(count);
+      tofDataset.read(tofFloats, slab);
+      builder.addEvents(detIds, tofsToNanoseconds(tofFloats));
+    }
+  }
+  m_logger->info("Sampling fake events from the distributions of {} events "
+                 "in the file",
+                 builder.getNumberOfEvents());
+  return builder.build();
 }
 
 void NexusFileReader::findEventGroupsInDetectors(
@@ -194,13 +365,16 @@ void NexusFileReader::checkGroupHasRequiredDatasets(
   }
 }
 
-size_t NexusFileReader::findFrameNumberOfTime(float time) {
-  auto frameNumber = static_cast<size_t>(std::floor(time / 0.1));
-  return frameNumber;
-}
-
 std::vector<hdf5::node::Group> NexusFileReader::findNXLogs() {
   std::vector<hdf5::node::Group> NXlogs;
+  if (m_sidecarIndex.isLoaded()) {
+    for (const auto &groupPath : m_sidecarIndex.getLogGroupPaths()) {
+      NXlogs.emplace_back(
+          hdf5::node::get_group(m_file.root(), hdf5::Path(groupPath)));
+    }
+    return NXlogs;
+  }
+
   std::for_each(hdf5::node::RecursiveNodeIterator::begin(m_entryGroup),
                 hdf5::node::RecursiveNodeIterator::end(m_entryGroup),
                 [&NXlogs](const hdf5::node::Node &node) {
@@ -218,47 +392,36 @@ std::vector<hdf5::node::Group> NexusFileReader::findNXLogs() {
   return NXlogs;
 }
 
-std::unordered_map<hsize_t, sEEventVector> NexusFileReader::getSEEventMap() {
+SampleEnvironmentLogs NexusFileReader::getSampleEnvLogs() {
+  SampleEnvironmentLogs sampleEnvLogs(m_runStart);
   if (m_eventGroups.empty()) {
     m_logger->warn("NeXus-Streamer does not currently support streaming NXlog "
                    "data in the case that there is no NXevent_data group in "
                    "the file. Please create an issue on github if this feature "
                    "would be useful to you.");
-    return {};
+    return sampleEnvLogs;
   }
 
-  std::unordered_map<hsize_t, sEEventVector> sEEventMap;
   auto NXlogs = findNXLogs();
 
   if (NXlogs.empty()) {
     m_logger->warn(
         "No NXlog groups found, not publishing sample environment log data");
-    return sEEventMap;
+    return sampleEnvLogs;
   }
 
+  const auto floatType = hdf5::datatype::create<float>();
+  const auto doubleType = hdf5::datatype::create<double>();
+  const auto int16Type = hdf5::datatype::create<int16_t>();
+  const auto int32Type = hdf5::datatype::create<int32_t>();
+  const auto uint16Type = hdf5::datatype::create<uint16_t>();
+  const auto uint32Type = hdf5::datatype::create<uint32_t>();
+  const auto int64Type = hdf5::datatype::create<int64_t>();
+  const auto uint64Type = hdf5::datatype::create<uint64_t>();
+
   for (auto const &sampleEnvGroup : NXlogs) {
     if (!sampleEnvGroup.exists("time") || !sampleEnvGroup.exists("value"))
       continue;
-    std::vector<float> times;
-    std::vector<float> floatValues;
-    std::vector<double> doubleValues;
-    std::vector<int32_t> int32Values;
-    std::vector<uint32_t> uint32Values;
-    std::vector<int64_t> int64Values;
-    std::vector<uint64_t> uint64Values;
-
-    const auto floatType = hdf5::datatype::create<float>();
-    const auto doubleType = hdf5::datatype::create<double>();
-    const auto int16Type = hdf5::datatype::create<int16_t>();
-    const auto int32Type = hdf5::datatype::create<int32_t>();
-    const auto uint16Type = hdf5::datatype::create<uint16_t>();
-    const auto uint32Type = hdf5::datatype::create<uint32_t>();
-    const auto int64Type = hdf5::datatype::create<int64_t>();
-    const auto uint64Type = hdf5::datatype::create<uint64_t>();
-
-    auto timeDataset = sampleEnvGroup.get_dataset("time");
-    times.resize(static_cast<size_t>(timeDataset.dataspace().size()));
-    timeDataset.read(times);
 
     std::string name = sampleEnvGroup.link().target().object_path().name();
 
@@ -269,72 +432,54 @@ std::unordered_map<hsize_t, sEEventVector> NexusFileReader::getSEEventMap() {
           sampleEnvGroup.link().parent().link().target().object_path().name();
     }
 
+    // Values are read into the widest type of the same kind, HDF5 does the
+    // conversion, so that only a few value types need to be serialised
+    SampleEnvironmentLog log;
     auto valueDataset = sampleEnvGroup.get_dataset("value");
     auto valueType = valueDataset.datatype();
-    auto dataSize = static_cast<size_t>(valueDataset.dataspace().size());
-    if (valueType == floatType) {
-      floatValues.resize(dataSize);
-      valueDataset.read(floatValues);
-    } else if (valueType == doubleType) {
-      doubleValues.resize(dataSize);
-      valueDataset.read(doubleValues);
+    if (valueType == floatType || valueType == doubleType) {
+      log.values = readDataset<double>(valueDataset);
     } else if (valueType == int32Type || valueType == int16Type) {
-      int32Values.resize(dataSize);
-      valueDataset.read(int32Values);
+      log.values = readDataset<int32_t>(valueDataset);
     } else if (valueType == int64Type) {
-      int64Values.resize(dataSize);
-      valueDataset.read(int64Values);
+      log.values = readDataset<int64_t>(valueDataset);
     } else if (valueType == uint32Type || valueType == uint16Type) {
-      uint32Values.resize(dataSize);
-      valueDataset.read(uint32Values);
+      log.values = readDataset<uint32_t>(valueDataset);
     } else if (valueType == uint64Type) {
-      uint64Values.resize(dataSize);
-      valueDataset.read(uint64Values);
+      log.values = readDataset<uint64_t>(valueDataset);
     } else {
       m_logger->warn("Unsupported datatype found in log dataset {}", name);
       continue;
     }
+    log.times = readDataset<float>(sampleEnvGroup.get_dataset("time"));
+    log.nameID = sampleEnvLogs.internName(name);
+
+    const auto numberOfSamples = std::min(
+        log.times.size(),
+        nonstd::visit([](const auto &values) { return values.size(); },
+                      log.values));
+
+    // The number of the frame each sample happened in
+    const auto frameNumbers = m_pulseTimeIndex.findFrameNumbers(log.times);
+
+    const auto selectedSamples = m_logFilter.selectSamples(
+        name, log.times, log.values, numberOfSamples);
+    if (selectedSamples.size() < numberOfSamples) {
+      m_logger->debug("Log filter kept {} of {} samples from {}",
+                      selectedSamples.size(), numberOfSamples, name);
+    }
 
-    for (size_t i = 0; i < times.size(); i++) {
-      // Ignore entries for events which do not occur during the run
-      if (times[i] > 0) {
-        // The number of the frame the event happened in
-        auto frameNumber = findFrameNumberOfTime(times[i]);
-        if (frameNumber > m_numberOfFrames) {
-          continue;
-        }
-        if (sEEventMap.count(frameNumber) == 0) {
-          sEEventMap[frameNumber] = sEEventVector();
-        }
-        if (valueType == floatType) {
-          sEEventMap[frameNumber].push_back(
-              std::make_shared<SampleEnvironmentEventDouble>(
-                  name, times[i], floatValues[i], m_runStart));
-        } else if (valueType == doubleType) {
-          sEEventMap[frameNumber].push_back(
-              std::make_shared<SampleEnvironmentEventDouble>(
-                  name, times[i], doubleValues[i], m_runStart));
-        } else if (valueType == int32Type) {
-          sEEventMap[frameNumber].push_back(
-              std::make_shared<SampleEnvironmentEventInt>(
-                  name, times[i], int32Values[i], m_runStart));
-        } else if (valueType == int64Type) {
-          sEEventMap[frameNumber].push_back(
-              std::make_shared<SampleEnvironmentEventLong>(
-                  name, times[i], int64Values[i], m_runStart));
-        } else if (valueType == uint32Type) {
-          sEEventMap[frameNumber].push_back(
-              std::make_shared<SampleEnvironmentEventUInt>(
-                  name, times[i], uint32Values[i], m_runStart));
-        } else if (valueType == uint64Type) {
-          sEEventMap[frameNumber].push_back(
-              std::make_shared<SampleEnvironmentEventULong>(
-                  name, times[i], uint64Values[i], m_runStart));
-        }
+    const auto logIndex = sampleEnvLogs.addLog(std::move(log));
+    for (const auto sampleIndex : selectedSamples) {
+      // Ignore entries for samples which do not occur during the run
+      if (frameNumbers[sampleIndex] != PulseTimeIndex::noFrame) {
+        sampleEnvLogs.addSample(frameNumbers[sampleIndex],
+                                {logIndex, sampleIndex});
       }
     }
   }
-  return sEEventMap;
+  sampleEnvLogs.buildFrameIndex();
+  return sampleEnvLogs;
 }
 
 /**
@@ -351,7 +496,12 @@ hsize_t NexusFileReader::getFileSize() { return m_file.size(); }
  */
 uint64_t NexusFileReader::getTotalEventCount() {
   if (m_fakeEventsPerPulse > 0) {
-    return getNumberOfFrames() * m_fakeEventsPerPulse * m_eventGroups.size();
+    // Only the groups with a frame at its pulse time get fake events in a
+    // merged frame
+    const auto numberOfGroupFrames =
+        m_frameMerger.empty() ? getNumberOfFrames() * m_eventGroups.size()
+                              : m_frameMerger.getNumberOfGroupFrames();
+    return numberOfGroupFrames * m_fakeEventsPerPulse;
   }
 
   uint64_t totalEvents = 0;
@@ -422,24 +572,7 @@ float NexusFileReader::getProtonCharge(hsize_t frameNumber) {
  * @return - absolute time of frame start in nanoseconds since 1 Jan 1970
  */
 uint64_t NexusFileReader::getFrameTime(hsize_t frameNumber) {
-  std::string datasetName = "event_time_zero";
-
-  auto dataset = m_eventGroups[0].get_dataset(datasetName);
-  std::string units;
-  uint64_t frameTimeFromOffsetNanoseconds;
-  if (dataset.attributes.exists("units")) {
-    dataset.attributes["units"].read(units);
-    if (units == "ns" || units == "nanoseconds") {
-      frameTimeFromOffsetNanoseconds = getSingleValueFromDataset<uint64_t>(
-          m_eventGroups[0], datasetName, frameNumber);
-      return m_frameStartOffset + frameTimeFromOffsetNanoseconds;
-    }
-    // else assume seconds
-  }
-  auto frameTime = getSingleValueFromDataset<double>(m_eventGroups[0],
-                                                     datasetName, frameNumber);
-  frameTimeFromOffsetNanoseconds = secondsToNanoseconds(frameTime);
-  return m_frameStartOffset + frameTimeFromOffsetNanoseconds;
+  return m_frameStartOffset + m_pulseTimeIndex.getPulseTime(frameNumber);
 }
 
 /**
@@ -450,22 +583,7 @@ uint64_t NexusFileReader::getFrameTime(hsize_t frameNumber) {
  */
 uint64_t
 NexusFileReader::getRelativeFrameTimeMilliseconds(const hsize_t frameNumber) {
-  std::string datasetName = "event_time_zero";
-
-  auto dataset = m_eventGroups[0].get_dataset(datasetName);
-  std::string units;
-  if (dataset.attributes.exists("units")) {
-    dataset.attributes["units"].read(units);
-    if (units == "ns" || units == "nanoseconds") {
-      auto frameTimeNanoseconds = getSingleValueFromDataset<uint64_t>(
-          m_eventGroups[0], datasetName, frameNumber);
-      return nanosecondsToMilliseconds(frameTimeNanoseconds);
-    }
-    // else assume seconds
-  }
-  auto frameTime = getSingleValueFromDataset<double>(m_eventGroups[0],
-                                                     datasetName, frameNumber);
-  return secondsToMilliseconds(frameTime);
+  return nanosecondsToMilliseconds(m_pulseTimeIndex.getPulseTime(frameNumber));
 }
 
 template <typename T>
@@ -488,6 +606,9 @@ T NexusFileReader::getSingleValueFromDataset(const hdf5::node::Group &group,
  */
 hsize_t NexusFileReader::getFrameStart(hsize_t frameNumber,
                                        size_t eventGroupNumber) {
+  if (m_sidecarIndex.isLoaded()) {
+    return m_sidecarIndex.getFrameOffset(eventGroupNumber, frameNumber);
+  }
   std::string datasetName = "event_index";
   auto frameStart = getSingleValueFromDataset<hsize_t>(
       m_eventGroups[eventGroupNumber], datasetName, frameNumber);
@@ -495,6 +616,21 @@ hsize_t NexusFileReader::getFrameStart(hsize_t frameNumber,
   return frameStart;
 }
 
+/**
+ * Gets the number of frames in the specified event group, which is the same
+ * for every group unless their frames are being merged
+ *
+ * @param eventGroupNumber - index of the NXevent_data group
+ * @return - number of frames in the group
+ */
+hsize_t
+NexusFileReader::getNumberOfFramesInGroup(size_t eventGroupNumber) const {
+  if (!m_frameMerger.empty()) {
+    return m_frameMerger.getNumberOfFramesInGroup(eventGroupNumber);
+  }
+  return m_numberOfFrames;
+}
+
 /**
  * Get the number of events which are in the specified frame
  *
@@ -509,7 +645,7 @@ hsize_t NexusFileReader::getNumberOfEventsInFrame(hsize_t frameNumber,
   }
   // if this is the last frame then we cannot get number of events by looking at
   // event index of next frame
-  if (frameNumber == (m_numberOfFrames - 1)) {
+  if (frameNumber == (getNumberOfFramesInGroup(eventGroupNumber) - 1)) {
     return getTotalEventsInGroup(eventGroupNumber) -
            getFrameStart(frameNumber, eventGroupNumber);
   }
@@ -526,20 +662,11 @@ hsize_t NexusFileReader::getNumberOfEventsInFrame(hsize_t frameNumber,
  */
 std::vector<uint32_t> NexusFileReader::getEventDetIds(hsize_t frameNumber,
                                                       size_t eventGroupNumber) {
-  if (frameNumber >= m_numberOfFrames)
+  if (frameNumber >= getNumberOfFramesInGroup(eventGroupNumber))
     return {};
 
   std::vector<uint32_t> detIds;
 
-  if (m_fakeEventsPerPulse > 0) {
-    detIds.reserve(static_cast<size_t>(m_fakeEventsPerPulse));
-    for (size_t i = 0; i < static_cast<size_t>(m_fakeEventsPerPulse); i++) {
-      detIds.push_back(static_cast<uint32_t>(
-          m_detectorNumbers[m_detectorIDDist(RandomEngine)]));
-    }
-    return detIds;
-  }
-
   auto dataset = m_eventGroups[eventGroupNumber].get_dataset("event_id");
 
   auto numberOfEventsInFrame =
@@ -566,19 +693,11 @@ std::vector<uint32_t> NexusFileReader::getEventDetIds(hsize_t frameNumber,
  */
 std::vector<uint32_t> NexusFileReader::getEventTofs(hsize_t frameNumber,
                                                     size_t eventGroupNumber) {
-  if (frameNumber >= m_numberOfFrames)
+  if (frameNumber >= getNumberOfFramesInGroup(eventGroupNumber))
     return {};
 
   std::vector<uint32_t> tofs;
 
-  if (m_fakeEventsPerPulse > 0) {
-    tofs.reserve(static_cast<size_t>(m_fakeEventsPerPulse));
-    for (size_t i = 0; i < static_cast<size_t>(m_fakeEventsPerPulse); i++) {
-      tofs.push_back(static_cast<uint32_t>(m_timeOfFlightDist(RandomEngine)));
-    }
-    return tofs;
-  }
-
   auto dataset =
       m_eventGroups[eventGroupNumber].get_dataset("event_time_offset");
 
@@ -590,20 +709,107 @@ std::vector<uint32_t> NexusFileReader::getEventTofs(hsize_t frameNumber,
 
   auto slab = hdf5::dataspace::Hyperslab({offset}, {count}, {1});
   std::vector<float> tof_floats(count);
-  tofs.resize(numberOfEventsInFrame);
 
   dataset.read(tof_floats, slab);
-  // transform float in microseconds to uint32 in nanoseconds
-  std::transform(tof_floats.begin(), tof_floats.end(), tofs.begin(),
-                 [](float tof) {
-                   return static_cast<uint32_t>(floor((tof * 1000) + 0.5));
-                 });
+  return tofsToNanoseconds(tof_floats);
+}
 
-  return tofs;
+/**
+ * Get the events of a frame of a group from the group's prefetch buffer,
+ * reading the following frames of the group into the buffer if the frame is
+ * not already in it. Merged frames visit each group's frames in order, so each
+ * group is read in large blocks rather than a frame at a time.
+ *
+ * @param frameNumber - the number of the frame within the group
+ * @param eventGroupNumber - index of the NXevent_data group
+ * @return - events of the frame
+ */
+EventDataFrame NexusFileReader::getPrefetchedEvents(hsize_t frameNumber,
+                                                    size_t eventGroupNumber) {
+  auto &buffer = m_prefetchBuffers[eventGroupNumber];
+  if (frameNumber < buffer.firstFrame ||
+      frameNumber + 1 >= buffer.firstFrame + buffer.frameOffsets.size()) {
+    prefetchEvents(frameNumber, eventGroupNumber);
+  }
+  const auto frameIndex = frameNumber - buffer.firstFrame;
+  const auto begin = buffer.frameOffsets[frameIndex];
+  const auto end = buffer.frameOffsets[frameIndex + 1];
+  return {{buffer.detIds.cbegin() + begin, buffer.detIds.cbegin() + end},
+          {buffer.tofs.cbegin() + begin, buffer.tofs.cbegin() + end}};
+}
+
+/**
+ * Read the events of up to maxPrefetchFrames frames of a group, starting from
+ * the specified frame, into the group's prefetch buffer. Fewer frames are read
+ * if they would hold more than maxPrefetchEvents events, but always at least
+ * one frame.
+ *
+ * @param frameNumber - the number of the first frame to read
+ * @param eventGroupNumber - index of the NXevent_data group
+ */
+void NexusFileReader::prefetchEvents(hsize_t frameNumber,
+                                     size_t eventGroupNumber) {
+  const auto &eventGroup = m_eventGroups[eventGroupNumber];
+  const auto numberOfFramesInGroup = getNumberOfFramesInGroup(eventGroupNumber);
+  const auto numberOfFrames =
+      std::min(maxPrefetchFrames, numberOfFramesInGroup - frameNumber);
+
+  // Read the start of the frame after the last one too, unless the last one
+  // is the end of the group
+  const auto readsEndOfGroup =
+      frameNumber + numberOfFrames == numberOfFramesInGroup;
+  std::vector<uint64_t> frameStarts(
+      static_cast<size_t>(numberOfFrames + (readsEndOfGroup ? 0 : 1)));
+  eventGroup.get_dataset("event_index")
+      .read(frameStarts, hdf5::dataspace::Hyperslab(
+                             {frameNumber}, {frameStarts.size()}, {1}));
+  if (readsEndOfGroup) {
+    frameStarts.push_back(getTotalEventsInGroup(eventGroupNumber));
+  }
+
+  // Drop frames from the end beyond the event limit, keeping the end of the
+  // last frame which is kept
+  auto frameEnd = frameStarts.cbegin() + 2;
+  while (frameEnd != frameStarts.cend() &&
+         *frameEnd - frameStarts[0] <= maxPrefetchEvents) {
+    ++frameEnd;
+  }
+  frameStarts.erase(frameEnd, frameStarts.cend());
+
+  const auto offset = frameStarts.front();
+  const auto count = frameStarts.back() - offset;
+  auto slab = hdf5::dataspace::Hyperslab({offset}, {count}, {1});
+  auto &buffer = m_prefetchBuffers[eventGroupNumber];
+  buffer.firstFrame = frameNumber;
+  buffer.frameOffsets.clear();
+  for (const auto frameStart : frameStarts) {
+    buffer.frameOffsets.push_back(frameStart - offset);
+  }
+  buffer.detIds.resize(count);
+  std::vector<float> tofFloats(count);
+  if (count > 0) {
+    eventGroup.get_dataset("event_id").read(buffer.detIds, slab);
+    eventGroup.get_dataset("event_time_offset").read(tofFloats, slab);
+  }
+  buffer.tofs = tofsToNanoseconds(tofFloats);
 }
 
 std::vector<EventDataFrame> NexusFileReader::getEventData(hsize_t frameNumber) {
+  if (m_fakeEventGenerator != nullptr) {
+    return getFakeEventData(frameNumber);
+  }
   std::vector<EventDataFrame> eventData;
+  if (!m_frameMerger.empty()) {
+    for (const auto &groupFrame : m_frameMerger.getGroupFrames(frameNumber)) {
+      auto events = getPrefetchedEvents(groupFrame.frameNumber,
+                                        groupFrame.eventGroupNumber);
+      if (!events.detectorIDs.empty() && !events.timeOfFlights.empty()) {
+        eventData.push_back(std::move(events));
+      }
+    }
+    return eventData;
+  }
+
   for (size_t eventGroupNumber = 0; eventGroupNumber < m_eventGroups.size();
        ++eventGroupNumber) {
     auto detIDs = getEventDetIds(frameNumber, eventGroupNumber);
@@ -615,6 +821,38 @@ std::vector<EventDataFrame> NexusFileReader::getEventData(hsize_t frameNumber) {
   return eventData;
 }
 
+/**
+ * Generate fake events for each NXevent_data group with data in the specified
+ * frame, every group in every frame gets a new stream of random numbers so
+ * later runs do not repeat the events
+ *
+ * @param frameNumber - the number of the frame
+ * @return - fake events of each group
+ */
+std::vector<EventDataFrame>
+NexusFileReader::getFakeEventData(hsize_t frameNumber) {
+  const auto numberOfEvents = static_cast<size_t>(m_fakeEventsPerPulse);
+  size_t numberOfGroups = 0;
+  if (!m_frameMerger.empty()) {
+    numberOfGroups = m_frameMerger.getGroupFrames(frameNumber).size();
+  } else {
+    for (size_t eventGroupNumber = 0; eventGroupNumber < m_eventGroups.size();
+         ++eventGroupNumber) {
+      if (frameNumber < getNumberOfFramesInGroup(eventGroupNumber)) {
+        ++numberOfGroups;
+      }
+    }
+  }
+
+  std::vector<EventDataFrame> eventData;
+  eventData.reserve(numberOfGroups);
+  for (size_t group = 0; group < numberOfGroups; ++group) {
+    eventData.push_back(m_fakeEventGenerator->generate(
+        m_numberOfFakeEventStreams++, numberOfEvents));
+  }
+  return eventData;
+}
+
 std::vector<HistogramFrame> NexusFileReader::getHistoData() {
   std::vector<HistogramFrame> histogramData;
   for (const auto &histoGroup : m_histoGroups) {
@@ -657,6 +895,35 @@ bool NexusFileReader::testIfIsISISFile() {
   return false;
 }
 
+/**
+ * Write an index of the file next to it, so that the next time the file is
+ * opened it does not have to be searched and the frame information read, and
+ * then use the index for the rest of this run
+ */
+void NexusFileReader::writeSidecarIndex() {
+  SidecarIndexContents contents;
+  for (const auto &eventGroup : m_eventGroups) {
+    contents.eventGroupPaths.emplace_back(
+        static_cast<std::string>(eventGroup.link().path()));
+    contents.frameOffsets.emplace_back(
+        readDataset<uint64_t>(eventGroup.get_dataset("event_index")));
+  }
+  for (const auto &logGroup : findNXLogs()) {
+    contents.logGroupPaths.emplace_back(
+        static_cast<std::string>(logGroup.link().path()));
+  }
+  contents.pulseTimesNs = m_pulseTimeIndex.getPulseTimes();
+
+  try {
+    SidecarIndex::write(m_settings.filename, contents);
+    m_sidecarIndex.load(m_settings.filename);
+    m_logger->info("Wrote index file {}",
+                   SidecarIndex::getIndexFilename(m_settings.filename));
+  } catch (const std::runtime_error &e) {
+    m_logger->warn(e.what());
+  }
+}
+
 uint32_t NexusFileReader::getRunDurationMs() {
   if (m_entryGroup.has_dataset("duration")) {
     auto durationDataset = m_entryGroup.get_dataset("duration");
@@ -0,0 +1,85 @@
+#include <algorithm>
+
+#include "PulseTimeIndex.h"
+
+constexpr size_t PulseTimeIndex::noFrame;
+
+PulseTimeIndex::PulseTimeIndex(std::vector<uint64_t> pulseTimesNs)
+    : m_pulseTimesNs(std::move(pulseTimesNs)) {
+  if (m_pulseTimesNs.size() > 1) {
+    // Assume the last frame is as long as the one before it
+    const auto lastFrameDuration =
+        m_pulseTimesNs.back() - m_pulseTimesNs[m_pulseTimesNs.size() - 2];
+    m_endOfLastFrameNs = m_pulseTimesNs.back() + lastFrameDuration;
+  } else {
+    m_endOfLastFrameNs = std::numeric_limits<uint64_t>::max();
+  }
+}
+
+/**
+ * Find the frame which the given time falls in, times before the first pulse
+ * are assigned to the first frame
+ *
+ * @param timeNs - time in nanoseconds relative to the same reference as the
+ * pulse times
+ * @return - frame number, or noFrame if the time is after the last frame
+ */
+size_t PulseTimeIndex::findFrameNumber(uint64_t timeNs) const {
+  if (m_pulseTimesNs.empty() || timeNs >= m_endOfLastFrameNs) {
+    return noFrame;
+  }
+  auto nextFrame =
+      std::upper_bound(m_pulseTimesNs.cbegin(), m_pulseTimesNs.cend(), timeNs);
+  if (nextFrame == m_pulseTimesNs.cbegin()) {
+    return 0;
+  }
+  return static_cast<size_t>(
+      std::distance(m_pulseTimesNs.cbegin(), nextFrame) - 1);
+}
+
+/**
+ * Find the frame which each of the given times falls in, times at or before
+ * zero are not during the run and are given noFrame
+ *
+ * @param timesSeconds - times in seconds, for example from an NXlog
+ * @return - frame number for each time
+ */
+std::vector<size_t>
+PulseTimeIndex::findFrameNumbers(const std::vector<float> &timesSeconds) const {
+  std::vector<size_t> frameNumbers(timesSeconds.size(), noFrame);
+  if (m_pulseTimesNs.empty()) {
+    return frameNumbers;
+  }
+
+  // NXlog times are almost always in order, in which case a single merge pass
+  // over the log times and pulse times finds every frame
+  if (!std::is_sorted(timesSeconds.cbegin(), timesSeconds.cend())) {
+    std::transform(timesSeconds.cbegin(), timesSeconds.cend(),
+                   frameNumbers.begin(), [this](float timeSeconds) {
+                     if (timeSeconds <= 0) {
+                       return noFrame;
+                     }
+                     return findFrameNumber(
+                         static_cast<uint64_t>(timeSeconds * 1e9));
+                   });
+    return frameNumbers;
+  }
+
+  size_t frameNumber = 0;
+  const auto lastFrameNumber = m_pulseTimesNs.size() - 1;
+  for (size_t timeIndex = 0; timeIndex < timesSeconds.size(); ++timeIndex) {
+    if (timesSeconds[timeIndex] <= 0) {
+      continue;
+    }
+    const auto timeNs = static_cast<uint64_t>(timesSeconds[timeIndex] * 1e9);
+    if (timeNs >= m_endOfLastFrameNs) {
+      break;
+    }
+    while (frameNumber < lastFrameNumber &&
+           m_pulseTimesNs[frameNumber + 1] <= timeNs) {
+      ++frameNumber;
+    }
+    frameNumbers[timeIndex] = frameNumber;
+  }
+  return frameNumbers;
+}
@@ -0,0 +1,277 @@
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SidecarIndex.h"
+
+namespace {
+const char indexMagic[8] = {'N', 'S', 'I', 'D', 'X', '\0', '\0', '\0'};
+/// Version 2 stores the modification time in nanoseconds rather than seconds
+const uint32_t indexVersion = 2;
+
+/// Fixed size start of the index file, followed by the group paths, the pulse
+/// times and the frame offsets of each event group, each 8 byte aligned
+struct SidecarIndexHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t numberOfEventGroups;
+  uint64_t nexusFileSize;
+  /// Modification time of the NeXus file in nanoseconds
+  int64_t nexusModifiedTimeNs;
+  uint64_t numberOfFrames;
+  uint32_t numberOfLogGroups;
+  /// Size in bytes of the group paths, including padding
+  uint32_t pathsSize;
+};
+
+size_t paddedSize(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+/**
+ * Get the size and modification time of a file
+ *
+ * @param filename - full path of the file
+ * @param sizeOutput - size of the file in bytes
+ * @param modifiedTimeNsOutput - modification time in nanoseconds since epoch,
+ * so that a file rewritten within the same second is noticed
+ * @return - false if the file could not be found
+ */
+bool getFileStatus(const std::string &filename, uint64_t &sizeOutput,
+                   int64_t &modifiedTimeNsOutput) {
+  struct stat fileStatus {};
+  if (stat(filename.c_str(), &fileStatus) != 0) {
+    return false;
+  }
+  sizeOutput = static_cast<uint64_t>(fileStatus.st_size);
+  modifiedTimeNsOutput =
+      static_cast<int64_t>(fileStatus.st_mtim.tv_sec) * 1000000000 +
+      static_cast<int64_t>(fileStatus.st_mtim.tv_nsec);
+  return true;
+}
+
+void writePaths(std::ofstream &indexFile,
+                const std::vector<std::string> &paths) {
+  for (const auto &path : paths) {
+    const auto length = static_cast<uint32_t>(path.size());
+    indexFile.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    indexFile.write(path.data(), path.size());
+  }
+}
+
+size_t pathsSize(const std::vector<std::string> &paths) {
+  size_t size = 0;
+  for (const auto &path : paths) {
+    size += sizeof(uint32_t) + path.size();
+  }
+  return size;
+}
+
+/**
+ * Read group paths from the index
+ *
+ * @param position - start of the paths, moved past them
+ * @param end - end of the paths section
+ * @param numberOfPaths - number of paths to read
+ * @param pathsOutput - the paths which were read
+ * @return - false if the paths section is too short
+ */
+bool readPaths(const char *&position, const char *end, uint32_t numberOfPaths,
+               std::vector<std::string> &pathsOutput) {
+  for (uint32_t pathNumber = 0; pathNumber < numberOfPaths; ++pathNumber) {
+    uint32_t length;
+    if (end - position < static_cast<std::ptrdiff_t>(sizeof(length))) {
+      return false;
+    }
+    std::memcpy(&length, position, sizeof(length));
+    position += sizeof(length);
+    if (end - position < static_cast<std::ptrdiff_t>(length)) {
+      return false;
+    }
+    pathsOutput.emplace_back(position, length);
+    position += length;
+  }
+  return true;
+}
+} // namespace
+
+SidecarIndex::~SidecarIndex() { unmap(); }
+
+SidecarIndex::SidecarIndex(SidecarIndex &&other) noexcept {
+  *this = std::move(other);
+}
+
+SidecarIndex &SidecarIndex::operator=(SidecarIndex &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    m_mapping = other.m_mapping;
+    m_mappingSize = other.m_mappingSize;
+    m_numberOfFrames = other.m_numberOfFrames;
+    m_pulseTimesNs = other.m_pulseTimesNs;
+    m_frameOffsets = other.m_frameOffsets;
+    m_eventGroupPaths = std::move(other.m_eventGroupPaths);
+    m_logGroupPaths = std::move(other.m_logGroupPaths);
+    other.m_mapping = nullptr;
+    other.m_mappingSize = 0;
+  }
+  return *this;
+}
+
+std::string SidecarIndex::getIndexFilename(const std::string &nexusFilename) {
+  return nexusFilename + ".nsidx";
+}
+
+/**
+ * Write an index for the given NeXus file, replacing any existing index
+ *
+ * @param nexusFilename - full path of the NeXus file
+ * @param contents - information to store in the index
+ */
+void SidecarIndex::write(const std::string &nexusFilename,
+                         const SidecarIndexContents &contents) {
+  SidecarIndexHeader header{};
+  std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+  header.version = indexVersion;
+  if (!getFileStatus(nexusFilename, header.nexusFileSize,
+                     header.nexusModifiedTimeNs)) {
+    throw std::runtime_error("Unable to find size and modification time of " +
+                             nexusFilename);
+  }
+  header.numberOfEventGroups =
+      static_cast<uint32_t>(contents.eventGroupPaths.size());
+  header.numberOfLogGroups =
+      static_cast<uint32_t>(contents.logGroupPaths.size());
+  header.numberOfFrames = contents.pulseTimesNs.size();
+  for (const auto &offsets : contents.frameOffsets) {
+    if (offsets.size() != header.numberOfFrames) {
+      throw std::runtime_error("Number of event indices does not match the "
+                               "number of frames, not writing index");
+    }
+  }
+  const auto unpaddedPathsSize = pathsSize(contents.eventGroupPaths) +
+                                 pathsSize(contents.logGroupPaths);
+  header.pathsSize = static_cast<uint32_t>(paddedSize(unpaddedPathsSize));
+
+  // Write to a temporary file and rename so that a partially written index
+  // is never used
+  const auto indexFilename = getIndexFilename(nexusFilename);
+  const auto temporaryFilename = indexFilename + ".tmp";
+  {
+    std::ofstream indexFile(temporaryFilename, std::ios::binary);
+    if (!indexFile) {
+      throw std::runtime_error("Unable to create index file " +
+                               temporaryFilename);
+    }
+    indexFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writePaths(indexFile, contents.eventGroupPaths);
+    writePaths(indexFile, contents.logGroupPaths);
+    const std::vector<char> padding(header.pathsSize - unpaddedPathsSize, 0);
+    indexFile.write(padding.data(), padding.size());
+    indexFile.write(
+        reinterpret_cast<const char *>(contents.pulseTimesNs.data()),
+        contents.pulseTimesNs.size() * sizeof(uint64_t));
+    for (const auto &offsets : contents.frameOffsets) {
+      indexFile.write(reinterpret_cast<const char *>(offsets.data()),
+                      offsets.size() * sizeof(uint64_t));
+    }
+    if (!indexFile) {
+      throw std::runtime_error("Failed writing index file " +
+                               temporaryFilename);
+    }
+  }
+  if (std::rename(temporaryFilename.c_str(), indexFilename.c_str()) != 0) {
+    std::remove(temporaryFilename.c_str());
+    throw std::runtime_error("Unable to replace index file " + indexFilename);
+  }
+}
+
+/**
+ * Map the index of the given NeXus file
+ *
+ * @param nexusFilename - full path of the NeXus file
+ * @return - false if there is no index or it is out of date or invalid
+ */
+bool SidecarIndex::load(const std::string &nexusFilename) {
+  unmap();
+  m_eventGroupPaths.clear();
+  m_logGroupPaths.clear();
+
+  uint64_t nexusFileSize;
+  int64_t nexusModifiedTimeNs;
+  if (!getFileStatus(nexusFilename, nexusFileSize, nexusModifiedTimeNs)) {
+    return false;
+  }
+
+  const auto indexFilename = getIndexFilename(nexusFilename);
+  const auto fileDescriptor = open(indexFilename.c_str(), O_RDONLY);
+  if (fileDescriptor < 0) {
+    return false;
+  }
+  struct stat indexStatus {};
+  if (fstat(fileDescriptor, &indexStatus) != 0 ||
+      static_cast<size_t>(indexStatus.st_size) < sizeof(SidecarIndexHeader)) {
+    close(fileDescriptor);
+    return false;
+  }
+  const auto indexSize = static_cast<size_t>(indexStatus.st_size);
+  auto mapping =
+      mmap(nullptr, indexSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  // The mapping remains valid after the file is closed
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  m_mapping = mapping;
+  m_mappingSize = indexSize;
+
+  const auto *data = static_cast<const char *>(m_mapping);
+  SidecarIndexHeader header{};
+  std::memcpy(&header, data, sizeof(header));
+  const auto arraysSize = (header.numberOfFrames +
+                           header.numberOfEventGroups * header.numberOfFrames) *
+                          sizeof(uint64_t);
+  if (std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 ||
+      header.version != indexVersion ||
+      header.nexusFileSize != nexusFileSize ||
+      header.nexusModifiedTimeNs != nexusModifiedTimeNs ||
+      indexSize != sizeof(header) + header.pathsSize + arraysSize) {
+    unmap();
+    return false;
+  }
+
+  const auto *position = data + sizeof(header);
+  const auto *pathsEnd = position + header.pathsSize;
+  if (!readPaths(position, pathsEnd, header.numberOfEventGroups,
+                 m_eventGroupPaths) ||
+      !readPaths(position, pathsEnd, header.numberOfLogGroups,
+                 m_logGroupPaths)) {
+    m_eventGroupPaths.clear();
+    m_logGroupPaths.clear();
+    unmap();
+    return false;
+  }
+
+  m_numberOfFrames = header.numberOfFrames;
+  m_pulseTimesNs = reinterpret_cast<const uint64_t *>(pathsEnd);
+  m_frameOffsets = m_pulseTimesNs + m_numberOfFrames;
+  return true;
+}
+
+std::vector<uint64_t> SidecarIndex::getPulseTimes() const {
+  return std::vector<uint64_t>(m_pulseTimesNs,
+                               m_pulseTimesNs + m_numberOfFrames);
+}
+
+void SidecarIndex::unmap() {
+  if (m_mapping != nullptr) {
+    munmap(m_mapping, m_mappingSize);
+    m_mapping = nullptr;
+    m_mappingSize = 0;
+    m_pulseTimesNs = nullptr;
+    m_frameOffsets = nullptr;
+    m_numberOfFrames = 0;
+  }
+}
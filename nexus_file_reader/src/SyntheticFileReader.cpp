@@ -0,0 +1,102 @@
+#include <limits>
+#include <stdexcept>
+
+#include "../../core/include/EventDataFrame.h"
+#include "../../core/include/HistogramFrame.h"
+#include "SyntheticFileReader.h"
+
+/**
+ * Create a source of synthetic events
+ *
+ * @param runStartTimeNanoseconds - time of the first pulse of each run
+ * @param detectorNumbers - detector IDs to give events
+ * @param settings - pulse frequency, run duration, mean number of events per
+ * pulse and how the number of events is distributed
+ */
+SyntheticFileReader::SyntheticFileReader(
+    const uint64_t runStartTimeNanoseconds,
+    const std::vector<int32_t> &detectorNumbers, const OptionalArgs &settings)
+    : m_runStart(runStartTimeNanoseconds),
+      m_pulsePeriodNs(1e9 / settings.syntheticPulseRateHz),
+      m_numberOfFrames(
+          settings.syntheticRunDurationS == 0
+              ? std::numeric_limits<size_t>::max()
+              : static_cast<size_t>(settings.syntheticRunDurationS *
+                                    settings.syntheticPulseRateHz)),
+      m_meanEventsPerPulse(
+          static_cast<uint32_t>(std::max(0, settings.fakeEventsPerPulse))),
+      m_poissonEventCounts(settings.syntheticEventDistribution == "poisson"),
+      m_instrumentName(settings.instrumentName),
+      m_eventGenerator(detectorNumbers, settings.fakeEventSeed),
+      m_eventCountDist(std::max(1u, m_meanEventsPerPulse)),
+      RandomEngine(static_cast<std::default_random_engine::result_type>(
+          settings.fakeEventSeed)) {
+  if (settings.syntheticPulseRateHz <= 0) {
+    throw std::runtime_error("Synthetic pulse rate must be positive");
+  }
+}
+
+/// @return - expected number of events in the run, as the number of events
+/// in each pulse is random
+uint64_t SyntheticFileReader::getTotalEventCount() {
+  return getTotalEventsInGroup(0);
+}
+
+uint64_t SyntheticFileReader::getTotalEventsInGroup(size_t) {
+  if (m_numberOfFrames == std::numeric_limits<size_t>::max()) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return static_cast<uint64_t>(m_numberOfFrames) * m_meanEventsPerPulse;
+}
+
+/**
+ * Generate the events of a pulse, all in a single event group
+ *
+ * @param frameNumber - the number of the pulse
+ * @return - detector IDs and times of flight of the events
+ */
+std::vector<EventDataFrame>
+SyntheticFileReader::getEventData(const hsize_t frameNumber) {
+  if (frameNumber >= m_numberOfFrames) {
+    return {};
+  }
+  std::vector<EventDataFrame> eventData;
+  eventData.push_back(m_eventGenerator.generate(m_numberOfPulsesGenerated++,
+                                                getNumberOfEventsInPulse()));
+  return eventData;
+}
+
+/// There is no histogram data in a synthetic run
+std::vector<HistogramFrame> SyntheticFileReader::getHistoData() { return {}; }
+
+/// @return - mean number of events, as the number is decided when the events
+/// are generated
+hsize_t SyntheticFileReader::getNumberOfEventsInFrame(hsize_t, size_t) {
+  return m_meanEventsPerPulse;
+}
+
+uint64_t SyntheticFileReader::getFrameTime(const hsize_t frameNumber) {
+  return m_runStart + static_cast<uint64_t>(
+                          static_cast<double>(frameNumber) * m_pulsePeriodNs);
+}
+
+uint64_t SyntheticFileReader::getRelativeFrameTimeMilliseconds(
+    const hsize_t frameNumber) {
+  return static_cast<uint64_t>(static_cast<double>(frameNumber) *
+                               m_pulsePeriodNs / 1e6);
+}
+
+uint32_t SyntheticFileReader::getRunDurationMs() {
+  const auto durationMs =
+      static_cast<double>(m_numberOfFrames) * m_pulsePeriodNs / 1e6;
+  return durationMs >= std::numeric_limits<uint32_t>::max()
+             ? std::numeric_limits<uint32_t>::max()
+             : static_cast<uint32_t>(durationMs);
+}
+
+uint32_t SyntheticFileReader::getNumberOfEventsInPulse() {
+  if (!m_poissonEventCounts || m_meanEventsPerPulse == 0) {
+    return m_meanEventsPerPulse;
+  }
+  return m_eventCountDist(RandomEngine);
+}
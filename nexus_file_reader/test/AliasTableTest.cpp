@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "../include/AliasTable.h"
+
+namespace {
+/// Sample on an even grid of random numbers and count each index
+std::vector<size_t> countSamples(const AliasTable &table,
+                                 const size_t numberOfSamples) {
+  std::vector<size_t> counts(table.size(), 0);
+  const auto step = std::numeric_limits<uint32_t>::max() / numberOfSamples;
+  for (size_t i = 0; i < numberOfSamples; ++i) {
+    const auto random = static_cast<uint32_t>(i * step);
+    // Choose the acceptance independently of the column
+    const auto acceptRandom = static_cast<uint32_t>(random * 2654435761u);
+    ++counts[table.sample(random, acceptRandom)];
+  }
+  return counts;
+}
+} // namespace
+
+TEST(AliasTableTest, error_thrown_for_no_weights) {
+  EXPECT_THROW(AliasTable({}), std::runtime_error);
+}
+
+TEST(AliasTableTest, error_thrown_for_zero_or_negative_weights) {
+  EXPECT_THROW(AliasTable({0, 0}), std::runtime_error);
+  EXPECT_THROW(AliasTable({1, -1}), std::runtime_error);
+}
+
+TEST(AliasTableTest, single_weight_always_gives_its_index) {
+  AliasTable table({5});
+  EXPECT_EQ(0, table.sample(0, 0));
+  EXPECT_EQ(0, table.sample(std::numeric_limits<uint32_t>::max(),
+                            std::numeric_limits<uint32_t>::max()));
+}
+
+TEST(AliasTableTest, zero_weights_are_never_sampled) {
+  AliasTable table({0, 3, 0, 1});
+  auto counts = countSamples(table, 100000);
+  EXPECT_EQ(0, counts[0]);
+  EXPECT_EQ(0, counts[2]);
+  EXPECT_NEAR(75000, counts[1], 1000);
+  EXPECT_NEAR(25000, counts[3], 1000);
+}
+
+TEST(AliasTableTest, indices_are_sampled_in_proportion_to_weights) {
+  const std::vector<double> weights = {1, 2, 3, 4, 10};
+  AliasTable table(weights);
+  auto counts = countSamples(table, 200000);
+  for (size_t i = 0; i < weights.size(); ++i) {
+    EXPECT_NEAR(weights[i] * 10000, counts[i], 1000);
+  }
+}
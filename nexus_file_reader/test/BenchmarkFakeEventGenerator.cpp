@@ -0,0 +1,31 @@
+#include <numeric>
+
+#include "FakeEventGenerator.h"
+#include "benchmark/benchmark.h"
+
+void GenerateFakeEvents(benchmark::State &state) {
+  std::vector<int32_t> detectorNumbers(1000000);
+  std::iota(detectorNumbers.begin(), detectorNumbers.end(), 1);
+  FakeEventGenerator generator(detectorNumbers, 0,
+                               static_cast<uint32_t>(state.range(1)));
+  const auto numberOfEvents = static_cast<size_t>(state.range(0));
+  std::vector<uint32_t> detectorIDs(numberOfEvents);
+  std::vector<uint32_t> timeOfFlights(numberOfEvents);
+
+  uint64_t streamNumber = 0;
+  while (state.KeepRunning()) {
+    generator.generate(streamNumber++, detectorIDs.data(),
+                       timeOfFlights.data(), numberOfEvents);
+    benchmark::DoNotOptimize(detectorIDs.data());
+    benchmark::DoNotOptimize(timeOfFlights.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Events per pulse and number of threads, 0 means all hardware threads
+BENCHMARK(GenerateFakeEvents)
+    ->Args({1000, 1})
+    ->Args({10000000, 1})
+    ->Args({10000000, 0});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,65 @@
+#include <gmock/gmock.h>
+
+#include "../../core/include/HistogramFrame.h"
+#include "../include/EventDistribution.h"
+
+TEST(EventDistributionTest, error_thrown_for_mismatched_bin_edges) {
+  EXPECT_THROW(EventDistribution({1}, {1}, {0, 1000}, {1, 1}),
+               std::runtime_error);
+}
+
+TEST(EventDistributionTest, sampled_events_are_in_the_distributions) {
+  EventDistribution distribution({7, 9}, {0, 1}, {0, 1000, 2000}, {1, 0});
+  uint32_t detectorID;
+  uint32_t timeOfFlight;
+  for (uint64_t random = 0; random < 1000; ++random) {
+    const auto scaledRandom = random * 0x9e3779b97f4a7c15ULL;
+    distribution.sample(scaledRandom, ~scaledRandom, detectorID,
+                        timeOfFlight);
+    EXPECT_EQ(9, detectorID);
+    EXPECT_LT(timeOfFlight, 1000u);
+  }
+}
+
+TEST(EventDistributionTest, builder_counts_detectors_and_times_of_flight) {
+  EventDistributionBuilder builder;
+  builder.addEvents({5, 3, 5}, {500, 2500, 2700});
+  builder.addEvents({5}, {2999});
+  EXPECT_EQ(4, builder.getNumberOfEvents());
+
+  auto distribution = builder.build();
+  EXPECT_THAT(distribution.getDetectorIDs(), ::testing::ElementsAre(3, 5));
+  EXPECT_THAT(distribution.getTimeOfFlightBinEdges(),
+              ::testing::ElementsAre(0, 1000, 2000, 3000));
+}
+
+TEST(EventDistributionTest, error_thrown_if_builder_has_no_events) {
+  EventDistributionBuilder builder;
+  EXPECT_THROW(builder.build(), std::runtime_error);
+}
+
+TEST(EventDistributionTest, histogram_spectra_are_used_as_detector_ids) {
+  // Two spectra with three time of flight bins each, edges in microseconds
+  HistogramFrame histogram({1, 2, 3, 0, 0, 0}, {2, 3}, {0, 10, 20, 30},
+                           {4, 8});
+  auto distribution = EventDistribution::fromHistograms({histogram}, nullptr);
+  EXPECT_THAT(distribution.getDetectorIDs(), ::testing::ElementsAre(4, 8));
+  EXPECT_THAT(distribution.getTimeOfFlightBinEdges(),
+              ::testing::ElementsAre(0, 10000, 20000, 30000));
+
+  uint32_t detectorID;
+  uint32_t timeOfFlight;
+  for (uint64_t random = 0; random < 1000; ++random) {
+    const auto scaledRandom = random * 0x9e3779b97f4a7c15ULL;
+    distribution.sample(scaledRandom, ~scaledRandom, detectorID,
+                        timeOfFlight);
+    // Spectrum 8 has no counts
+    EXPECT_EQ(4, detectorID);
+    EXPECT_LT(timeOfFlight, 30000u);
+  }
+}
+
+TEST(EventDistributionTest, error_thrown_if_no_histogram_data) {
+  EXPECT_THROW(EventDistribution::fromHistograms({}, nullptr),
+               std::runtime_error);
+}
@@ -0,0 +1,118 @@
+#include <gmock/gmock.h>
+#include <numeric>
+
+#include "../include/FakeEventGenerator.h"
+
+namespace {
+std::vector<int32_t> createDetectorRange(const int32_t first,
+                                         const size_t numberOfDetectors) {
+  std::vector<int32_t> detectorNumbers(numberOfDetectors);
+  std::iota(detectorNumbers.begin(), detectorNumbers.end(), first);
+  return detectorNumbers;
+}
+} // namespace
+
+TEST(FakeEventGeneratorTest, error_thrown_if_no_detector_numbers_given) {
+  EXPECT_THROW(FakeEventGenerator(std::vector<int32_t>(), 0),
+               std::runtime_error);
+}
+
+TEST(FakeEventGeneratorTest, generates_requested_number_of_events) {
+  FakeEventGenerator generator(createDetectorRange(1, 10), 0);
+  auto events = generator.generate(0, 1234);
+  EXPECT_EQ(1234, events.detectorIDs.size());
+  EXPECT_EQ(1234, events.timeOfFlights.size());
+  EXPECT_TRUE(generator.generate(0, 0).detectorIDs.empty());
+}
+
+TEST(FakeEventGeneratorTest, events_are_within_detector_and_tof_ranges) {
+  FakeEventGenerator generator(createDetectorRange(100, 50), 0);
+  auto events = generator.generate(0, 10000);
+  for (size_t i = 0; i < events.detectorIDs.size(); ++i) {
+    EXPECT_GE(events.detectorIDs[i], 100u);
+    EXPECT_LT(events.detectorIDs[i], 150u);
+    EXPECT_GE(events.timeOfFlights[i], FakeEventGenerator::minTimeOfFlight);
+    EXPECT_LE(events.timeOfFlights[i], FakeEventGenerator::maxTimeOfFlight);
+  }
+}
+
+TEST(FakeEventGeneratorTest, every_detector_is_used) {
+  FakeEventGenerator generator(createDetectorRange(0, 16), 0);
+  auto events = generator.generate(0, 10000);
+  std::vector<size_t> counts(16, 0);
+  for (const auto detectorID : events.detectorIDs) {
+    ++counts[detectorID];
+  }
+  for (const auto count : counts) {
+    // Expect 625 events per detector
+    EXPECT_NEAR(625, count, 125);
+  }
+}
+
+TEST(FakeEventGeneratorTest, non_contiguous_detector_numbers_are_looked_up) {
+  const std::vector<int32_t> detectorNumbers = {7, 3, 42, 1000};
+  FakeEventGenerator generator(detectorNumbers, 0);
+  auto events = generator.generate(0, 1000);
+  for (const auto detectorID : events.detectorIDs) {
+    EXPECT_THAT(detectorNumbers,
+                ::testing::Contains(static_cast<int32_t>(detectorID)));
+  }
+}
+
+TEST(FakeEventGeneratorTest, same_seed_and_stream_give_same_events) {
+  FakeEventGenerator generator(createDetectorRange(0, 1000), 42);
+  FakeEventGenerator otherGenerator(createDetectorRange(0, 1000), 42);
+  auto events = generator.generate(3, 1000);
+  auto otherEvents = otherGenerator.generate(3, 1000);
+  EXPECT_EQ(events.detectorIDs, otherEvents.detectorIDs);
+  EXPECT_EQ(events.timeOfFlights, otherEvents.timeOfFlights);
+}
+
+TEST(FakeEventGeneratorTest, different_streams_or_seeds_give_different_events) {
+  FakeEventGenerator generator(createDetectorRange(0, 1000), 42);
+  FakeEventGenerator otherSeedGenerator(createDetectorRange(0, 1000), 43);
+  auto events = generator.generate(3, 1000);
+  EXPECT_NE(events.timeOfFlights, generator.generate(4, 1000).timeOfFlights);
+  EXPECT_NE(events.timeOfFlights,
+            otherSeedGenerator.generate(3, 1000).timeOfFlights);
+}
+
+TEST(FakeEventGeneratorTest, events_do_not_depend_on_number_of_threads) {
+  const size_t numberOfEvents = 1 << 20;
+  FakeEventGenerator singleThreadGenerator(createDetectorRange(0, 1000), 7, 1);
+  FakeEventGenerator multiThreadGenerator(createDetectorRange(0, 1000), 7, 4);
+  auto events = singleThreadGenerator.generate(0, numberOfEvents);
+  auto otherEvents = multiThreadGenerator.generate(0, numberOfEvents);
+  EXPECT_EQ(events.detectorIDs, otherEvents.detectorIDs);
+  EXPECT_EQ(events.timeOfFlights, otherEvents.timeOfFlights);
+}
+
+TEST(FakeEventGeneratorTest, events_are_sampled_from_given_distribution) {
+  auto distribution = std::make_shared<const EventDistribution>(
+      std::vector<uint32_t>{10, 20, 30}, std::vector<double>{1, 0, 1},
+      std::vector<uint32_t>{5000, 6000}, std::vector<double>{1});
+  FakeEventGenerator generator(distribution, 0);
+  auto events = generator.generate(0, 10000);
+  size_t eventsInDetector10 = 0;
+  for (size_t i = 0; i < events.detectorIDs.size(); ++i) {
+    EXPECT_NE(20u, events.detectorIDs[i]);
+    eventsInDetector10 += events.detectorIDs[i] == 10 ? 1 : 0;
+    EXPECT_GE(events.timeOfFlights[i], 5000u);
+    EXPECT_LT(events.timeOfFlights[i], 6000u);
+  }
+  EXPECT_NEAR(5000, eventsInDetector10, 300);
+}
+
+TEST(FakeEventGeneratorTest,
+     sampled_events_do_not_depend_on_number_of_threads) {
+  auto distribution = std::make_shared<const EventDistribution>(
+      std::vector<uint32_t>{10, 20, 30}, std::vector<double>{1, 2, 3},
+      std::vector<uint32_t>{0, 1000, 5000}, std::vector<double>{3, 1});
+  const size_t numberOfEvents = 1 << 20;
+  FakeEventGenerator singleThreadGenerator(distribution, 7, 1);
+  FakeEventGenerator multiThreadGenerator(distribution, 7, 4);
+  auto events = singleThreadGenerator.generate(0, numberOfEvents);
+  auto otherEvents = multiThreadGenerator.generate(0, numberOfEvents);
+  EXPECT_EQ(events.detectorIDs, otherEvents.detectorIDs);
+  EXPECT_EQ(events.timeOfFlights, otherEvents.timeOfFlights);
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "../include/FrameMerger.h"
+
+class FrameMergerTest : public ::testing::Test {};
+
+TEST(FrameMergerTest, frames_are_merged_in_pulse_time_order) {
+  FrameMerger merger({{0, 200, 400}, {100, 200, 300}});
+
+  const std::vector<uint64_t> expectedPulseTimes{0, 100, 200, 300, 400};
+  EXPECT_EQ(expectedPulseTimes, merger.getPulseTimes());
+  EXPECT_EQ(3u, merger.getNumberOfFramesInGroup(1));
+
+  auto groupFrames = merger.getGroupFrames(1);
+  ASSERT_EQ(1u, groupFrames.size());
+  EXPECT_EQ(1u, groupFrames[0].eventGroupNumber);
+  EXPECT_EQ(0u, groupFrames[0].frameNumber);
+}
+
+TEST(FrameMergerTest, frames_with_the_same_pulse_time_are_merged) {
+  FrameMerger merger({{0, 200, 400}, {100, 200, 300}});
+
+  auto groupFrames = merger.getGroupFrames(2);
+  ASSERT_EQ(2u, groupFrames.size());
+  EXPECT_EQ(0u, groupFrames[0].eventGroupNumber);
+  EXPECT_EQ(1u, groupFrames[0].frameNumber);
+  EXPECT_EQ(1u, groupFrames[1].eventGroupNumber);
+  EXPECT_EQ(1u, groupFrames[1].frameNumber);
+}
+
+TEST(FrameMergerTest, group_frames_are_counted_once_each) {
+  FrameMerger merger({{0, 200, 400}, {100, 200, 300}});
+  EXPECT_EQ(5u, merger.getNumberOfFrames());
+  EXPECT_EQ(6u, merger.getNumberOfGroupFrames());
+}
+
+TEST(FrameMergerTest, groups_with_no_frames_are_ignored) {
+  FrameMerger merger({{}, {50, 60}});
+  EXPECT_EQ(2u, merger.getNumberOfFrames());
+  EXPECT_EQ(0u, merger.getNumberOfFramesInGroup(0));
+  EXPECT_EQ(1u, merger.getGroupFrames(1)[0].eventGroupNumber);
+}
+
+TEST(FrameMergerTest, default_merger_is_empty) {
+  FrameMerger merger;
+  EXPECT_TRUE(merger.empty());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "../include/LogFilter.h"
+
+class LogFilterTest : public ::testing::Test {};
+
+TEST(LogFilterTest, patterns_match_with_wildcards) {
+  EXPECT_TRUE(LogFilter::matchesPattern("TEMP_1", "TEMP*"));
+  EXPECT_TRUE(LogFilter::matchesPattern("TEMP_1", "TEMP_?"));
+  EXPECT_TRUE(LogFilter::matchesPattern("TEMP_1", "*"));
+  EXPECT_TRUE(LogFilter::matchesPattern("s1_slit_gap", "*slit*"));
+  EXPECT_FALSE(LogFilter::matchesPattern("TEMP_12", "TEMP_?"));
+  EXPECT_FALSE(LogFilter::matchesPattern("SAMPLE_TEMP", "TEMP*"));
+}
+
+TEST(LogFilterTest, filter_spec_is_parsed) {
+  auto settings = LogFilter::parseFilterSpec(
+      "TEMP*:deadband=0.5,rel-deadband=0.01,min-interval=2,every=3");
+  EXPECT_EQ("TEMP*", settings.namePattern);
+  EXPECT_DOUBLE_EQ(0.5, settings.deadBand);
+  EXPECT_DOUBLE_EQ(0.01, settings.relativeDeadBand);
+  EXPECT_FLOAT_EQ(2.0f, settings.minIntervalSeconds);
+  EXPECT_EQ(3u, settings.decimation);
+}
+
+TEST(LogFilterTest, invalid_filter_spec_throws) {
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*"), std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:deadband"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:deadband=abc"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:colour=red"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:every=0"),
+               std::runtime_error);
+}
+
+TEST(LogFilterTest, values_with_trailing_characters_throw) {
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:deadband=0.5K"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:min-interval=2s"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:every=3x"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:every=1.5"),
+               std::runtime_error);
+}
+
+TEST(LogFilterTest, out_of_range_thresholds_throw) {
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:deadband=-0.5"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:rel-deadband=-0.01"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:min-interval=-1"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:every=-1"),
+               std::runtime_error);
+  EXPECT_THROW(LogFilter::parseFilterSpec("TEMP*:every=4294967296"),
+               std::runtime_error);
+}
+
+TEST(LogFilterTest, all_samples_are_selected_if_no_filter_matches) {
+  LogFilter filter({"TEMP*:every=2"});
+  const std::vector<uint32_t> expectedIndices{0, 1, 2};
+  EXPECT_EQ(expectedIndices,
+            filter.selectSamples("PRESSURE", {0.1f, 0.2f, 0.3f},
+                                 std::vector<double>{1.0, 2.0, 3.0}, 3));
+}
+
+TEST(LogFilterTest, dead_band_drops_small_changes) {
+  LogFilter filter({"TEMP*:deadband=0.5"});
+  const std::vector<uint32_t> expectedIndices{0, 3, 4};
+  EXPECT_EQ(expectedIndices,
+            filter.selectSamples(
+                "TEMP_1", {0.1f, 0.2f, 0.3f, 0.4f, 0.5f},
+                std::vector<double>{10.0, 10.0, 10.4, 11.0, 10.0}, 5));
+}
+
+TEST(LogFilterTest, relative_dead_band_drops_small_changes) {
+  LogFilter filter({"*:rel-deadband=0.1"});
+  const std::vector<uint32_t> expectedIndices{0, 2};
+  EXPECT_EQ(expectedIndices,
+            filter.selectSamples("MOTOR", {0.1f, 0.2f, 0.3f},
+                                 std::vector<int32_t>{100, 105, 120}, 3));
+}
+
+TEST(LogFilterTest, min_interval_drops_samples_too_close_in_time) {
+  LogFilter filter({"*:min-interval=1"});
+  const std::vector<uint32_t> expectedIndices{0, 2, 4};
+  EXPECT_EQ(expectedIndices,
+            filter.selectSamples("TEMP_1", {0.0f, 0.5f, 1.0f, 1.5f, 2.5f},
+                                 std::vector<double>{1.0, 2.0, 3.0, 4.0, 5.0},
+                                 5));
+}
+
+TEST(LogFilterTest, decimation_keeps_every_nth_sample) {
+  LogFilter filter({"*:every=3"});
+  const std::vector<uint32_t> expectedIndices{0, 3, 6};
+  EXPECT_EQ(expectedIndices,
+            filter.selectSamples("TEMP_1", std::vector<float>(8, 1.0f),
+                                 std::vector<uint64_t>(8, 1), 8));
+}
+
+TEST(LogFilterTest, first_matching_filter_is_used) {
+  LogFilter filter({"TEMP_1:every=2", "TEMP*:every=4"});
+  const std::vector<uint32_t> expectedIndices{0, 2, 4};
+  EXPECT_EQ(expectedIndices,
+            filter.selectSamples("TEMP_1", std::vector<float>(5, 1.0f),
+                                 std::vector<int64_t>(5, 1), 5));
+}
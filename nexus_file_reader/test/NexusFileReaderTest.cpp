@@ -33,6 +33,22 @@ AllElementsInVectorAreNear(const std::vector<float> &a,
 }
 
 const auto testOptArgs = OptionalArgs();
+
+/// Add two event data groups with differing event_time_zero datasets, they
+/// share a frame at pulse time 2
+void addEventGroupsWithInconsistentPulseData(hdf5::file::File &file) {
+  HDF5FileTestHelpers::addNXentryToFile(file, "entry");
+  HDF5FileTestHelpers::addNXeventDataToFile(file, "entry", "detector_1_events");
+  const std::vector<int64_t> det_1_event_time_zero{0, 2};
+  HDF5FileTestHelpers::addNXeventDataDatasetsToFile(
+      file, det_1_event_time_zero, {2, 3}, {0, 1}, {4, 5}, "entry",
+      "detector_1_events");
+  HDF5FileTestHelpers::addNXeventDataToFile(file, "entry", "detector_2_events");
+  const std::vector<int64_t> det_2_event_time_zero{1, 2};
+  HDF5FileTestHelpers::addNXeventDataDatasetsToFile(
+      file, det_2_event_time_zero, {6, 7}, {0, 1}, {8, 9}, "entry",
+      "detector_2_events");
+}
 } // namespace
 
 TEST(NexusFileReaderTest, error_thrown_for_non_existent_file) {
@@ -76,13 +92,14 @@ TEST(NexusFileReaderTest,
   EXPECT_NO_THROW(NexusFileReader(file, 0, 0, {0}, testOptArgs));
 }
 
-TEST(NexusFileReaderTest, expect_empty_map_if_no_selog_group_present) {
+TEST(NexusFileReaderTest, expect_no_logs_if_no_selog_group_present) {
   auto file =
       createInMemoryTestFileWithEventData("fileWithRequisiteGroups.nxs");
 
   auto fileReader = NexusFileReader(file, 0, 0, {0}, testOptArgs);
-  auto sEMap = fileReader.getSEEventMap();
-  EXPECT_EQ(sEMap.size(), 0);
+  auto sELogs = fileReader.getSampleEnvLogs();
+  EXPECT_EQ(sELogs.getNumberOfLogs(), 0);
+  EXPECT_TRUE(sELogs.empty());
 }
 
 TEST(NexusFileReaderTest, nexus_uncompressed_file_open_exists) {
@@ -159,6 +176,23 @@ TEST(NexusFileReaderTest,
   EXPECT_EQ(numberOfFakeEventsPerPulse, eventData[0].detectorIDs.size());
 }
 
+TEST(NexusFileReaderTest, fake_events_can_be_sampled_from_event_data) {
+  auto settings = OptionalArgs();
+  settings.fakeEventSampling = "events";
+  const int32_t numberOfFakeEventsPerPulse = 1000;
+  auto fileReader =
+      NexusFileReader(hdf5::file::open(testDataPath + "SANS_test.nxs"), 0,
+                      numberOfFakeEventsPerPulse, {}, settings);
+  auto eventData = fileReader.getEventData(0);
+  ASSERT_FALSE(eventData.empty());
+  EXPECT_EQ(numberOfFakeEventsPerPulse, eventData[0].detectorIDs.size());
+  // Times of flight in the file are milliseconds, far longer than uniform
+  // fake events
+  EXPECT_GT(*std::max_element(eventData[0].timeOfFlights.cbegin(),
+                              eventData[0].timeOfFlights.cend()),
+            FakeEventGenerator::maxTimeOfFlight);
+}
+
 TEST(NexusFileReaderTest, get_eventData_too_high_frame_number) {
   auto fileReader = NexusFileReader(
       hdf5::file::open(testDataPath + "SANS_test.nxs"), 0, 0, {0}, testOptArgs);
@@ -262,15 +296,18 @@ TEST(NexusFileReaderTest, get_instrument_name) {
   EXPECT_EQ("SANS2D", fileReader.getInstrumentName());
 }
 
-TEST(NexusFileReaderTest, get_sEEvent_map) {
+TEST(NexusFileReaderTest, get_sample_env_logs) {
   auto fileReader = NexusFileReader(
       hdf5::file::open(testDataPath + "SANS_test.nxs"), 0, 0, {0}, testOptArgs);
-  auto eventMap = fileReader.getSEEventMap();
-  auto eventVector = eventMap[10];
-  EXPECT_EQ(57, eventVector.size());
-  EXPECT_EQ("Det_Temp_FLB", eventVector[0]->getName());
-  EXPECT_EQ("Det_Temp_FRT", eventVector[3]->getName());
-  EXPECT_EQ(1000000000, eventVector[3]->getTimestamp());
+  auto sELogs = fileReader.getSampleEnvLogs();
+  auto samples = sELogs.getSamplesInFrame(10);
+  ASSERT_EQ(57, samples.size());
+  auto getName = [&sELogs](const SampleEnvironmentSample &sample) {
+    return sELogs.getName(sELogs.getLog(sample.logIndex).nameID);
+  };
+  EXPECT_EQ("Det_Temp_FLB", getName(samples.begin()[0]));
+  EXPECT_EQ("Det_Temp_FRT", getName(samples.begin()[3]));
+  EXPECT_EQ(1000000000, sELogs.getTimestamp(samples.begin()[3]));
 }
 
 TEST(NexusFileReaderTest, get_number_of_periods) {
@@ -358,31 +395,81 @@ TEST(
 }
 
 TEST(NexusFileReaderTest,
-     only_one_event_group_published_if_groups_have_inconsistent_pulse_data) {
-  // Dealing with inconsistent pulse data between NXevent_data is complex and
-  // may not be required, so it is not implemented
-  // A warning log should be generated and the reader should proceed with
-  // publishing data from one of the groups
-
+     frames_are_merged_if_groups_have_inconsistent_pulse_data) {
   auto file = createInMemoryTestFile("fileWithInconsistentPulseData");
+  addEventGroupsWithInconsistentPulseData(file);
+
+  auto fileReader = NexusFileReader(file, 0, 0, {0}, testOptArgs);
+  ASSERT_EQ(fileReader.getNumberOfFrames(), 3)
+      << "Expected one frame for each distinct pulse time in the groups";
+  EXPECT_EQ(fileReader.getFrameTime(1), 1000000000);
+
+  auto firstFrame = fileReader.getEventData(0);
+  ASSERT_EQ(firstFrame.size(), 1);
+  EXPECT_EQ(firstFrame[0].detectorIDs, std::vector<uint32_t>{4});
+
+  auto secondFrame = fileReader.getEventData(1);
+  ASSERT_EQ(secondFrame.size(), 1);
+  EXPECT_EQ(secondFrame[0].detectorIDs, std::vector<uint32_t>{8});
+
+  auto lastFrame = fileReader.getEventData(2);
+  ASSERT_EQ(lastFrame.size(), 2)
+      << "Expected events from both groups as they both have a frame with "
+         "this pulse time";
+  EXPECT_EQ(lastFrame[0].detectorIDs, std::vector<uint32_t>{5});
+  EXPECT_EQ(lastFrame[1].detectorIDs, std::vector<uint32_t>{9});
+}
+
+TEST(NexusFileReaderTest,
+     fake_event_count_only_includes_groups_present_in_each_merged_frame) {
+  auto file = createInMemoryTestFile("fakeEventsWithInconsistentPulseData");
+  addEventGroupsWithInconsistentPulseData(file);
+
+  const int32_t fakeEventsPerPulse = 2;
+  auto fileReader =
+      NexusFileReader(file, 0, fakeEventsPerPulse, {0}, testOptArgs);
+  ASSERT_EQ(fileReader.getNumberOfFrames(), 3);
+  // Only the last merged frame has a frame from both groups
+  EXPECT_EQ(fileReader.getTotalEventCount(), 4 * fakeEventsPerPulse);
+}
+
+TEST(NexusFileReaderTest, merged_frames_are_read_beyond_the_prefetched_frames) {
+  auto file = createInMemoryTestFile("fileWithManyMergedFrames");
   HDF5FileTestHelpers::addNXentryToFile(file, "entry");
 
-  // Add two event data groups with differing event_time_zero datasets
+  // Enough frames in the first group that they cannot all be read ahead at
+  // once, and one frame in the second group after all of them
+  const size_t numberOfFrames = 1000;
+  std::vector<int64_t> eventTimeZero;
+  std::vector<int32_t> eventTimeOffset;
+  std::vector<uint64_t> eventIndex;
+  std::vector<uint32_t> eventId;
+  for (size_t frame = 0; frame < numberOfFrames; ++frame) {
+    eventTimeZero.push_back(static_cast<int64_t>(frame));
+    eventTimeOffset.push_back(static_cast<int32_t>(frame));
+    eventIndex.push_back(frame);
+    eventId.push_back(static_cast<uint32_t>(frame));
+  }
   HDF5FileTestHelpers::addNXeventDataToFile(file, "entry", "detector_1_events");
-  const std::vector<int64_t> det_1_event_time_zero{0};
   HDF5FileTestHelpers::addNXeventDataDatasetsToFile(
-      file, det_1_event_time_zero, {2}, {0}, {4}, "entry", "detector_1_events");
+      file, eventTimeZero, eventTimeOffset, eventIndex, eventId, "entry",
+      "detector_1_events");
   HDF5FileTestHelpers::addNXeventDataToFile(file, "entry", "detector_2_events");
-  const std::vector<int64_t> det_2_event_time_zero{1};
   HDF5FileTestHelpers::addNXeventDataDatasetsToFile(
-      file, det_2_event_time_zero, {2}, {0}, {4}, "entry", "detector_2_events");
+      file, {static_cast<int64_t>(numberOfFrames)}, {7}, {0}, {8}, "entry",
+      "detector_2_events");
 
   auto fileReader = NexusFileReader(file, 0, 0, {0}, testOptArgs);
-  auto eventData = fileReader.getEventData(0);
-  ASSERT_EQ(eventData.size(), 1)
-      << "Expected an event message from only one event data group as the "
-         "multiple groups have inconsistent pulse times, which is not yet "
-         "supported";
+  ASSERT_EQ(fileReader.getNumberOfFrames(), numberOfFrames + 1);
+  for (size_t frame = 0; frame < numberOfFrames; ++frame) {
+    auto eventData = fileReader.getEventData(frame);
+    ASSERT_EQ(eventData.size(), 1);
+    EXPECT_EQ(eventData[0].detectorIDs,
+              std::vector<uint32_t>{static_cast<uint32_t>(frame)});
+  }
+  auto lastFrame = fileReader.getEventData(numberOfFrames);
+  ASSERT_EQ(lastFrame.size(), 1);
+  EXPECT_EQ(lastFrame[0].detectorIDs, std::vector<uint32_t>{8});
 }
 
 TEST(NexusFileReaderTest, successfully_read_isis_histogram_data) {
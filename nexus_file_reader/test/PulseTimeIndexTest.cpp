@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "../include/PulseTimeIndex.h"
+
+class PulseTimeIndexTest : public ::testing::Test {};
+
+TEST(PulseTimeIndexTest, time_is_assigned_to_frame_whose_pulse_precedes_it) {
+  // 14 Hz source
+  PulseTimeIndex index({0, 71428571, 142857142, 214285714});
+  EXPECT_EQ(0, index.findFrameNumber(50000000));
+  EXPECT_EQ(1, index.findFrameNumber(71428571));
+  EXPECT_EQ(1, index.findFrameNumber(100000000));
+  EXPECT_EQ(3, index.findFrameNumber(250000000));
+}
+
+TEST(PulseTimeIndexTest, time_before_first_pulse_is_assigned_to_first_frame) {
+  PulseTimeIndex index({100, 200, 300});
+  EXPECT_EQ(0, index.findFrameNumber(50));
+}
+
+TEST(PulseTimeIndexTest, time_after_end_of_last_frame_has_no_frame) {
+  PulseTimeIndex index({100, 200, 300});
+  EXPECT_EQ(2, index.findFrameNumber(399));
+  EXPECT_EQ(PulseTimeIndex::noFrame, index.findFrameNumber(400));
+}
+
+TEST(PulseTimeIndexTest, empty_index_gives_no_frame) {
+  PulseTimeIndex index;
+  EXPECT_EQ(PulseTimeIndex::noFrame, index.findFrameNumber(0));
+  EXPECT_EQ(PulseTimeIndex::noFrame, index.findFrameNumbers({0.5f})[0]);
+}
+
+TEST(PulseTimeIndexTest, sorted_and_unsorted_times_give_the_same_frames) {
+  // 50 Hz source
+  PulseTimeIndex index({0, 20000000, 40000000, 60000000, 80000000});
+  const std::vector<float> sortedTimes{-1.0f, 0.0f,  0.001f, 0.021f,
+                                       0.045f, 0.07f, 0.099f, 0.5f};
+  const std::vector<size_t> expectedFrames{
+      PulseTimeIndex::noFrame, PulseTimeIndex::noFrame, 0, 1, 2, 3, 4,
+      PulseTimeIndex::noFrame};
+  EXPECT_EQ(expectedFrames, index.findFrameNumbers(sortedTimes));
+
+  const std::vector<float> unsortedTimes(sortedTimes.rbegin(),
+                                         sortedTimes.rend());
+  const std::vector<size_t> expectedUnsortedFrames(expectedFrames.rbegin(),
+                                                   expectedFrames.rend());
+  EXPECT_EQ(expectedUnsortedFrames, index.findFrameNumbers(unsortedTimes));
+}
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include "../include/SidecarIndex.h"
+
+class SidecarIndexTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::ofstream nexusFile(m_nexusFilename, std::ios::binary);
+    nexusFile << "not really a NeXus file";
+  }
+
+  void TearDown() override {
+    std::remove(m_nexusFilename.c_str());
+    std::remove(SidecarIndex::getIndexFilename(m_nexusFilename).c_str());
+  }
+
+  static SidecarIndexContents createContents() {
+    SidecarIndexContents contents;
+    contents.eventGroupPaths = {"/entry/detector_1_events",
+                                "/entry/monitor_1_events"};
+    contents.logGroupPaths = {"/entry/sample/temperature"};
+    contents.pulseTimesNs = {0, 100000000, 200000000};
+    contents.frameOffsets = {{0, 10, 25}, {0, 1, 2}};
+    return contents;
+  }
+
+  void setModifiedTime(time_t seconds, long nanoseconds) {
+    const struct timespec times[2] = {{seconds, nanoseconds},
+                                      {seconds, nanoseconds}};
+    ASSERT_EQ(0, utimensat(AT_FDCWD, m_nexusFilename.c_str(), times, 0));
+  }
+
+  const std::string m_nexusFilename = "sidecar_index_test.nxs";
+};
+
+TEST_F(SidecarIndexTest, index_is_not_loaded_if_it_does_not_exist) {
+  SidecarIndex index;
+  EXPECT_FALSE(index.load(m_nexusFilename));
+  EXPECT_FALSE(index.isLoaded());
+}
+
+TEST_F(SidecarIndexTest, written_index_is_loaded) {
+  const auto contents = createContents();
+  SidecarIndex::write(m_nexusFilename, contents);
+
+  SidecarIndex index;
+  ASSERT_TRUE(index.load(m_nexusFilename));
+  EXPECT_EQ(contents.eventGroupPaths, index.getEventGroupPaths());
+  EXPECT_EQ(contents.logGroupPaths, index.getLogGroupPaths());
+  EXPECT_EQ(contents.pulseTimesNs, index.getPulseTimes());
+  EXPECT_EQ(25u, index.getFrameOffset(0, 2));
+  EXPECT_EQ(1u, index.getFrameOffset(1, 1));
+
+  // Index remains usable after being moved
+  auto movedIndex = std::move(index);
+  EXPECT_TRUE(movedIndex.isLoaded());
+  EXPECT_EQ(10u, movedIndex.getFrameOffset(0, 1));
+}
+
+TEST_F(SidecarIndexTest, index_is_not_loaded_if_nexus_file_has_changed) {
+  SidecarIndex::write(m_nexusFilename, createContents());
+  {
+    std::ofstream nexusFile(m_nexusFilename,
+                            std::ios::binary | std::ios::app);
+    nexusFile << "more data";
+  }
+
+  SidecarIndex index;
+  EXPECT_FALSE(index.load(m_nexusFilename));
+}
+
+TEST_F(SidecarIndexTest,
+       index_is_not_loaded_if_nexus_file_changes_within_the_same_second) {
+  setModifiedTime(1600000000, 0);
+  SidecarIndex::write(m_nexusFilename, createContents());
+  setModifiedTime(1600000000, 500);
+
+  SidecarIndex index;
+  EXPECT_FALSE(index.load(m_nexusFilename));
+}
+
+TEST_F(SidecarIndexTest, inconsistent_frame_offsets_are_not_written) {
+  auto contents = createContents();
+  contents.frameOffsets[1].pop_back();
+  EXPECT_THROW(SidecarIndex::write(m_nexusFilename, contents),
+               std::runtime_error);
+}
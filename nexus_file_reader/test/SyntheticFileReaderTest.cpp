@@ -0,0 +1,104 @@
+#include <gmock/gmock.h>
+#include <limits>
+
+#include "../../core/include/EventDataFrame.h"
+#include "../../core/include/OptionalArgs.h"
+#include "../include/SyntheticFileReader.h"
+
+namespace {
+OptionalArgs createSettings(const double pulseRateHz,
+                            const uint32_t runDurationS,
+                            const std::string &distribution) {
+  OptionalArgs settings;
+  settings.fakeEventsPerPulse = 100;
+  settings.syntheticPulseRateHz = pulseRateHz;
+  settings.syntheticRunDurationS = runDurationS;
+  settings.syntheticEventDistribution = distribution;
+  settings.instrumentName = "SYNTH";
+  return settings;
+}
+
+const std::vector<int32_t> testDetectorNumbers = {3, 4, 5, 6};
+} // namespace
+
+TEST(SyntheticFileReaderTest, error_thrown_for_non_positive_pulse_rate) {
+  EXPECT_THROW(SyntheticFileReader(0, testDetectorNumbers,
+                                   createSettings(0, 10, "constant")),
+               std::runtime_error);
+}
+
+TEST(SyntheticFileReaderTest, error_thrown_if_no_detector_numbers_given) {
+  EXPECT_THROW(SyntheticFileReader(0, {}, createSettings(14, 10, "constant")),
+               std::runtime_error);
+}
+
+TEST(SyntheticFileReaderTest, frames_follow_each_other_at_the_pulse_rate) {
+  const uint64_t runStart = 1000000000;
+  SyntheticFileReader reader(runStart, testDetectorNumbers,
+                             createSettings(50, 10, "constant"));
+  EXPECT_EQ(500, reader.getNumberOfFrames());
+  EXPECT_EQ(runStart, reader.getFrameTime(0));
+  EXPECT_EQ(runStart + 20000000, reader.getFrameTime(1));
+  EXPECT_EQ(runStart + 2000000000, reader.getFrameTime(100));
+  EXPECT_EQ(2000, reader.getRelativeFrameTimeMilliseconds(100));
+  EXPECT_EQ(10000, reader.getRunDurationMs());
+  EXPECT_EQ(50000, reader.getTotalEventCount());
+  EXPECT_EQ("SYNTH", reader.getInstrumentName());
+}
+
+TEST(SyntheticFileReaderTest, run_without_duration_never_ends) {
+  SyntheticFileReader reader(0, testDetectorNumbers,
+                             createSettings(14, 0, "poisson"));
+  EXPECT_EQ(std::numeric_limits<size_t>::max(), reader.getNumberOfFrames());
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(), reader.getRunDurationMs());
+  EXPECT_FALSE(reader.getEventData(1000000).empty());
+}
+
+TEST(SyntheticFileReaderTest,
+     constant_distribution_gives_same_count_each_pulse) {
+  SyntheticFileReader reader(0, testDetectorNumbers,
+                             createSettings(14, 10, "constant"));
+  for (hsize_t frameNumber = 0; frameNumber < 10; ++frameNumber) {
+    auto eventData = reader.getEventData(frameNumber);
+    ASSERT_EQ(1, eventData.size());
+    EXPECT_EQ(100, eventData[0].detectorIDs.size());
+    EXPECT_EQ(100, eventData[0].timeOfFlights.size());
+  }
+}
+
+TEST(SyntheticFileReaderTest, poisson_distribution_varies_count_around_mean) {
+  SyntheticFileReader reader(0, testDetectorNumbers,
+                             createSettings(14, 100, "poisson"));
+  size_t totalEvents = 0;
+  bool countVaries = false;
+  const hsize_t numberOfFrames = 1000;
+  for (hsize_t frameNumber = 0; frameNumber < numberOfFrames; ++frameNumber) {
+    const auto numberOfEvents =
+        reader.getEventData(frameNumber)[0].detectorIDs.size();
+    totalEvents += numberOfEvents;
+    countVaries = countVaries || numberOfEvents != 100;
+  }
+  EXPECT_TRUE(countVaries);
+  EXPECT_NEAR(100.0, static_cast<double>(totalEvents) / numberOfFrames, 2.0);
+}
+
+TEST(SyntheticFileReaderTest, events_use_given_detector_numbers) {
+  SyntheticFileReader reader(0, testDetectorNumbers,
+                             createSettings(14, 10, "constant"));
+  auto eventData = reader.getEventData(0);
+  for (const auto detectorID : eventData[0].detectorIDs) {
+    EXPECT_THAT(testDetectorNumbers,
+                ::testing::Contains(static_cast<int32_t>(detectorID)));
+  }
+  for (const auto timeOfFlight : eventData[0].timeOfFlights) {
+    EXPECT_GE(timeOfFlight, 10000u);
+    EXPECT_LE(timeOfFlight, 100000u);
+  }
+}
+
+TEST(SyntheticFileReaderTest, no_events_after_end_of_run) {
+  SyntheticFileReader reader(0, testDetectorNumbers,
+                             createSettings(14, 1, "constant"));
+  EXPECT_EQ(14, reader.getNumberOfFrames());
+  EXPECT_TRUE(reader.getEventData(14).empty());
+}
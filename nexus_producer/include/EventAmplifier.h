@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../../core/include/EventDataFrame.h"
+
+/// Replicates the events of a frame to simulate a larger detector: copy k of
+/// each event has detectorIDOffset * k added to its detector ID, and copies
+/// other than the original optionally have their time of flight jittered
+class EventAmplifier {
+public:
+  /// @param amplificationFactor - number of copies of each event, 1 to disable
+  /// @param detectorIDOffset - added to detector IDs for each copy, must be
+  /// larger than the largest detector ID for the copies to be disjoint
+  /// @param timeOfFlightJitter - copies have their time of flight shifted by
+  /// up to this many nanoseconds either way, 0 for none
+  /// @param seed - jitter is reproducible for the same seed
+  EventAmplifier(uint32_t amplificationFactor, uint32_t detectorIDOffset,
+                 uint32_t timeOfFlightJitter, uint64_t seed);
+
+  /// Check that the copies of every detector ID up to maxDetectorID are in
+  /// disjoint ranges and fit in 32 bits
+  /// @throw std::runtime_error - if they do not
+  static void checkDetectorIDRange(uint32_t amplificationFactor,
+                                   uint32_t detectorIDOffset,
+                                   uint32_t maxDetectorID);
+
+  bool isEnabled() const { return m_amplificationFactor > 1; }
+  uint32_t getAmplificationFactor() const { return m_amplificationFactor; }
+
+  /// Each NXevent_data group of each frame gets its own stream of random
+  /// numbers for jitter, so the same frame is always jittered the same way
+  EventDataFrame amplify(const EventDataFrame &eventDataFrame,
+                         uint64_t frameNumber, uint64_t groupNumber) const;
+  void amplify(const uint32_t *detectorIDs, const uint32_t *timeOfFlights,
+               size_t numberOfEvents, uint32_t *outputDetectorIDs,
+               uint32_t *outputTimeOfFlights, uint64_t frameNumber,
+               uint64_t groupNumber) const;
+
+private:
+  const uint32_t m_amplificationFactor;
+  const uint32_t m_detectorIDOffset;
+  const uint32_t m_timeOfFlightJitter;
+  const uint64_t m_seed;
+};
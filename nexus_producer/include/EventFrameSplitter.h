@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../../core/include/EventDataFrame.h"
+
+/// Splits the events of a frame so that each can be published as a separate
+/// message, by detector ID range and then by a maximum number of events
+class EventFrameSplitter {
+public:
+  /// @param maxEventsPerMessage - 0 for no limit
+  /// @param detectorIDBoundaries - sorted detector IDs at which a new range
+  /// starts, empty to not split by detector ID
+  EventFrameSplitter(uint32_t maxEventsPerMessage,
+                     std::vector<uint32_t> detectorIDBoundaries);
+
+  bool isEnabled() const {
+    return m_maxEventsPerMessage > 0 || !m_detectorIDBoundaries.empty();
+  }
+
+  std::vector<EventDataFrame> split(EventDataFrame eventDataFrame) const;
+
+private:
+  std::vector<EventDataFrame>
+  splitByDetectorID(const EventDataFrame &eventDataFrame) const;
+  void splitBySize(EventDataFrame eventDataFrame,
+                   std::vector<EventDataFrame> &output) const;
+
+  const uint32_t m_maxEventsPerMessage;
+  const std::vector<uint32_t> m_detectorIDBoundaries;
+};
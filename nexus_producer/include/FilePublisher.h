@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Publisher.h"
+
+/*
+ * Publisher which appends the messages of each topic to a file in an output
+ * directory, for measuring throughput without a Kafka broker. Each message is
+ * preceded by its size as a 32 bit integer.
+ */
+class FilePublisher : public Publisher {
+public:
+  explicit FilePublisher(std::string outputDirectory);
+
+  void setUp(const std::string &broker,
+             const std::string &instrumentName) override;
+  void sendEventMessage(Streamer::Message &message) override;
+  void sendRunMessage(Streamer::Message &message) override;
+  void sendDetSpecMessage(Streamer::Message &message) override;
+  void sendSampleEnvMessage(Streamer::Message &message) override;
+  void sendHistogramMessage(Streamer::Message &message) override;
+  void flushSendQueue() override;
+  /// @return - number of event messages written
+  int64_t getCurrentOffset() override { return m_numberOfEventMessages; }
+
+  /// Name of the file which a topic is written to
+  static std::string getTopicFilename(const std::string &outputDirectory,
+                                      const std::string &topicName);
+
+private:
+  /// File for one topic, with a write buffer large enough that writes to the
+  /// file are rare compared to the number of messages
+  struct TopicFile {
+    explicit TopicFile(const std::string &filename);
+    void write(Streamer::Message &message);
+    void flush();
+
+    std::vector<char> buffer;
+    std::ofstream file;
+    /// Histograms are published from a separate thread
+    std::mutex mutex;
+  };
+
+  const std::string m_outputDirectory;
+  std::unique_ptr<TopicFile> m_eventFile;
+  std::unique_ptr<TopicFile> m_runFile;
+  std::unique_ptr<TopicFile> m_detSpecFile;
+  std::unique_ptr<TopicFile> m_sampleEnvFile;
+  std::unique_ptr<TopicFile> m_histogramFile;
+  std::atomic<int64_t> m_numberOfEventMessages{0};
+};
@@ -1,42 +1,130 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <librdkafka/rdkafkacpp.h>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
 
 #include "Publisher.h"
 
 class KafkaPublisher : public Publisher {
 public:
+  /// A librdkafka producer property which only applies to one topic
+  struct TopicConfigOption {
+    /// Topic name without the instrument prefix, for example events
+    std::string topic;
+    std::string name;
+    std::string value;
+  };
+
   KafkaPublisher() = default;
   explicit KafkaPublisher(std::string compression)
       : m_compression(std::move(compression)){};
   ~KafkaPublisher() override;
 
-  std::shared_ptr<RdKafka::Topic>
-  createTopicHandle(const std::string &topicName,
-                    std::shared_ptr<RdKafka::Conf> tconf);
   void setUp(const std::string &broker,
              const std::string &instrumentName) override;
   void sendEventMessage(Streamer::Message &message) override;
   void sendRunMessage(Streamer::Message &message) override;
+  /// Hold the run stop message back until every message sent before it has
+  /// been delivered, without blocking, later run messages queue behind it
+  void sendRunStopMessage(Streamer::Message &message) override;
   void sendDetSpecMessage(Streamer::Message &message) override;
   void sendSampleEnvMessage(Streamer::Message &message) override;
   void sendHistogramMessage(Streamer::Message &message) override;
   int64_t getCurrentOffset() override;
   void flushSendQueue() override;
+  /// If false, messages are produced without copying them, so their buffers
+  /// must stay valid until the send queue has been flushed
+  void setCopyPayloads(bool copyPayloads);
+  /// Set a librdkafka configuration property, must be called before setUp
+  void setConfigOption(const std::string &name, const std::string &value);
+  /// Set a librdkafka producer property for one topic only, for example its
+  /// linger.ms or batch.num.messages, must be called before setUp
+  void setTopicConfigOption(const TopicConfigOption &option);
+  /// Parse a topic option given as TOPIC:NAME=VALUE
+  static TopicConfigOption parseTopicConfigOption(const std::string &spec);
+  /// Receive a report when each message is delivered or fails, the callback
+  /// is called from calls to poll, must be called before setUp
+  void setDeliveryReportCallback(RdKafka::DeliveryReportCb *callback);
 
 private:
-  void sendMessage(Streamer::Message &message,
-                   std::shared_ptr<RdKafka::Topic> topic);
-
-  std::shared_ptr<RdKafka::Producer> m_producer_ptr;
-  std::shared_ptr<RdKafka::Topic> m_topic_ptr;
-  std::shared_ptr<RdKafka::Topic> m_runTopic_ptr;
-  std::shared_ptr<RdKafka::Topic> m_detSpecTopic_ptr;
-  std::shared_ptr<RdKafka::Topic> m_sampleEnvTopic_ptr;
-  std::shared_ptr<RdKafka::Topic> m_histogramTopic_ptr;
+  using ProducerOptions = std::map<std::string, std::string>;
+
+  /// A topic and the producer which publishes to it
+  struct TopicHandle {
+    std::shared_ptr<RdKafka::Producer> producer;
+    std::shared_ptr<RdKafka::Topic> topic;
+  };
+
+  /// Messages produced between holding one run message and the next, a held
+  /// run message is sent once every message of the epochs before it has been
+  /// delivered
+  struct DeliveryEpoch {
+    std::atomic<uint64_t> numberOfMessagesProduced{0};
+    std::atomic<uint64_t> numberOfReports{0};
+  };
+
+  /// Counts delivery reports, successful or not, in the epoch the message was
+  /// produced in and passes them on to the callback given to
+  /// setDeliveryReportCallback
+  class DeliveryCounter : public RdKafka::DeliveryReportCb {
+  public:
+    void dr_cb(RdKafka::Message &message) override;
+    void setCallback(RdKafka::DeliveryReportCb *callback) {
+      m_callback = callback;
+    }
+
+  private:
+    RdKafka::DeliveryReportCb *m_callback = nullptr;
+  };
+
+  TopicHandle createTopicHandle(const std::string &topicName,
+                                const std::string &topicSuffix,
+                                ProducerOptions producerOptions,
+                                const std::string &broker);
+  std::shared_ptr<RdKafka::Producer>
+  createProducer(const ProducerOptions &producerOptions,
+                 const std::string &broker);
+  void sendMessage(Streamer::Message &message, const TopicHandle &topic);
+  void produce(RdKafka::Producer &producer, RdKafka::Topic *topic, char *data,
+               size_t size, int flags);
+  void holdRunMessage(Streamer::Message &message);
+  void sendHeldRunMessages();
+  bool hasHeldRunMessages();
+
+  /// Topics whose producer options are the same share a producer
+  std::map<ProducerOptions, std::shared_ptr<RdKafka::Producer>> m_producers;
+  std::shared_ptr<RdKafka::Conf> m_topicConf;
+  TopicHandle m_eventTopic;
+  TopicHandle m_runTopic;
+  TopicHandle m_detSpecTopic;
+  TopicHandle m_sampleEnvTopic;
+  TopicHandle m_histogramTopic;
   std::string m_compression = "";
+  int m_produceFlags = RdKafka::Producer::RK_MSG_COPY;
+  std::vector<std::pair<std::string, std::string>> m_configOptions;
+  /// Producer options set for a single topic, by topic name without the
+  /// instrument prefix
+  std::map<std::string, ProducerOptions> m_topicConfigOptions;
+  DeliveryCounter m_deliveryCounter;
+  std::mutex m_heldRunMessagesMutex;
+  /// Payloads of the held run messages, each starts a new delivery epoch
+  std::deque<std::vector<char>> m_heldRunMessages;
+  /// One more epoch than there are held run messages, the last is the epoch
+  /// messages are currently produced in. Messages keep a pointer to the epoch
+  /// they were produced in, which a deque keeps valid as epochs are added to
+  /// the end and removed from the front.
+  std::deque<DeliveryEpoch> m_deliveryEpochs = std::deque<DeliveryEpoch>(1);
+  std::atomic<DeliveryEpoch *> m_currentEpoch{&m_deliveryEpochs.back()};
+  /// Size of m_heldRunMessages, so that sending a message only takes the mutex
+  /// if there are held messages
+  std::atomic<size_t> m_numberOfHeldRunMessages{0};
   std::shared_ptr<spdlog::logger> m_logger = spdlog::get("LOG");
 
   // Use default partition assignment for messages
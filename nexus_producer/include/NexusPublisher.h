@@ -1,14 +1,21 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <nonstd/optional.hpp>
 #include <spdlog/spdlog.h>
 
 #include "../../core/include/OptionalArgs.h"
 #include "../../nexus_file_reader/include/FileReader.h"
+#include "../../serialisation/include/EventBatch.h"
+#include "../../serialisation/include/EventData.h"
+#include "../../serialisation/include/RunData.h"
+#include "EventAmplifier.h"
+#include "EventFrameSplitter.h"
 #include "Publisher.h"
+#include "ReplayCache.h"
+#include "SampleEnvBatcher.h"
 
-class EventData;
-struct RunData;
 class Timer;
 
 class NexusPublisher {
@@ -19,6 +26,7 @@ public:
   std::vector<EventData> createMessageData(hsize_t frameNumber);
   void streamData(int runNumber, const OptionalArgs &settings,
                   const std::string &jsonDescription);
+  void prepareRun();
 
 private:
   std::unique_ptr<Timer>
@@ -28,18 +36,44 @@ private:
   std::unique_ptr<Timer> streamHistogramData(const OptionalArgs &settings);
   size_t createAndSendRunMessage(int runNumber,
                                  const std::string &jsonDescription);
+  size_t sendDetSpecMapIfChanged();
   RunData createRunMessageData(int runNumber,
                                const std::string &jsonDescription);
+  std::vector<EventData> getMessageData(size_t frameNumber);
   size_t createAndSendMessage(size_t frameNumber);
-  void createAndSendSampleEnvMessages(size_t frameNumber);
+  size_t createAndSendBatchedMessages(size_t frameNumber);
+  size_t sendEventBatch();
+  size_t createAndSendSampleEnvMessages(size_t frameNumber);
   size_t createAndSendRunStopMessage(int runNumber);
+  void waitForFrame(size_t frameNumber,
+                    std::chrono::steady_clock::time_point runStart);
+  size_t sendReplayedMessages(size_t numberOfFrames);
   void reportProgress(float progress);
 
   const OptionalArgs m_settings;
   std::shared_ptr<Publisher> m_publisher;
   std::shared_ptr<FileReader> m_fileReader;
   std::string m_detSpecMapFilename;
-  std::unordered_map<hsize_t, sEEventVector> m_sEEventMap;
+  EventFrameSplitter m_eventFrameSplitter;
+  EventAmplifier m_eventAmplifier;
+  /// Events waiting to be published, only used for ev44 messages
+  EventBatch m_eventBatch;
+  SampleEnvironmentLogs m_sampleEnvLogs;
+  /// Only used if sample environment messages are batched
+  std::unique_ptr<SampleEnvBatcher> m_sampleEnvBatcher;
+  /// Only used if repeated runs are published from the replay cache
+  std::unique_ptr<ReplayCache> m_replayCache;
+  /// Serialise messages with every field present, so that the replay cache or
+  /// a stream recording can patch them
+  bool m_patchableMessages = false;
+  /// Read by prepareRun before the next run starts, each is used once
+  nonstd::optional<std::vector<HistogramFrame>> m_preparedHistograms;
+  std::vector<std::vector<EventData>> m_preparedFrames;
+  /// Run start message which is patched for each run
+  std::unique_ptr<RunStartMessageTemplate> m_runStartTemplate;
+  std::string m_runStartTemplateNexusStructure;
+  /// Only used if the map is published on its own topic
+  std::shared_ptr<const DetectorSpectrumMapData> m_publishedDetSpecMap;
   uint64_t m_messageID = 0;
   std::shared_ptr<spdlog::logger> m_logger = spdlog::get("LOG");
   // Keep hold of this when start is sent so can specify in run stop message
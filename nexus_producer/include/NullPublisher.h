@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+
+#include "Publisher.h"
+
+/// Publisher which discards every message, only counting them, for measuring
+/// how fast messages can be read and serialised
+class NullPublisher : public Publisher {
+public:
+  void setUp(const std::string &, const std::string &) override {}
+  void sendEventMessage(Streamer::Message &message) override;
+  void sendRunMessage(Streamer::Message &message) override;
+  void sendDetSpecMessage(Streamer::Message &message) override;
+  void sendSampleEnvMessage(Streamer::Message &message) override;
+  void sendHistogramMessage(Streamer::Message &message) override;
+  void flushSendQueue() override {}
+  /// @return - number of event messages received
+  int64_t getCurrentOffset() override { return m_numberOfEventMessages; }
+
+  int64_t getNumberOfMessages() const { return m_numberOfMessages; }
+  int64_t getNumberOfBytes() const { return m_numberOfBytes; }
+
+private:
+  void count(Streamer::Message &message);
+
+  std::atomic<int64_t> m_numberOfMessages{0};
+  std::atomic<int64_t> m_numberOfBytes{0};
+  std::atomic<int64_t> m_numberOfEventMessages{0};
+};
@@ -13,6 +13,12 @@ public:
                      const std::string &instrumentName) = 0;
   virtual void sendEventMessage(Streamer::Message &message) = 0;
   virtual void sendRunMessage(Streamer::Message &message) = 0;
+  /// Publish a run stop message after every message sent before it, by
+  /// default this waits for the send queue to be flushed
+  virtual void sendRunStopMessage(Streamer::Message &message) {
+    flushSendQueue();
+    sendRunMessage(message);
+  }
   virtual void sendDetSpecMessage(Streamer::Message &message) = 0;
   virtual void sendSampleEnvMessage(Streamer::Message &message) = 0;
   virtual void sendHistogramMessage(Streamer::Message &message) = 0;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+
+#include "Publisher.h"
+#include "ReplayCache.h"
+
+/// Publisher which forwards every message to another publisher and keeps a
+/// copy of the event and sample environment messages in a replay cache
+class RecordingPublisher : public Publisher {
+public:
+  RecordingPublisher(std::shared_ptr<Publisher> publisher, ReplayCache &cache);
+
+  void setUp(const std::string &broker,
+             const std::string &instrumentName) override;
+  void sendEventMessage(Streamer::Message &message) override;
+  void sendRunMessage(Streamer::Message &message) override;
+  void sendRunStopMessage(Streamer::Message &message) override;
+  void sendDetSpecMessage(Streamer::Message &message) override;
+  void sendSampleEnvMessage(Streamer::Message &message) override;
+  void sendHistogramMessage(Streamer::Message &message) override;
+  void flushSendQueue() override;
+  int64_t getCurrentOffset() override;
+
+  /// Set the frame which subsequent messages are recorded against
+  void setFrameNumber(size_t frameNumber) { m_frameNumber = frameNumber; }
+
+private:
+  std::shared_ptr<Publisher> m_publisher;
+  ReplayCache &m_cache;
+  size_t m_frameNumber = 0;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Streamer {
+class Message;
+}
+
+/*
+ * Keeps the serialised event and sample environment messages of a run so that
+ * later runs of the same file can be published without reading the file or
+ * serialising anything. Messages are kept in memory up to a budget, the rest
+ * are written to an unlinked temporary file which is memory mapped once the
+ * run has been recorded. Timestamps and message IDs are patched in place
+ * before each replay.
+ */
+class ReplayCache {
+public:
+  enum class MessageType : uint8_t { Event, SampleEnv };
+
+  explicit ReplayCache(size_t memoryBudgetBytes);
+  ~ReplayCache();
+  ReplayCache(const ReplayCache &) = delete;
+  ReplayCache &operator=(const ReplayCache &) = delete;
+
+  using ReplayCallback = std::function<void(
+      size_t frameNumber, MessageType type, Streamer::Message &message)>;
+
+  void startRecording(uint64_t firstFrameTimeNs, uint64_t firstMessageID);
+  void addMessage(size_t frameNumber, MessageType type, const uint8_t *data,
+                  size_t size);
+  void finishRecording();
+  bool isComplete() const { return m_complete; }
+
+  size_t getNumberOfMessages() const { return m_entries.size(); }
+  size_t getNumberOfEventMessages() const { return m_numberOfEventMessages; }
+
+  /// Patch the cached messages for the new run and pass each one, in the
+  /// order they were recorded, to the callback
+  /// @return - total size of the messages
+  size_t replay(uint64_t firstFrameTimeNs, uint64_t firstMessageID,
+                const ReplayCallback &callback);
+
+private:
+  struct Entry {
+    size_t frameNumber;
+    MessageType type;
+    bool spilled;
+    /// Index in m_inMemoryMessages, or offset in the spill file
+    size_t position;
+    size_t size;
+  };
+
+  void spill(const uint8_t *data, size_t size);
+  void discardSpillFile();
+
+  const size_t m_memoryBudgetBytes;
+  size_t m_inMemoryBytes = 0;
+  std::vector<std::vector<uint8_t>> m_inMemoryMessages;
+  std::vector<Entry> m_entries;
+  size_t m_numberOfEventMessages = 0;
+
+  int m_spillFileDescriptor = -1;
+  size_t m_spillFileSize = 0;
+  uint8_t *m_spillMapping = nullptr;
+
+  /// Time of the first frame and ID of the first event message which the
+  /// cached messages currently contain
+  uint64_t m_firstFrameTimeNs = 0;
+  uint64_t m_firstMessageID = 0;
+  bool m_complete = false;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../../serialisation/include/SampleEnvironmentLogs.h"
+#include "Publisher.h"
+
+/// Collects the samples of each log and publishes them as array-valued
+/// messages once a batch is full or its oldest sample is older than the
+/// flush interval
+class SampleEnvBatcher {
+public:
+  /// @param patchableMessages - serialise messages so that they can be patched
+  /// by a replay cache
+  SampleEnvBatcher(uint32_t maxSamplesPerMessage, uint32_t flushIntervalMs,
+                   bool patchableMessages = false);
+
+  /// Add the samples of a frame, publishing any batches which become due
+  /// @return - number of bytes published
+  size_t addSamples(const SampleEnvironmentLogs &logs,
+                    const SampleEnvironmentSampleRange &samples,
+                    uint64_t frameTimeNs, Publisher &publisher);
+
+  /// Publish all batches which have samples, for example at the end of a run
+  /// @return - number of bytes published
+  size_t flush(const SampleEnvironmentLogs &logs, Publisher &publisher);
+
+private:
+  struct Batch {
+    std::vector<uint32_t> sampleIndices;
+    uint64_t firstFrameTimeNs = 0;
+    int64_t messageCounter = 0;
+  };
+
+  size_t publishBatch(const SampleEnvironmentLogs &logs, uint32_t logIndex,
+                      Publisher &publisher);
+
+  const uint32_t m_maxSamplesPerMessage;
+  const uint64_t m_flushIntervalNs;
+  const bool m_patchableMessages;
+  /// One batch per log, indexed by log index
+  std::vector<Batch> m_batches;
+  /// Frame time of the oldest sample waiting in any batch
+  uint64_t m_oldestFrameTimeNs = 0;
+  size_t m_numberOfPendingSamples = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/*
+ * Layout of a memory mapped ring file which the streamer publishes into for
+ * consumers on the same host. The file contains one lane per topic, each lane
+ * is a ring buffer of messages with a position up to which messages have been
+ * written and a read cursor for each attached consumer. Positions only ever
+ * increase, the place in the lane's buffer is the position modulo the lane
+ * capacity.
+ *
+ * Each message is stored as a RecordHeader followed by the message, padded
+ * to 8 bytes. If a message does not fit before the end of the buffer a record
+ * with size wrapMarker is written and the message starts at the beginning.
+ */
+namespace SharedMemoryRing {
+
+enum class Lane : uint32_t {
+  Event,
+  RunInfo,
+  DetSpecMap,
+  SampleEnv,
+  Histogram,
+  NumberOfLanes
+};
+
+constexpr uint32_t numberOfLanes = static_cast<uint32_t>(Lane::NumberOfLanes);
+constexpr uint32_t maxConsumersPerLane = 16;
+constexpr uint64_t noConsumer = UINT64_MAX;
+constexpr uint32_t wrapMarker = UINT32_MAX;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "Ring file positions must be lock free to be shared between "
+              "processes");
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t numberOfLanes;
+  uint64_t laneCapacity;
+};
+
+/// Positions are on separate cache lines as they are written by different
+/// threads and processes
+struct alignas(64) LaneHeader {
+  /// End of the space taken by writers, some of it may not be written yet
+  alignas(64) std::atomic<uint64_t> reservedPosition;
+  /// End of the messages which consumers can read
+  alignas(64) std::atomic<uint64_t> committedPosition;
+  /// Position of the next message each consumer will read, or noConsumer
+  alignas(64) std::atomic<uint64_t> consumerCursors[maxConsumersPerLane];
+};
+
+struct RecordHeader {
+  uint32_t size;
+  uint32_t reserved;
+};
+
+inline size_t paddedSize(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+/// Offset of the first lane header from the start of the file
+constexpr size_t laneHeadersOffset = 64;
+
+inline size_t getLaneDataOffset(uint32_t laneIndex, uint64_t laneCapacity) {
+  return laneHeadersOffset + numberOfLanes * sizeof(LaneHeader) +
+         laneIndex * laneCapacity;
+}
+
+inline size_t getFileSize(uint64_t laneCapacity) {
+  return getLaneDataOffset(numberOfLanes, laneCapacity);
+}
+
+bool isRingFile(const FileHeader &header);
+void initialiseFileHeader(FileHeader &header, uint64_t laneCapacity);
+
+/*
+ * Consumer of one lane of a ring file, the messages are read in place from the
+ * mapped file without copying them
+ */
+class Reader {
+public:
+  Reader(const std::string &filename, Lane lane);
+  ~Reader();
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+
+  using MessageCallback = std::function<void(const uint8_t *data, size_t size)>;
+
+  /// Pass every message which has been published since the last call to the
+  /// callback, the message can only be used until the callback returns
+  /// @return - number of messages read
+  /// @throw std::runtime_error - if the publisher has detached this consumer
+  /// because it stopped reading
+  size_t read(const MessageCallback &callback);
+
+private:
+  void moveCursor(uint64_t position);
+
+  uint8_t *m_mapping = nullptr;
+  size_t m_mappingSize = 0;
+  uint64_t m_laneCapacity = 0;
+  LaneHeader *m_laneHeader = nullptr;
+  const uint8_t *m_laneData = nullptr;
+  uint32_t m_consumerSlot = 0;
+  /// Position of the next message to read, the cursor in the file is only
+  /// different if the publisher has detached this consumer
+  uint64_t m_position = 0;
+};
+} // namespace SharedMemoryRing
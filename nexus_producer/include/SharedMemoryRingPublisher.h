@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <string>
+
+#include "Publisher.h"
+#include "SharedMemoryRing.h"
+
+/*
+ * Publisher which writes messages into a memory mapped ring file, with a lane
+ * per topic, so that consumers on the same host can read them without a
+ * broker. Several threads can publish to the same lane. If a lane is full the
+ * publisher waits for the slowest attached consumer, messages are overwritten
+ * freely if no consumers are attached. A consumer which does not read anything
+ * for the consumer timeout while the publisher waits for it is detached.
+ * Messages can be up to half the size of a lane.
+ */
+class SharedMemoryRingPublisher : public Publisher {
+public:
+  SharedMemoryRingPublisher(
+      std::string filename, uint64_t laneCapacityBytes,
+      std::chrono::milliseconds consumerTimeout = std::chrono::seconds(5));
+  ~SharedMemoryRingPublisher() override;
+  SharedMemoryRingPublisher(const SharedMemoryRingPublisher &) = delete;
+  SharedMemoryRingPublisher &
+  operator=(const SharedMemoryRingPublisher &) = delete;
+
+  void setUp(const std::string &broker,
+             const std::string &instrumentName) override;
+  void sendEventMessage(Streamer::Message &message) override;
+  void sendRunMessage(Streamer::Message &message) override;
+  void sendDetSpecMessage(Streamer::Message &message) override;
+  void sendSampleEnvMessage(Streamer::Message &message) override;
+  void sendHistogramMessage(Streamer::Message &message) override;
+  /// Messages are visible to consumers as soon as they are sent
+  void flushSendQueue() override {}
+  /// @return - number of event messages published
+  int64_t getCurrentOffset() override { return m_numberOfEventMessages; }
+
+private:
+  void write(SharedMemoryRing::Lane lane, Streamer::Message &message);
+  void waitForConsumers(SharedMemoryRing::LaneHeader &laneHeader,
+                        uint32_t laneIndex, uint64_t end);
+  void detachStalledConsumers(SharedMemoryRing::LaneHeader &laneHeader,
+                              uint32_t laneIndex, uint64_t end);
+  uint64_t getSlowestConsumerPosition(
+      const SharedMemoryRing::LaneHeader &laneHeader) const;
+
+  const std::string m_filename;
+  const uint64_t m_laneCapacity;
+  const std::chrono::milliseconds m_consumerTimeout;
+  uint8_t *m_mapping = nullptr;
+  size_t m_mappingSize = 0;
+  std::atomic<int64_t> m_numberOfEventMessages{0};
+  std::shared_ptr<spdlog::logger> m_logger = spdlog::get("LOG");
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../core/include/Message.h"
+#include "Publisher.h"
+
+/// Topic which a recorded message is published on, the topic names are
+/// derived from the instrument name when the recording is replayed
+enum class RecordedTopic : uint8_t {
+  Event,
+  RunInfo,
+  DetSpecMap,
+  SampleEnv,
+  Histogram,
+  RunStop
+};
+
+/*
+ * Publisher which writes every message to a stream recording file instead of
+ * a data stream. Each message is stored with its topic and the time it was
+ * published relative to the start of the recording, so that the stream can be
+ * replayed later without reading or serialising the NeXus file.
+ */
+class StreamRecorder : public Publisher {
+public:
+  explicit StreamRecorder(const std::string &filename);
+
+  void setUp(const std::string &broker,
+             const std::string &instrumentName) override;
+  void sendEventMessage(Streamer::Message &message) override;
+  void sendRunMessage(Streamer::Message &message) override;
+  /// Run stops are recorded as they are, they are held back by the publisher
+  /// they are replayed to
+  void sendRunStopMessage(Streamer::Message &message) override;
+  void sendDetSpecMessage(Streamer::Message &message) override;
+  void sendSampleEnvMessage(Streamer::Message &message) override;
+  void sendHistogramMessage(Streamer::Message &message) override;
+  void flushSendQueue() override;
+  int64_t getCurrentOffset() override;
+
+private:
+  void writeMessage(Streamer::Message &message, RecordedTopic topic);
+
+  std::ofstream m_file;
+  std::chrono::steady_clock::time_point m_startTime;
+  /// Histograms are published from a separate thread
+  std::mutex m_fileMutex;
+};
+
+/*
+ * Stream recording file which has been memory mapped so that its messages can
+ * be published without copying them. Each replay is published as a new run:
+ * the run start and stop messages are created again with a new job ID, run
+ * name and filename, and the timestamps of the other messages are patched in
+ * the private mapping so that the run starts at the time of the replay.
+ */
+class StreamRecording {
+public:
+  explicit StreamRecording(const std::string &filename);
+  ~StreamRecording();
+  StreamRecording(const StreamRecording &) = delete;
+  StreamRecording &operator=(const StreamRecording &) = delete;
+
+  size_t getNumberOfMessages() const { return m_numberOfMessages; }
+
+  /// Publish every message in the recording, the messages refer to the mapped
+  /// file and are patched by the next replay, so the publisher's queue must be
+  /// flushed before replaying again or destroying the recording
+  /// @return - total size of the messages
+  size_t replay(Publisher &publisher, bool realTime);
+
+private:
+  uint8_t *m_mapping = nullptr;
+  size_t m_mappingSize = 0;
+  uint64_t m_numberOfMessages = 0;
+  uint64_t m_numberOfEventMessages = 0;
+  /// Start time of the first run start message in the recording, 0 if there
+  /// is none and the timestamps are not patched
+  uint64_t m_recordedStartTimeMs = 0;
+  /// Amount the timestamps in the mapping have been shifted by so far
+  int64_t m_timeShiftNs = 0;
+  uint64_t m_numberOfReplays = 0;
+  /// Run messages of the latest replay, kept until the next replay as they
+  /// may be published without being copied
+  std::vector<Streamer::Message> m_runMessages;
+};
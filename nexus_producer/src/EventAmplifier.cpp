@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "../../core/include/CounterBasedRandom.h"
+#include "EventAmplifier.h"
+
+EventAmplifier::EventAmplifier(const uint32_t amplificationFactor,
+                               const uint32_t detectorIDOffset,
+                               const uint32_t timeOfFlightJitter,
+                               const uint64_t seed)
+    : m_amplificationFactor(amplificationFactor),
+      m_detectorIDOffset(detectorIDOffset),
+      m_timeOfFlightJitter(timeOfFlightJitter), m_seed(seed) {
+  if (m_amplificationFactor == 0) {
+    throw std::runtime_error("Amplification factor must be at least 1");
+  }
+  if (isEnabled() && m_detectorIDOffset == 0) {
+    throw std::runtime_error(
+        "Amplifying events needs a detector ID offset for the copies");
+  }
+  // The largest detector ID is checked by the caller if it is known
+  checkDetectorIDRange(m_amplificationFactor, m_detectorIDOffset, 0);
+  if (m_timeOfFlightJitter >
+      static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+    throw std::runtime_error("Time of flight jitter is too large");
+  }
+}
+
+/**
+ * @param amplificationFactor - number of copies of each event
+ * @param detectorIDOffset - added to detector IDs for each copy
+ * @param maxDetectorID - largest detector ID of the original events
+ */
+void EventAmplifier::checkDetectorIDRange(const uint32_t amplificationFactor,
+                                          const uint32_t detectorIDOffset,
+                                          const uint32_t maxDetectorID) {
+  if (amplificationFactor <= 1) {
+    return;
+  }
+  if (detectorIDOffset <= maxDetectorID) {
+    throw std::runtime_error(
+        "Detector ID offset " + std::to_string(detectorIDOffset) +
+        " must be larger than the largest detector ID " +
+        std::to_string(maxDetectorID) + " for the copies to be disjoint");
+  }
+  if (maxDetectorID + static_cast<uint64_t>(detectorIDOffset) *
+                          (amplificationFactor - 1) >
+      std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Detector IDs of amplified events do not fit in "
+                             "32 bits, use a smaller offset or factor");
+  }
+}
+
+/**
+ * Replicate the events of a frame
+ *
+ * @param eventDataFrame - events from one NXevent_data group in a frame
+ * @param frameNumber - the frame the events are from
+ * @param groupNumber - the NXevent_data group the events are from
+ * @return - the original events followed by each of the copies
+ */
+EventDataFrame EventAmplifier::amplify(const EventDataFrame &eventDataFrame,
+                                       const uint64_t frameNumber,
+                                       const uint64_t groupNumber) const {
+  const auto numberOfEvents = eventDataFrame.detectorIDs.size();
+  std::vector<uint32_t> detectorIDs(numberOfEvents * m_amplificationFactor);
+  std::vector<uint32_t> timeOfFlights(numberOfEvents * m_amplificationFactor);
+  amplify(eventDataFrame.detectorIDs.data(),
+          eventDataFrame.timeOfFlights.data(), numberOfEvents,
+          detectorIDs.data(), timeOfFlights.data(), frameNumber, groupNumber);
+  return {std::move(detectorIDs), std::move(timeOfFlights)};
+}
+
+/**
+ * Replicate events into preallocated buffers, each loop only adds to or
+ * copies contiguous arrays so that it can be vectorised
+ *
+ * @param detectorIDs - detector IDs of the events
+ * @param timeOfFlights - times of flight of the events in nanoseconds
+ * @param numberOfEvents - number of events to replicate
+ * @param outputDetectorIDs - buffer for numberOfEvents times the
+ * amplification factor detector IDs
+ * @param outputTimeOfFlights - buffer for as many times of flight
+ * @param frameNumber - with groupNumber, chooses the random numbers for jitter
+ * @param groupNumber - the NXevent_data group the events are from
+ */
+void EventAmplifier::amplify(const uint32_t *detectorIDs,
+                             const uint32_t *timeOfFlights,
+                             const size_t numberOfEvents,
+                             uint32_t *outputDetectorIDs,
+                             uint32_t *outputTimeOfFlights,
+                             const uint64_t frameNumber,
+                             const uint64_t groupNumber) const {
+  const auto key = CounterBasedRandom::getKey(
+      CounterBasedRandom::getKey(m_seed, frameNumber), groupNumber);
+  const auto jitterRange = 2 * m_timeOfFlightJitter + 1;
+  for (uint32_t copy = 0; copy < m_amplificationFactor; ++copy) {
+    const auto detectorIDOffset = copy * m_detectorIDOffset;
+    auto copyDetectorIDs = outputDetectorIDs + copy * numberOfEvents;
+    auto copyTimeOfFlights = outputTimeOfFlights + copy * numberOfEvents;
+    for (size_t i = 0; i < numberOfEvents; ++i) {
+      copyDetectorIDs[i] = detectorIDs[i] + detectorIDOffset;
+    }
+    // The original events are kept as they are
+    if (copy == 0 || m_timeOfFlightJitter == 0) {
+      std::copy(timeOfFlights, timeOfFlights + numberOfEvents,
+                copyTimeOfFlights);
+      continue;
+    }
+    const auto firstCounter = copy * numberOfEvents;
+    for (size_t i = 0; i < numberOfEvents; ++i) {
+      const auto random = static_cast<uint32_t>(
+          CounterBasedRandom::get(key, firstCounter + i));
+      // Jitter is in [-m_timeOfFlightJitter, m_timeOfFlightJitter], times of
+      // flight are kept within the range of 32 bits
+      const auto shiftedTimeOfFlight =
+          static_cast<int64_t>(timeOfFlights[i]) +
+          CounterBasedRandom::reduce(random, jitterRange) -
+          m_timeOfFlightJitter;
+      copyTimeOfFlights[i] = static_cast<uint32_t>(std::min<int64_t>(
+          std::max<int64_t>(0, shiftedTimeOfFlight),
+          std::numeric_limits<uint32_t>::max()));
+    }
+  }
+}
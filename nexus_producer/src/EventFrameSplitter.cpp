@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "EventFrameSplitter.h"
+
+EventFrameSplitter::EventFrameSplitter(
+    const uint32_t maxEventsPerMessage,
+    std::vector<uint32_t> detectorIDBoundaries)
+    : m_maxEventsPerMessage(maxEventsPerMessage),
+      m_detectorIDBoundaries(std::move(detectorIDBoundaries)) {
+  if (std::adjacent_find(m_detectorIDBoundaries.cbegin(),
+                         m_detectorIDBoundaries.cend(),
+                         std::greater_equal<uint32_t>()) !=
+      m_detectorIDBoundaries.cend()) {
+    throw std::runtime_error(
+        "Detector ID boundaries for splitting messages must be increasing");
+  }
+}
+
+/**
+ * Split the events of a frame by detector ID range, then split each range
+ * into chunks of no more than the maximum number of events
+ *
+ * @param eventDataFrame - events from one NXevent_data group in a frame
+ * @return - events for each message, ranges with no events are omitted
+ */
+std::vector<EventDataFrame>
+EventFrameSplitter::split(EventDataFrame eventDataFrame) const {
+  std::vector<EventDataFrame> splitFrames;
+  if (m_detectorIDBoundaries.empty()) {
+    splitBySize(std::move(eventDataFrame), splitFrames);
+    return splitFrames;
+  }
+  for (auto &rangeFrame : splitByDetectorID(eventDataFrame)) {
+    splitBySize(std::move(rangeFrame), splitFrames);
+  }
+  return splitFrames;
+}
+
+/**
+ * Partition the events by detector ID range, keeping events in the same order
+ * within each range
+ *
+ * @param eventDataFrame - events to partition
+ * @return - events in each non-empty range, in order of detector ID range
+ */
+std::vector<EventDataFrame> EventFrameSplitter::splitByDetectorID(
+    const EventDataFrame &eventDataFrame) const {
+  const auto &detectorIDs = eventDataFrame.detectorIDs;
+  const auto numberOfEvents = detectorIDs.size();
+
+  // Range of each event is the number of boundaries at or below its detector
+  // ID. One branch-free pass per boundary lets the compiler vectorise the
+  // comparisons, there are only ever a few boundaries.
+  std::vector<uint32_t> eventRanges(numberOfEvents, 0);
+  for (const auto boundary : m_detectorIDBoundaries) {
+    for (size_t eventIndex = 0; eventIndex < numberOfEvents; ++eventIndex) {
+      eventRanges[eventIndex] +=
+          static_cast<uint32_t>(detectorIDs[eventIndex] >= boundary);
+    }
+  }
+
+  // Counting sort, so each event is copied once to its range
+  const auto numberOfRanges = m_detectorIDBoundaries.size() + 1;
+  std::vector<size_t> rangeSizes(numberOfRanges, 0);
+  for (const auto range : eventRanges) {
+    ++rangeSizes[range];
+  }
+  std::vector<std::vector<uint32_t>> rangeDetectorIDs(numberOfRanges);
+  std::vector<std::vector<uint32_t>> rangeTimeOfFlights(numberOfRanges);
+  for (size_t range = 0; range < numberOfRanges; ++range) {
+    rangeDetectorIDs[range].reserve(rangeSizes[range]);
+    rangeTimeOfFlights[range].reserve(rangeSizes[range]);
+  }
+  for (size_t eventIndex = 0; eventIndex < numberOfEvents; ++eventIndex) {
+    const auto range = eventRanges[eventIndex];
+    rangeDetectorIDs[range].push_back(detectorIDs[eventIndex]);
+    rangeTimeOfFlights[range].push_back(
+        eventDataFrame.timeOfFlights[eventIndex]);
+  }
+
+  std::vector<EventDataFrame> rangeFrames;
+  for (size_t range = 0; range < numberOfRanges; ++range) {
+    if (rangeSizes[range] > 0) {
+      rangeFrames.emplace_back(std::move(rangeDetectorIDs[range]),
+                               std::move(rangeTimeOfFlights[range]));
+    }
+  }
+  return rangeFrames;
+}
+
+void EventFrameSplitter::splitBySize(
+    EventDataFrame eventDataFrame, std::vector<EventDataFrame> &output) const {
+  const auto numberOfEvents = eventDataFrame.detectorIDs.size();
+  if (m_maxEventsPerMessage == 0 || numberOfEvents <= m_maxEventsPerMessage) {
+    output.push_back(std::move(eventDataFrame));
+    return;
+  }
+  for (size_t chunkStart = 0; chunkStart < numberOfEvents;
+       chunkStart += m_maxEventsPerMessage) {
+    const auto chunkEnd =
+        std::min(chunkStart + m_maxEventsPerMessage, numberOfEvents);
+    output.emplace_back(
+        std::vector<uint32_t>(eventDataFrame.detectorIDs.cbegin() + chunkStart,
+                              eventDataFrame.detectorIDs.cbegin() + chunkEnd),
+        std::vector<uint32_t>(
+            eventDataFrame.timeOfFlights.cbegin() + chunkStart,
+            eventDataFrame.timeOfFlights.cbegin() + chunkEnd));
+  }
+}
@@ -0,0 +1,98 @@
+#include <stdexcept>
+
+#include "../../core/include/Message.h"
+#include "FilePublisher.h"
+#include "TopicNames.h"
+
+namespace {
+const size_t writeBufferSize = 4 * 1024 * 1024;
+}
+
+/**
+ * @param outputDirectory - directory to create the topic files in, it must
+ * already exist
+ */
+FilePublisher::FilePublisher(std::string outputDirectory)
+    : m_outputDirectory(std::move(outputDirectory)) {}
+
+FilePublisher::TopicFile::TopicFile(const std::string &filename)
+    : buffer(writeBufferSize) {
+  // The buffer must be set before the file is opened
+  file.rdbuf()->pubsetbuf(buffer.data(),
+                          static_cast<std::streamsize>(buffer.size()));
+  file.open(filename, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Failed to create output file " + filename);
+  }
+}
+
+void FilePublisher::TopicFile::write(Streamer::Message &message) {
+  const auto size = static_cast<uint32_t>(message.size());
+  std::lock_guard<std::mutex> lock(mutex);
+  file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  file.write(message.data(), message.size());
+}
+
+std::string
+FilePublisher::getTopicFilename(const std::string &outputDirectory,
+                                const std::string &topicName) {
+  return outputDirectory + "/" + topicName + ".msgs";
+}
+
+/**
+ * Create a file for each topic, replacing any existing files
+ *
+ * @param broker - not used
+ * @param instrumentName - used as prefix for the topic names
+ */
+void FilePublisher::setUp(const std::string &,
+                          const std::string &instrumentName) {
+  TopicNames topicNames(instrumentName);
+  m_eventFile = std::make_unique<TopicFile>(
+      getTopicFilename(m_outputDirectory, topicNames.event));
+  m_runFile = std::make_unique<TopicFile>(
+      getTopicFilename(m_outputDirectory, topicNames.runInfo));
+  m_detSpecFile = std::make_unique<TopicFile>(
+      getTopicFilename(m_outputDirectory, topicNames.detSpecMap));
+  m_sampleEnvFile = std::make_unique<TopicFile>(
+      getTopicFilename(m_outputDirectory, topicNames.sampleEnv));
+  m_histogramFile = std::make_unique<TopicFile>(
+      getTopicFilename(m_outputDirectory, topicNames.histogram));
+}
+
+void FilePublisher::sendEventMessage(Streamer::Message &message) {
+  m_eventFile->write(message);
+  ++m_numberOfEventMessages;
+}
+
+void FilePublisher::sendRunMessage(Streamer::Message &message) {
+  m_runFile->write(message);
+}
+
+void FilePublisher::sendDetSpecMessage(Streamer::Message &message) {
+  m_detSpecFile->write(message);
+}
+
+void FilePublisher::sendSampleEnvMessage(Streamer::Message &message) {
+  m_sampleEnvFile->write(message);
+}
+
+void FilePublisher::sendHistogramMessage(Streamer::Message &message) {
+  m_histogramFile->write(message);
+}
+
+void FilePublisher::TopicFile::flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+  file.flush();
+}
+
+/**
+ * Write everything in the buffers to the files
+ */
+void FilePublisher::flushSendQueue() {
+  m_eventFile->flush();
+  m_runFile->flush();
+  m_detSpecFile->flush();
+  m_sampleEnvFile->flush();
+  m_histogramFile->flush();
+}
@@ -1,7 +1,15 @@
+#include <algorithm>
+
 #include "KafkaPublisher.h"
 #include "../../core/include/Message.h"
 #include "TopicNames.h"
 
+namespace {
+/// Names of the topics without the instrument prefix
+const std::vector<std::string> topicSuffixes{"events", "runInfo", "sampleEnv",
+                                             "histograms", "detSpecMap"};
+} // namespace
+
 KafkaPublisher::~KafkaPublisher() {
   flushSendQueue();
   RdKafka::wait_destroyed(5000);
@@ -17,13 +25,49 @@ void KafkaPublisher::setUp(const std::string &broker,
                            const std::string &instrumentName) {
 
   m_logger->info("Setting up Kafka producer");
+  if (!m_compression.empty()) {
+    m_logger->info("Using {} compression codec", m_compression);
+  }
 
-  std::string error_str;
+  m_topicConf = std::shared_ptr<RdKafka::Conf>(
+      RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC));
 
+  // Events have a producer of their own so that other messages do not queue
+  // behind large event messages, the small control and log messages are sent
+  // as soon as they are produced
+  const ProducerOptions priorityOptions{{"linger.ms", "0"}};
+  auto topicNames = TopicNames(instrumentName);
+  m_eventTopic = createTopicHandle(topicNames.event, "events", {}, broker);
+  m_runTopic = createTopicHandle(topicNames.runInfo, "runInfo",
+                                 priorityOptions, broker);
+  m_detSpecTopic = createTopicHandle(topicNames.detSpecMap, "detSpecMap",
+                                     priorityOptions, broker);
+  m_sampleEnvTopic = createTopicHandle(topicNames.sampleEnv, "sampleEnv",
+                                       priorityOptions, broker);
+  m_histogramTopic = createTopicHandle(topicNames.histogram, "histograms",
+                                       priorityOptions, broker);
+
+  // This ensures everything is ready when we need to query offset information
+  // later
+  m_eventTopic.producer->poll(1000);
+  for (auto &producer : m_producers) {
+    producer.second->poll(0);
+  }
+}
+
+/**
+ * Create a producer with the common configuration and the given options
+ *
+ * @param producerOptions - librdkafka properties for this producer only
+ * @param broker - the IP or hostname of the broker
+ * @return - the producer
+ */
+std::shared_ptr<RdKafka::Producer>
+KafkaPublisher::createProducer(const ProducerOptions &producerOptions,
+                               const std::string &broker) {
+  std::string error_str;
   auto conf = std::unique_ptr<RdKafka::Conf>(
       RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
-  auto tconf = std::shared_ptr<RdKafka::Conf>(
-      RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC));
 
   std::string const maxMessageSize = "200000000";
 
@@ -40,58 +84,132 @@ void KafkaPublisher::setUp(const std::string &broker,
       m_logger->error(error_str);
       exit(1);
     }
-    m_logger->info("Using {} compression codec", m_compression);
   }
 
-  // Create producer
-  m_producer_ptr = std::shared_ptr<RdKafka::Producer>(
+  auto setOption = [&](const std::string &name, const std::string &value) {
+    if (conf->set(name, value, error_str) != RdKafka::Conf::CONF_OK) {
+      m_logger->error(error_str);
+      throw std::runtime_error("Failed to set producer option " + name);
+    }
+  };
+  // Options for this producer override the options for every producer
+  for (const auto &option : m_configOptions) {
+    setOption(option.first, option.second);
+  }
+  for (const auto &option : producerOptions) {
+    setOption(option.first, option.second);
+  }
+  // Delivery reports are needed to know when a run stop can be sent
+  conf->set("dr_cb", &m_deliveryCounter, error_str);
+
+  auto producer = std::shared_ptr<RdKafka::Producer>(
       RdKafka::Producer::create(conf.get(), error_str));
-  if (m_producer_ptr == nullptr) {
+  if (producer == nullptr) {
     m_logger->error("Failed to create producer: {}", error_str);
     throw std::runtime_error("Failed to create producer");
   }
+  return producer;
+}
 
-  // Create topics
-  auto topicNames = TopicNames(instrumentName);
-  m_topic_ptr = createTopicHandle(topicNames.event, tconf);
-  m_runTopic_ptr = createTopicHandle(topicNames.runInfo, tconf);
-  m_detSpecTopic_ptr = createTopicHandle(topicNames.detSpecMap, tconf);
-  m_sampleEnvTopic_ptr = createTopicHandle(topicNames.sampleEnv, tconf);
-  m_histogramTopic_ptr = createTopicHandle(topicNames.histogram, tconf);
+/**
+ * Wait for all messages in the current producer queue to be published,
+ * including any run messages which are being held back
+ */
+void KafkaPublisher::flushSendQueue() {
+  do {
+    for (auto &producer : m_producers) {
+      if (producer.second->flush(300000) != RdKafka::ERR_NO_ERROR) {
+        m_logger->error("Producer queue flush failed.");
+        return;
+      }
+    }
+    // Everything before the held messages has been delivered now
+    sendHeldRunMessages();
+  } while (hasHeldRunMessages());
+}
 
-  // This ensures everything is ready when we need to query offset information
-  // later
-  m_producer_ptr->poll(1000);
+void KafkaPublisher::setCopyPayloads(const bool copyPayloads) {
+  m_produceFlags = copyPayloads ? RdKafka::Producer::RK_MSG_COPY : 0;
+}
+
+void KafkaPublisher::setConfigOption(const std::string &name,
+                                     const std::string &value) {
+  m_configOptions.emplace_back(name, value);
+}
+
+void KafkaPublisher::setTopicConfigOption(const TopicConfigOption &option) {
+  // Use one name for the linger time, so that the option given here replaces
+  // the default for the topic rather than both being set in some order
+  const auto name =
+      option.name == "queue.buffering.max.ms" ? "linger.ms" : option.name;
+  m_topicConfigOptions[option.topic][name] = option.value;
 }
 
 /**
- * Wait for all messages in the current producer queue to be published
+ * Parse a producer property for a single topic
+ *
+ * @param spec - the property given as TOPIC:NAME=VALUE, where TOPIC is the
+ * topic name without the instrument prefix, for example events
+ * @return - the parsed property
  */
-void KafkaPublisher::flushSendQueue() {
-  auto error = m_producer_ptr->flush(300000);
-  if (error != RdKafka::ERR_NO_ERROR) {
-    m_logger->error("Producer queue flush failed.");
+KafkaPublisher::TopicConfigOption
+KafkaPublisher::parseTopicConfigOption(const std::string &spec) {
+  const auto separator = spec.find(':');
+  const auto equals = spec.find('=', separator);
+  if (separator == std::string::npos || equals == std::string::npos ||
+      equals == separator + 1) {
+    throw std::runtime_error("Topic option \"" + spec +
+                             "\" must be of the form TOPIC:NAME=VALUE");
   }
+  TopicConfigOption option{spec.substr(0, separator),
+                           spec.substr(separator + 1, equals - separator - 1),
+                           spec.substr(equals + 1)};
+  if (std::find(topicSuffixes.cbegin(), topicSuffixes.cend(), option.topic) ==
+      topicSuffixes.cend()) {
+    throw std::runtime_error("Unknown topic \"" + option.topic +
+                             "\" in topic option, expected one of events, "
+                             "runInfo, sampleEnv, histograms or detSpecMap");
+  }
+  return option;
+}
+
+void KafkaPublisher::setDeliveryReportCallback(
+    RdKafka::DeliveryReportCb *callback) {
+  m_deliveryCounter.setCallback(callback);
 }
 
 /**
- * Create a topic handle
+ * Create a topic handle, and a producer for it unless a topic with the same
+ * producer options already has one
  *
- * @param topic_str - name of the topic
- * @param topicConfig - configuration of the topic
+ * @param topicName - name of the topic
+ * @param topicSuffix - name of the topic without the instrument prefix
+ * @param producerOptions - default producer options for the topic, overridden
+ * by any given to setTopicConfigOption
+ * @param broker - the IP or hostname of the broker
  * @return topic handle
  */
-std::shared_ptr<RdKafka::Topic>
+KafkaPublisher::TopicHandle
 KafkaPublisher::createTopicHandle(const std::string &topicName,
-                                  std::shared_ptr<RdKafka::Conf> topicConfig) {
+                                  const std::string &topicSuffix,
+                                  ProducerOptions producerOptions,
+                                  const std::string &broker) {
+  for (const auto &option : m_topicConfigOptions[topicSuffix]) {
+    producerOptions[option.first] = option.second;
+  }
+  auto &producer = m_producers[producerOptions];
+  if (producer == nullptr) {
+    producer = createProducer(producerOptions, broker);
+  }
+
   std::string error_str;
   auto topic_ptr = std::shared_ptr<RdKafka::Topic>(RdKafka::Topic::create(
-      m_producer_ptr.get(), topicName, topicConfig.get(), error_str));
+      producer.get(), topicName, m_topicConf.get(), error_str));
   if (topic_ptr == nullptr) {
     m_logger->error("Failed to create topic: {}", error_str);
     throw std::runtime_error("Failed to create topic");
   }
-  return topic_ptr;
+  return {producer, topic_ptr};
 }
 
 /**
@@ -101,56 +219,151 @@ KafkaPublisher::createTopicHandle(const std::string &topicName,
  * @param messageSize - the size of the message in bytes
  */
 void KafkaPublisher::sendEventMessage(Streamer::Message &message) {
-  sendMessage(message, m_topic_ptr);
+  sendMessage(message, m_eventTopic);
 }
 
 void KafkaPublisher::sendRunMessage(Streamer::Message &message) {
-  sendMessage(message, m_runTopic_ptr);
+  // Keep run messages in order, a run start must not overtake the previous
+  // run's stop
+  if (hasHeldRunMessages()) {
+    holdRunMessage(message);
+    return;
+  }
+  sendMessage(message, m_runTopic);
+}
+
+void KafkaPublisher::sendRunStopMessage(Streamer::Message &message) {
+  holdRunMessage(message);
+  sendHeldRunMessages();
 }
 
 void KafkaPublisher::sendDetSpecMessage(Streamer::Message &message) {
-  sendMessage(message, m_detSpecTopic_ptr);
+  sendMessage(message, m_detSpecTopic);
 }
 
 void KafkaPublisher::sendSampleEnvMessage(Streamer::Message &message) {
-  sendMessage(message, m_sampleEnvTopic_ptr);
+  sendMessage(message, m_sampleEnvTopic);
 }
 
 void KafkaPublisher::sendHistogramMessage(Streamer::Message &message) {
-  sendMessage(message, m_histogramTopic_ptr);
+  sendMessage(message, m_histogramTopic);
 }
 
 void KafkaPublisher::sendMessage(Streamer::Message &message,
-                                 std::shared_ptr<RdKafka::Topic> topic) {
+                                 const TopicHandle &topic) {
+  produce(*topic.producer, topic.topic.get(), message.data(), message.size(),
+          m_produceFlags);
+  // Producing polls for delivery reports, which may release a held message
+  sendHeldRunMessages();
+}
+
+/**
+ * Produce a message, retrying while the producer queue is full. The message is
+ * counted in the current delivery epoch, its delivery report counts it as
+ * delivered.
+ *
+ * @param producer - producer of the topic
+ * @param topic - topic to publish to
+ * @param data - pointer to the message buffer
+ * @param size - the size of the message in bytes
+ * @param flags - librdkafka produce flags, for example whether to copy the
+ * message
+ */
+void KafkaPublisher::produce(RdKafka::Producer &producer,
+                             RdKafka::Topic *topic, char *data,
+                             const size_t size, const int flags) {
+  auto epoch = m_currentEpoch.load();
   RdKafka::ErrorCode resp;
   do {
 
-    resp = m_producer_ptr->produce(
-        topic.get(), m_partitionNumber, RdKafka::Producer::RK_MSG_COPY,
-        message.data(), message.size(), nullptr, nullptr);
+    // Counted before producing so that a delivery report can never be seen
+    // before the message it reports on has been counted
+    ++epoch->numberOfMessagesProduced;
+    resp = producer.produce(topic, m_partitionNumber, flags, data, size,
+                            nullptr, epoch);
 
     if (resp != RdKafka::ERR_NO_ERROR) {
+      --epoch->numberOfMessagesProduced;
       if (resp != RdKafka::ERR__QUEUE_FULL) {
         m_logger->error("Produce failed: {}\n"
                         "Message size was: {}",
-                        RdKafka::err2str(resp), message.size());
+                        RdKafka::err2str(resp), size);
       }
       // This blocking poll call should give Kafka some time for the problem to
       // be resolved
       // for example for messages to leave the queue if it is full
-      m_producer_ptr->poll(1000);
+      producer.poll(1000);
     } else {
-      m_producer_ptr->poll(0);
+      // Serve delivery reports of every producer
+      for (auto &otherProducer : m_producers) {
+        otherProducer.second->poll(0);
+      }
     }
   } while (resp == RdKafka::ERR__QUEUE_FULL);
 }
 
+/**
+ * Keep a copy of a run message to send once every message produced so far
+ * has been delivered. Messages produced from now on are counted in a new
+ * epoch, so that their delivery reports, which may arrive first as they can go
+ * through a different producer, do not count towards this message.
+ *
+ * @param message - the run message
+ */
+void KafkaPublisher::holdRunMessage(Streamer::Message &message) {
+  std::lock_guard<std::mutex> lock(m_heldRunMessagesMutex);
+  m_heldRunMessages.emplace_back(message.data(),
+                                 message.data() + message.size());
+  m_deliveryEpochs.emplace_back();
+  m_currentEpoch = &m_deliveryEpochs.back();
+  ++m_numberOfHeldRunMessages;
+}
+
+/**
+ * Produce the held run messages for which every message before them has been
+ * delivered, in the order they were held. The first held message belongs to
+ * the first epoch, earlier epochs having been removed with their messages.
+ */
+void KafkaPublisher::sendHeldRunMessages() {
+  // Called after every message is produced, so avoid taking the mutex in the
+  // usual case of nothing being held
+  if (!hasHeldRunMessages()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_heldRunMessagesMutex);
+  while (!m_heldRunMessages.empty() &&
+         m_deliveryEpochs.front().numberOfReports >=
+             m_deliveryEpochs.front().numberOfMessagesProduced) {
+    m_deliveryEpochs.pop_front();
+    auto &payload = m_heldRunMessages.front();
+    produce(*m_runTopic.producer, m_runTopic.topic.get(), payload.data(),
+            payload.size(), RdKafka::Producer::RK_MSG_COPY);
+    m_heldRunMessages.pop_front();
+    --m_numberOfHeldRunMessages;
+  }
+}
+
+bool KafkaPublisher::hasHeldRunMessages() {
+  return m_numberOfHeldRunMessages > 0;
+}
+
+void KafkaPublisher::DeliveryCounter::dr_cb(RdKafka::Message &message) {
+  if (m_callback != nullptr) {
+    m_callback->dr_cb(message);
+  }
+  auto epoch = static_cast<DeliveryEpoch *>(message.msg_opaque());
+  if (epoch != nullptr) {
+    ++epoch->numberOfReports;
+  }
+}
+
 int64_t KafkaPublisher::getCurrentOffset() {
 
   int64_t lowOffset = 0;
   int64_t highOffset = 0;
-  auto err = m_producer_ptr->query_watermark_offsets(
-      m_topic_ptr->name(), m_partitionNumber, &lowOffset, &highOffset, -1);
+  auto err = m_eventTopic.producer->query_watermark_offsets(
+      m_eventTopic.topic->name(), m_partitionNumber, &lowOffset, &highOffset,
+      -1);
   if (err != RdKafka::ERR_NO_ERROR) {
     m_logger->error("Failed to acquire current offset, will use 0: {}",
                     RdKafka::err2str(err));
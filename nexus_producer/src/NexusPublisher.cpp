@@ -1,18 +1,27 @@
 #include <chrono>
+#include <future>
 #include <iostream>
+#include <limits>
 #include <thread>
 
 #include "../../core/include/EventDataFrame.h"
 #include "../../core/include/HistogramFrame.h"
+#include "../../core/include/Message.h"
 #include "../../serialisation/include/DetectorSpectrumMapData.h"
 #include "../../serialisation/include/EventData.h"
 #include "../../serialisation/include/HistogramData.h"
 #include "../../serialisation/include/RunData.h"
 #include "JSONDescriptionLoader.h"
 #include "NexusPublisher.h"
+#include "RecordingPublisher.h"
 #include "Timer.h"
 
 namespace {
+/// prepareRun reads frames ahead until it has this many, or until they take
+/// this much memory, as frames of fake events can be very large
+const size_t maxFramesToPrepare = 16;
+const size_t maxBytesToPrepare = 64 * 1024 * 1024;
+
 uint64_t getTimeNowInMilliseconds() {
   auto now = std::chrono::system_clock::now();
   auto now_epoch = now.time_since_epoch();
@@ -21,6 +30,80 @@ uint64_t getTimeNowInMilliseconds() {
   return static_cast<uint64_t>(now_epoch_milliseconds);
 }
 
+/**
+ * Serialise event messages, using several threads if there is more than one
+ * message as each message is serialised independently
+ *
+ * @param messageData - events for each message
+ * @param firstMessageID - message ID of the first message, the rest follow on
+ * @param patchable - serialise the messages so that they can be patched
+ * @return - serialised messages in the same order as messageData
+ */
+std::vector<Streamer::Message>
+serialiseEventMessages(std::vector<EventData> &messageData,
+                       const uint64_t firstMessageID, const bool patchable) {
+  const auto numberOfMessages = messageData.size();
+  const auto numberOfWorkers = std::min<size_t>(
+      numberOfMessages, std::max(1u, std::thread::hardware_concurrency()));
+
+  // Each worker serialises a contiguous block of messages
+  std::vector<std::future<std::vector<Streamer::Message>>> workers;
+  for (size_t worker = 1; worker < numberOfWorkers; ++worker) {
+    const auto begin = worker * numberOfMessages / numberOfWorkers;
+    const auto end = (worker + 1) * numberOfMessages / numberOfWorkers;
+    workers.push_back(std::async(
+        std::launch::async,
+        [&messageData, firstMessageID, patchable, begin, end]() {
+          std::vector<Streamer::Message> buffers;
+          for (auto index = begin; index < end; ++index) {
+            buffers.push_back(messageData[index].getBuffer(
+                firstMessageID + index, patchable));
+          }
+          return buffers;
+        }));
+  }
+
+  std::vector<Streamer::Message> buffers;
+  buffers.reserve(numberOfMessages);
+  const auto firstBlockEnd = numberOfMessages / numberOfWorkers;
+  for (size_t index = 0; index < firstBlockEnd; ++index) {
+    buffers.push_back(
+        messageData[index].getBuffer(firstMessageID + index, patchable));
+  }
+  for (auto &worker : workers) {
+    for (auto &buffer : worker.get()) {
+      buffers.push_back(std::move(buffer));
+    }
+  }
+  return buffers;
+}
+
+/**
+ * Concatenate the events of all NXevent_data groups in a frame
+ *
+ * @param eventDataFrames - events from each group in the frame
+ * @return - a single frame containing all of the events
+ */
+EventDataFrame
+mergeEventDataFrames(const std::vector<EventDataFrame> &eventDataFrames) {
+  size_t numberOfEvents = 0;
+  for (const auto &eventDataFrame : eventDataFrames) {
+    numberOfEvents += eventDataFrame.detectorIDs.size();
+  }
+  std::vector<uint32_t> detectorIDs;
+  std::vector<uint32_t> timeOfFlights;
+  detectorIDs.reserve(numberOfEvents);
+  timeOfFlights.reserve(numberOfEvents);
+  for (const auto &eventDataFrame : eventDataFrames) {
+    detectorIDs.insert(detectorIDs.end(), eventDataFrame.detectorIDs.cbegin(),
+                       eventDataFrame.detectorIDs.cend());
+    timeOfFlights.insert(timeOfFlights.end(),
+                         eventDataFrame.timeOfFlights.cbegin(),
+                         eventDataFrame.timeOfFlights.cend());
+  }
+  return {std::move(detectorIDs), std::move(timeOfFlights)};
+}
+
 void createAndSendHistogramMessage(
     const std::vector<HistogramFrame> &histograms,
     const std::shared_ptr<Publisher> &publisher) {
@@ -52,13 +135,37 @@ NexusPublisher::NexusPublisher(std::shared_ptr<Publisher> publisher,
                                const OptionalArgs &settings)
     : m_settings(settings), m_publisher(std::move(publisher)),
       m_fileReader(std::move(fileReader)),
-      m_detSpecMapFilename(settings.detSpecFilename) {
-  m_sEEventMap = m_fileReader->getSEEventMap();
+      m_detSpecMapFilename(settings.detSpecFilename),
+      m_eventFrameSplitter(settings.maxEventsPerMessage,
+                           settings.splitDetectorIDs),
+      m_eventAmplifier(settings.amplificationFactor,
+                       settings.amplificationDetectorIDOffset,
+                       settings.amplificationTimeOfFlightJitterNs,
+                       settings.fakeEventSeed) {
+  m_sampleEnvLogs = m_fileReader->getSampleEnvLogs();
+  if (settings.replayCacheSizeMB > 0 && !settings.singleRun) {
+    if (settings.fakeEventsPerPulse != 0) {
+      m_logger->warn("Replay cache is not used when generating fake events");
+    } else {
+      m_replayCache = std::make_unique<ReplayCache>(
+          static_cast<size_t>(settings.replayCacheSizeMB) * 1024 * 1024);
+    }
+  }
+  m_patchableMessages =
+      m_replayCache != nullptr || !settings.recordFilename.empty();
+  if (settings.sampleEnvBatchSize > 0) {
+    m_sampleEnvBatcher = std::make_unique<SampleEnvBatcher>(
+        settings.sampleEnvBatchSize, settings.sampleEnvBatchIntervalMs,
+        m_patchableMessages);
+  }
 }
 
 /**
  * For a given frame number, reads the data from file and stores them in
- * messagesPerFrame EventData objects
+ * one EventData object per NXevent_data group, or a single object for all
+ * groups if they are being merged, then splits them into several objects if
+ * message splitting is enabled. Events are replicated first if amplification
+ * is enabled.
  *
  * @param frameNumber - the number of the frame for which to construct a message
  * @return - an object containing the data from the specified frame
@@ -71,23 +178,103 @@ NexusPublisher::createMessageData(const hsize_t frameNumber) {
   auto period = m_fileReader->getPeriodNumber();
   auto frameTime = m_fileReader->getFrameTime(frameNumber);
 
+  // Saturate, the total of an endless synthetic run is already the maximum
+  const auto amplificationFactor = m_eventAmplifier.getAmplificationFactor();
+  const auto fileTotalCounts = m_fileReader->getTotalEventCount();
+  const auto maxTotalCounts = std::numeric_limits<uint64_t>::max();
+  const auto totalCounts =
+      fileTotalCounts > maxTotalCounts / amplificationFactor
+          ? maxTotalCounts
+          : fileTotalCounts * amplificationFactor;
+
   auto eventDataFramesFromFile = m_fileReader->getEventData(frameNumber);
+  if (m_eventAmplifier.isEnabled()) {
+    for (size_t groupNumber = 0; groupNumber < eventDataFramesFromFile.size();
+         ++groupNumber) {
+      auto &eventDataFrame = eventDataFramesFromFile[groupNumber];
+      eventDataFrame =
+          m_eventAmplifier.amplify(eventDataFrame, frameNumber, groupNumber);
+    }
+  }
+  if (m_settings.mergeGroups && eventDataFramesFromFile.size() > 1) {
+    auto mergedFrame = mergeEventDataFrames(eventDataFramesFromFile);
+    eventDataFramesFromFile.clear();
+    eventDataFramesFromFile.push_back(std::move(mergedFrame));
+  }
+  if (m_eventFrameSplitter.isEnabled()) {
+    std::vector<EventDataFrame> splitFrames;
+    for (auto &eventDataFrame : eventDataFramesFromFile) {
+      for (auto &splitFrame :
+           m_eventFrameSplitter.split(std::move(eventDataFrame))) {
+        splitFrames.push_back(std::move(splitFrame));
+      }
+    }
+    eventDataFramesFromFile = std::move(splitFrames);
+  }
 
-  for (auto const &eventDataFrame : eventDataFramesFromFile) {
+  for (auto &eventDataFrame : eventDataFramesFromFile) {
     auto eventData = EventData();
     eventData.setProtonCharge(protonCharge);
     eventData.setPeriod(period);
     eventData.setFrameTime(frameTime);
-    eventData.setDetId(eventDataFrame.detectorIDs);
-    eventData.setTof(eventDataFrame.timeOfFlights);
-    eventData.setTotalCounts(m_fileReader->getTotalEventCount());
+    eventData.setDetId(std::move(eventDataFrame.detectorIDs));
+    eventData.setTof(std::move(eventDataFrame.timeOfFlights));
+    eventData.setTotalCounts(totalCounts);
 
-    eventDataVector.push_back(eventData);
+    eventDataVector.push_back(std::move(eventData));
   }
 
   return eventDataVector;
 }
 
+/**
+ * Get the events of a frame, from the frames read by prepareRun if it is one
+ * of them, otherwise from the file
+ *
+ * @param frameNumber - the number of the frame
+ * @return - an object containing the data from the specified frame
+ */
+std::vector<EventData>
+NexusPublisher::getMessageData(const size_t frameNumber) {
+  if (frameNumber < m_preparedFrames.size()) {
+    auto messageData = std::move(m_preparedFrames[frameNumber]);
+    if (frameNumber + 1 == m_preparedFrames.size()) {
+      m_preparedFrames.clear();
+    }
+    return messageData;
+  }
+  return createMessageData(frameNumber);
+}
+
+/**
+ * Read what the next run needs from the files, while waiting between runs,
+ * so that streamData can start publishing as soon as it is called: the
+ * histograms and the first frames of events, up to a limit on their size
+ */
+void NexusPublisher::prepareRun() {
+  if (m_fileReader->hasHistogramData() &&
+      m_settings.histogramUpdatePeriodMs != 0) {
+    m_preparedHistograms = m_fileReader->getHistoData();
+  }
+  // Events of a replayed run come from the cache instead
+  if (m_replayCache == nullptr || !m_replayCache->isComplete()) {
+    const auto numberOfFrames =
+        std::min(maxFramesToPrepare, m_fileReader->getNumberOfFrames());
+    m_preparedFrames.clear();
+    size_t preparedBytes = 0;
+    for (size_t frameNumber = 0;
+         frameNumber < numberOfFrames && preparedBytes < maxBytesToPrepare;
+         ++frameNumber) {
+      auto messageData = createMessageData(frameNumber);
+      for (const auto &eventData : messageData) {
+        // A detector ID and a time of flight for each event
+        preparedBytes += 2 * sizeof(uint32_t) * eventData.getNumberOfEvents();
+      }
+      m_preparedFrames.push_back(std::move(messageData));
+    }
+  }
+}
+
 /**
  * Create runData to send from information in the file
  *
@@ -131,7 +318,8 @@ std::unique_ptr<Timer> NexusPublisher::publishHistogramBatch(
 }
 
 /**
- * Start streaming all the data from the file
+ * Start streaming all the data from the file, or from the replay cache if it
+ * is enabled and a previous run has been recorded
  */
 void NexusPublisher::streamData(int runNumber, const OptionalArgs &settings,
                                 const std::string &jsonDescription) {
@@ -139,24 +327,44 @@ void NexusPublisher::streamData(int runNumber, const OptionalArgs &settings,
   int64_t totalBytesSent = 0;
   const auto numberOfFrames = m_fileReader->getNumberOfFrames();
 
+  // Record the messages of the first run by publishing through a recorder
+  std::shared_ptr<Publisher> originalPublisher;
+  std::shared_ptr<RecordingPublisher> recorder;
+  const bool replaying =
+      m_replayCache != nullptr && m_replayCache->isComplete();
+  if (m_replayCache != nullptr && !replaying && numberOfFrames > 0) {
+    m_replayCache->startRecording(m_fileReader->getFrameTime(0), m_messageID);
+    originalPublisher = m_publisher;
+    recorder =
+        std::make_shared<RecordingPublisher>(m_publisher, *m_replayCache);
+    m_publisher = recorder;
+  }
+
   totalBytesSent += createAndSendRunMessage(runNumber, jsonDescription);
   std::unique_ptr<Timer> histogramStreamer = streamHistogramData(settings);
 
-  uint64_t lastFrameTime = 0;
-  for (size_t frameNumber = 0; frameNumber < numberOfFrames; frameNumber++) {
-    // Publish messages at approx real message rate
-    if (settings.slow) {
-      auto frameTime =
-          m_fileReader->getRelativeFrameTimeMilliseconds(frameNumber);
-      auto frameDuration = frameTime - lastFrameTime;
-      std::this_thread::sleep_for(std::chrono::milliseconds(frameDuration));
-      lastFrameTime = frameTime;
+  if (replaying) {
+    totalBytesSent += sendReplayedMessages(numberOfFrames);
+  } else {
+    const auto runStart = std::chrono::steady_clock::now();
+    for (size_t frameNumber = 0; frameNumber < numberOfFrames; frameNumber++) {
+      // Publish messages at approx real message rate
+      waitForFrame(frameNumber, runStart);
+      if (recorder != nullptr) {
+        recorder->setFrameNumber(frameNumber);
+      }
+
+      totalBytesSent += createAndSendMessage(frameNumber);
+      totalBytesSent += createAndSendSampleEnvMessages(frameNumber);
+      reportProgress(static_cast<float>(frameNumber) /
+                     static_cast<float>(numberOfFrames));
     }
 
-    totalBytesSent += createAndSendMessage(frameNumber);
-    createAndSendSampleEnvMessages(frameNumber);
-    reportProgress(static_cast<float>(frameNumber) /
-                   static_cast<float>(numberOfFrames));
+    totalBytesSent += sendEventBatch();
+    if (m_sampleEnvBatcher != nullptr) {
+      totalBytesSent +=
+          m_sampleEnvBatcher->flush(m_sampleEnvLogs, *m_publisher);
+    }
   }
 
   if (histogramStreamer != nullptr) {
@@ -164,6 +372,11 @@ void NexusPublisher::streamData(int runNumber, const OptionalArgs &settings,
     histogramStreamer->waitForStop();
   }
 
+  if (recorder != nullptr) {
+    m_publisher = std::move(originalPublisher);
+    m_replayCache->finishRecording();
+  }
+
   totalBytesSent += createAndSendRunStopMessage(runNumber);
   reportProgress(1.0);
   std::cout << std::endl;
@@ -172,6 +385,57 @@ void NexusPublisher::streamData(int runNumber, const OptionalArgs &settings,
                  m_fileReader->getNumberOfFrames(), totalBytesSent);
 }
 
+/**
+ * In slow mode, sleep until the time of this frame relative to the first frame
+ * has passed since the run started. Sleeping until an absolute time means the
+ * time spent publishing each frame does not accumulate.
+ *
+ * @param frameNumber - the frame which is about to be published
+ * @param runStart - when the first frame was published
+ */
+void NexusPublisher::waitForFrame(
+    const size_t frameNumber,
+    const std::chrono::steady_clock::time_point runStart) {
+  if (m_settings.slow) {
+    const auto firstFrameTime = m_fileReader->getFrameTime(0);
+    const auto frameTime = m_fileReader->getFrameTime(frameNumber);
+    if (frameTime > firstFrameTime) {
+      std::this_thread::sleep_until(
+          runStart + std::chrono::nanoseconds(frameTime - firstFrameTime));
+    }
+  }
+}
+
+/**
+ * Publish the event and sample environment messages recorded in the replay
+ * cache, with their timestamps and message IDs patched for this run
+ *
+ * @param numberOfFrames - number of frames in the run, for reporting progress
+ * @return - size of the buffers sent
+ */
+size_t NexusPublisher::sendReplayedMessages(const size_t numberOfFrames) {
+  const auto runStart = std::chrono::steady_clock::now();
+  size_t currentFrameNumber = 0;
+  const auto bytesSent = m_replayCache->replay(
+      m_fileReader->getFrameTime(0), m_messageID,
+      [&](size_t frameNumber, ReplayCache::MessageType type,
+          Streamer::Message &message) {
+        if (frameNumber != currentFrameNumber) {
+          waitForFrame(frameNumber, runStart);
+          reportProgress(static_cast<float>(frameNumber) /
+                         static_cast<float>(numberOfFrames));
+          currentFrameNumber = frameNumber;
+        }
+        if (type == ReplayCache::MessageType::Event) {
+          m_publisher->sendEventMessage(message);
+        } else {
+          m_publisher->sendSampleEnvMessage(message);
+        }
+      });
+  m_messageID += m_replayCache->getNumberOfEventMessages();
+  return bytesSent;
+}
+
 std::unique_ptr<Timer>
 NexusPublisher::streamHistogramData(const OptionalArgs &settings) {
   std::unique_ptr<Timer> histogramStreamer;
@@ -188,7 +452,9 @@ NexusPublisher::streamHistogramData(const OptionalArgs &settings) {
   // We want to send at least one batch of histogram messages
   numberOfHistogramUpdates = std::max(1, numberOfHistogramUpdates);
 
-  auto histograms = m_fileReader->getHistoData();
+  auto histograms = m_preparedHistograms ? std::move(*m_preparedHistograms)
+                                         : m_fileReader->getHistoData();
+  m_preparedHistograms = nonstd::nullopt;
 
   // If the duration of the run is longer/similar to the specified update period
   // for histogram data, or if slow mode was not selected then we are
@@ -246,10 +512,24 @@ NexusPublisher::streamHistogramData(const OptionalArgs &settings) {
  * @return - size of the buffer
  */
 size_t NexusPublisher::createAndSendMessage(const size_t frameNumber) {
-  auto messageData = createMessageData(frameNumber);
+  if (m_settings.ev44) {
+    return createAndSendBatchedMessages(frameNumber);
+  }
+
+  auto messageData = getMessageData(frameNumber);
   size_t dataSize = 0;
+  if (m_eventFrameSplitter.isEnabled() && messageData.size() > 1) {
+    for (auto &buffer : serialiseEventMessages(messageData, m_messageID,
+                                               m_patchableMessages)) {
+      m_publisher->sendEventMessage(buffer);
+      dataSize += buffer.size();
+    }
+    m_messageID += messageData.size();
+    return dataSize;
+  }
+
   for (auto &message : messageData) {
-    auto buffer = message.getBuffer(m_messageID);
+    auto buffer = message.getBuffer(m_messageID, m_patchableMessages);
     m_publisher->sendEventMessage(buffer);
     ++m_messageID;
     dataSize += buffer.size();
@@ -258,16 +538,78 @@ size_t NexusPublisher::createAndSendMessage(const size_t frameNumber) {
 }
 
 /**
- * Create a flatbuffer payload for sample environment log messages
+ * Add the events of the specified frame to the ev44 batch, publishing the
+ * batch first if the frame is a new pulse outside the batching window or would
+ * take the batch over the maximum number of events. The event data groups of
+ * a frame share its pulse, so they are only split between messages to keep to
+ * the maximum number of events.
+ *
+ * @param frameNumber - the number of the frame for which data will be sent
+ * @return - size of the buffers sent
+ */
+size_t NexusPublisher::createAndSendBatchedMessages(const size_t frameNumber) {
+  const auto batchWindowNs =
+      static_cast<uint64_t>(m_settings.ev44BatchWindowMs) * 1000000ULL;
+  size_t dataSize = 0;
+  for (const auto &eventData : getMessageData(frameNumber)) {
+    if (!m_eventBatch.empty() &&
+        ((eventData.getFrameTime() != m_eventBatch.getLastPulseTime() &&
+          eventData.getFrameTime() >=
+              m_eventBatch.getFirstPulseTime() + batchWindowNs) ||
+         (m_settings.maxEventsPerMessage > 0 &&
+          m_eventBatch.getNumberOfEvents() + eventData.getNumberOfEvents() >
+              m_settings.maxEventsPerMessage))) {
+      dataSize += sendEventBatch();
+    }
+    m_eventBatch.addPulse(eventData.getFrameTime(), eventData.getDetId(),
+                          eventData.getTof());
+  }
+  if (batchWindowNs == 0) {
+    dataSize += sendEventBatch();
+  }
+  return dataSize;
+}
+
+/**
+ * Publish the events waiting in the ev44 batch, if there are any
+ *
+ * @return - size of the buffer sent
+ */
+size_t NexusPublisher::sendEventBatch() {
+  if (m_eventBatch.empty()) {
+    return 0;
+  }
+  auto buffer = m_eventBatch.getBuffer(static_cast<int64_t>(m_messageID),
+                                       m_patchableMessages);
+  m_publisher->sendEventMessage(buffer);
+  ++m_messageID;
+  m_eventBatch.clear();
+  return buffer.size();
+}
+
+/**
+ * Create a flatbuffer payload for sample environment log messages, either one
+ * message per sample or batches of samples from each log
  *
- * @param sampleEnvBuf - a buffer for the message
  * @param frameNumber - the number of the frame for which data will be sent
+ * @return - size of the buffers sent
  */
-void NexusPublisher::createAndSendSampleEnvMessages(const size_t frameNumber) {
-  for (const auto &sEEvent : m_sEEventMap[frameNumber]) {
-    auto buffer = sEEvent->getBuffer();
+size_t
+NexusPublisher::createAndSendSampleEnvMessages(const size_t frameNumber) {
+  const auto samples = m_sampleEnvLogs.getSamplesInFrame(frameNumber);
+  if (m_sampleEnvBatcher != nullptr) {
+    return m_sampleEnvBatcher->addSamples(
+        m_sampleEnvLogs, samples, m_fileReader->getFrameTime(frameNumber),
+        *m_publisher);
+  }
+
+  size_t dataSize = 0;
+  for (const auto &sample : samples) {
+    auto buffer = m_sampleEnvLogs.getBuffer(sample, m_patchableMessages);
     m_publisher->sendSampleEnvMessage(buffer);
+    dataSize += buffer.size();
   }
+  return dataSize;
 }
 
 /**
@@ -281,24 +623,60 @@ size_t
 NexusPublisher::createAndSendRunMessage(const int runNumber,
                                         const std::string &jsonDescription) {
   auto messageData = createRunMessageData(runNumber, jsonDescription);
-
-  // Add detector-spectrum map to message if map file was given and a detector
-  // ID range was not.
-  nonstd::optional<DetectorSpectrumMapData> optionalDetSpecMap =
-      nonstd::nullopt;
-  if (m_settings.minMaxDetectorNums.first == 0 &&
+  const auto detSpecMapSize = sendDetSpecMapIfChanged();
+
+  // Add detector-spectrum map to message if map file was given and a
+  // detector ID range was not. The shared map is only replaced if the file
+  // has changed.
+  std::shared_ptr<const DetectorSpectrumMapData> detSpecMap;
+  if (!m_settings.detSpecMapOnOwnTopic &&
+      m_settings.minMaxDetectorNums.first == 0 &&
       m_settings.minMaxDetectorNums.second == 0 &&
       !m_settings.detSpecFilename.empty()) {
-    optionalDetSpecMap = nonstd::optional<DetectorSpectrumMapData>(
-        DetectorSpectrumMapData(m_detSpecMapFilename));
+    detSpecMap = DetectorSpectrumMapData::loadShared(m_detSpecMapFilename);
   }
 
-  auto message = serialiseRunStartMessage(messageData, optionalDetSpecMap);
+  // The template is built for the first run, which serialises the NeXus
+  // structure and detector-spectrum map, later runs only patch it unless
+  // either has changed
+  if (m_runStartTemplate == nullptr ||
+      messageData.nexusStructure != m_runStartTemplateNexusStructure ||
+      detSpecMap != m_runStartTemplate->getDetSpecMap()) {
+    m_runStartTemplate =
+        std::make_unique<RunStartMessageTemplate>(messageData, detSpecMap);
+    m_runStartTemplateNexusStructure = messageData.nexusStructure;
+  }
+
+  auto message = m_runStartTemplate->createMessage(messageData);
 
   m_publisher->sendRunMessage(message);
   m_logger->info("Publishing new run: {}", messageData);
   m_currentJobID = messageData.jobID;
 
+  return detSpecMapSize + message.size();
+}
+
+/**
+ * If the detector-spectrum map is published on its own topic, publish it if
+ * it has not been published yet or has changed since
+ *
+ * @return - size of the buffer sent, if any
+ */
+size_t NexusPublisher::sendDetSpecMapIfChanged() {
+  if (!m_settings.detSpecMapOnOwnTopic || m_settings.detSpecFilename.empty()) {
+    return 0;
+  }
+  // The shared map is only replaced if the contents of the file have changed
+  const auto detSpecMap =
+      DetectorSpectrumMapData::loadShared(m_detSpecMapFilename);
+  if (detSpecMap == m_publishedDetSpecMap) {
+    return 0;
+  }
+  auto message = detSpecMap->getBuffer();
+  m_publisher->sendDetSpecMessage(message);
+  m_publishedDetSpecMap = detSpecMap;
+  m_logger->info("Published detector-spectrum map with {} entries",
+                 detSpecMap->getNumberOfEntries());
   return message.size();
 }
 
@@ -310,9 +688,8 @@ NexusPublisher::createAndSendRunMessage(const int runNumber,
  */
 size_t NexusPublisher::createAndSendRunStopMessage(const int runNumber) {
   auto runData = RunData();
-  // Flush producer queue to ensure the run stop is after all messages are
-  // published
-  m_publisher->flushSendQueue();
+  // Messages are timestamped when they are sent, so every message of the run
+  // is before this even if it has not been delivered yet
   runData.stopTime = getTimeNowInMilliseconds() + 1;
   // + 1 as we want to include any messages which were sent in the current
   // millisecond
@@ -320,7 +697,9 @@ size_t NexusPublisher::createAndSendRunStopMessage(const int runNumber) {
   runData.jobID = m_currentJobID;
 
   auto message = serialiseRunStopMessage(runData);
-  m_publisher->sendRunMessage(message);
+  // The publisher holds the run stop back until the rest of the run has been
+  // delivered, so streaming the next run does not have to wait for that
+  m_publisher->sendRunStopMessage(message);
   return message.size();
 }
 
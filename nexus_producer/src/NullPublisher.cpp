@@ -0,0 +1,28 @@
+#include "NullPublisher.h"
+#include "../../core/include/Message.h"
+
+void NullPublisher::sendEventMessage(Streamer::Message &message) {
+  count(message);
+  ++m_numberOfEventMessages;
+}
+
+void NullPublisher::sendRunMessage(Streamer::Message &message) {
+  count(message);
+}
+
+void NullPublisher::sendDetSpecMessage(Streamer::Message &message) {
+  count(message);
+}
+
+void NullPublisher::sendSampleEnvMessage(Streamer::Message &message) {
+  count(message);
+}
+
+void NullPublisher::sendHistogramMessage(Streamer::Message &message) {
+  count(message);
+}
+
+void NullPublisher::count(Streamer::Message &message) {
+  ++m_numberOfMessages;
+  m_numberOfBytes += static_cast<int64_t>(message.size());
+}
@@ -0,0 +1,49 @@
+#include "RecordingPublisher.h"
+#include "../../core/include/Message.h"
+
+RecordingPublisher::RecordingPublisher(std::shared_ptr<Publisher> publisher,
+                                       ReplayCache &cache)
+    : m_publisher(std::move(publisher)), m_cache(cache) {}
+
+void RecordingPublisher::setUp(const std::string &broker,
+                               const std::string &instrumentName) {
+  m_publisher->setUp(broker, instrumentName);
+}
+
+void RecordingPublisher::sendEventMessage(Streamer::Message &message) {
+  m_cache.addMessage(m_frameNumber, ReplayCache::MessageType::Event,
+                     reinterpret_cast<const uint8_t *>(message.data()),
+                     message.size());
+  m_publisher->sendEventMessage(message);
+}
+
+void RecordingPublisher::sendSampleEnvMessage(Streamer::Message &message) {
+  m_cache.addMessage(m_frameNumber, ReplayCache::MessageType::SampleEnv,
+                     reinterpret_cast<const uint8_t *>(message.data()),
+                     message.size());
+  m_publisher->sendSampleEnvMessage(message);
+}
+
+/// Run messages are created afresh for every run so are not recorded
+void RecordingPublisher::sendRunMessage(Streamer::Message &message) {
+  m_publisher->sendRunMessage(message);
+}
+
+void RecordingPublisher::sendRunStopMessage(Streamer::Message &message) {
+  m_publisher->sendRunStopMessage(message);
+}
+
+void RecordingPublisher::sendDetSpecMessage(Streamer::Message &message) {
+  m_publisher->sendDetSpecMessage(message);
+}
+
+/// Histograms are published from a timer which is not replayed
+void RecordingPublisher::sendHistogramMessage(Streamer::Message &message) {
+  m_publisher->sendHistogramMessage(message);
+}
+
+void RecordingPublisher::flushSendQueue() { m_publisher->flushSendQueue(); }
+
+int64_t RecordingPublisher::getCurrentOffset() {
+  return m_publisher->getCurrentOffset();
+}
@@ -0,0 +1,165 @@
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/MessagePatching.h"
+#include "ReplayCache.h"
+
+namespace {
+size_t paddedSize(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+void writeAll(int fileDescriptor, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    const auto written = ::write(fileDescriptor, data, size);
+    if (written < 0) {
+      throw std::runtime_error("Failed to write to replay cache spill file");
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+} // namespace
+
+/**
+ * @param memoryBudgetBytes - messages beyond this total size are kept in a
+ * temporary file instead of in memory
+ */
+ReplayCache::ReplayCache(const size_t memoryBudgetBytes)
+    : m_memoryBudgetBytes(memoryBudgetBytes) {}
+
+ReplayCache::~ReplayCache() { discardSpillFile(); }
+
+/**
+ * Discard anything already recorded and start recording a new run
+ *
+ * @param firstFrameTimeNs - time of the first frame of the run
+ * @param firstMessageID - ID of the first event message of the run
+ */
+void ReplayCache::startRecording(const uint64_t firstFrameTimeNs,
+                                 const uint64_t firstMessageID) {
+  discardSpillFile();
+  m_inMemoryMessages.clear();
+  m_inMemoryBytes = 0;
+  m_entries.clear();
+  m_numberOfEventMessages = 0;
+  m_firstFrameTimeNs = firstFrameTimeNs;
+  m_firstMessageID = firstMessageID;
+  m_complete = false;
+}
+
+/**
+ * Keep a copy of a message which has been published
+ *
+ * @param frameNumber - frame which the message was published for
+ * @param type - type of the message
+ * @param data - the serialised message
+ * @param size - size of the message in bytes
+ */
+void ReplayCache::addMessage(const size_t frameNumber, const MessageType type,
+                             const uint8_t *data, const size_t size) {
+  if (m_inMemoryBytes + size <= m_memoryBudgetBytes) {
+    m_entries.push_back(
+        {frameNumber, type, false, m_inMemoryMessages.size(), size});
+    m_inMemoryMessages.emplace_back(data, data + size);
+    m_inMemoryBytes += size;
+  } else {
+    m_entries.push_back({frameNumber, type, true, m_spillFileSize, size});
+    spill(data, size);
+  }
+  if (type == MessageType::Event) {
+    ++m_numberOfEventMessages;
+  }
+}
+
+/**
+ * Append a message to the spill file, creating the file if necessary. Each
+ * message starts on an 8 byte boundary so it can be patched in place.
+ */
+void ReplayCache::spill(const uint8_t *data, const size_t size) {
+  if (m_spillFileDescriptor < 0) {
+    const char *temporaryDirectory = std::getenv("TMPDIR");
+    std::string filename =
+        std::string(temporaryDirectory != nullptr ? temporaryDirectory
+                                                  : "/tmp") +
+        "/nexus-streamer-replay-XXXXXX";
+    m_spillFileDescriptor = mkstemp(&filename[0]);
+    if (m_spillFileDescriptor < 0) {
+      throw std::runtime_error("Failed to create replay cache spill file");
+    }
+    // The file is removed as soon as it is closed
+    unlink(filename.c_str());
+  }
+  writeAll(m_spillFileDescriptor, data, size);
+  const uint8_t padding[8] = {};
+  writeAll(m_spillFileDescriptor, padding, paddedSize(size) - size);
+  m_spillFileSize += paddedSize(size);
+}
+
+/**
+ * Mark the recording as complete, mapping the spill file if messages were
+ * written to it
+ */
+void ReplayCache::finishRecording() {
+  if (m_spillFileSize > 0) {
+    auto mapping = mmap(nullptr, m_spillFileSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, m_spillFileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::runtime_error("Failed to map replay cache spill file");
+    }
+    m_spillMapping = static_cast<uint8_t *>(mapping);
+  }
+  m_complete = true;
+}
+
+/**
+ * Patch the timestamps and message IDs of the cached messages for a new run and
+ * pass each message to the callback. The messages are patched relative to the
+ * values they contain from the previous replay.
+ *
+ * @param firstFrameTimeNs - time of the first frame of the new run
+ * @param firstMessageID - ID to give the first event message of the new run
+ * @param callback - called with each message, the message refers to the cache
+ * so must not be kept after the callback returns
+ * @return - total size of the messages
+ */
+size_t ReplayCache::replay(const uint64_t firstFrameTimeNs,
+                           const uint64_t firstMessageID,
+                           const ReplayCallback &callback) {
+  if (!m_complete) {
+    throw std::runtime_error("Replay cache used before a run was recorded");
+  }
+  const auto timeShiftNs = static_cast<int64_t>(firstFrameTimeNs) -
+                           static_cast<int64_t>(m_firstFrameTimeNs);
+  const auto messageIDShift = static_cast<int64_t>(firstMessageID) -
+                              static_cast<int64_t>(m_firstMessageID);
+
+  size_t totalSize = 0;
+  for (const auto &entry : m_entries) {
+    auto data = entry.spilled ? m_spillMapping + entry.position
+                              : m_inMemoryMessages[entry.position].data();
+    if (timeShiftNs != 0 || messageIDShift != 0) {
+      patchMessage(data, timeShiftNs, messageIDShift);
+    }
+    auto message = Streamer::Message::fromUnownedBuffer(data, entry.size);
+    callback(entry.frameNumber, entry.type, message);
+    totalSize += entry.size;
+  }
+  m_firstFrameTimeNs = firstFrameTimeNs;
+  m_firstMessageID = firstMessageID;
+  return totalSize;
+}
+
+void ReplayCache::discardSpillFile() {
+  if (m_spillMapping != nullptr) {
+    munmap(m_spillMapping, m_spillFileSize);
+    m_spillMapping = nullptr;
+  }
+  if (m_spillFileDescriptor >= 0) {
+    close(m_spillFileDescriptor);
+    m_spillFileDescriptor = -1;
+  }
+  m_spillFileSize = 0;
+}
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <limits>
+
+#include "../../core/include/Message.h"
+#include "SampleEnvBatcher.h"
+
+SampleEnvBatcher::SampleEnvBatcher(const uint32_t maxSamplesPerMessage,
+                                   const uint32_t flushIntervalMs,
+                                   const bool patchableMessages)
+    : m_maxSamplesPerMessage(std::max(1u, maxSamplesPerMessage)),
+      m_flushIntervalNs(static_cast<uint64_t>(flushIntervalMs) * 1000000ULL),
+      m_patchableMessages(patchableMessages) {}
+
+/**
+ * Add samples to the batch for their log, publishing a batch as soon as it is
+ * full and any batches which have been waiting longer than the flush interval
+ *
+ * @param logs - the logs which the samples belong to
+ * @param samples - the samples from a single frame
+ * @param frameTimeNs - time of the frame which the samples belong to
+ * @param publisher - publisher to send the messages with
+ * @return - number of bytes published
+ */
+size_t SampleEnvBatcher::addSamples(const SampleEnvironmentLogs &logs,
+                                    const SampleEnvironmentSampleRange &samples,
+                                    const uint64_t frameTimeNs,
+                                    Publisher &publisher) {
+  if (m_batches.size() < logs.getNumberOfLogs()) {
+    m_batches.resize(logs.getNumberOfLogs());
+  }
+
+  size_t bytesSent = 0;
+  for (const auto &sample : samples) {
+    auto &batch = m_batches[sample.logIndex];
+    if (batch.sampleIndices.empty()) {
+      batch.firstFrameTimeNs = frameTimeNs;
+      if (m_numberOfPendingSamples == 0) {
+        m_oldestFrameTimeNs = frameTimeNs;
+      }
+    }
+    batch.sampleIndices.push_back(sample.sampleIndex);
+    ++m_numberOfPendingSamples;
+    if (batch.sampleIndices.size() >= m_maxSamplesPerMessage) {
+      bytesSent += publishBatch(logs, sample.logIndex, publisher);
+    }
+  }
+
+  if (m_numberOfPendingSamples > 0 &&
+      frameTimeNs >= m_oldestFrameTimeNs + m_flushIntervalNs) {
+    auto oldestRemainingFrameTimeNs = std::numeric_limits<uint64_t>::max();
+    for (uint32_t logIndex = 0; logIndex < m_batches.size(); ++logIndex) {
+      const auto &batch = m_batches[logIndex];
+      if (batch.sampleIndices.empty()) {
+        continue;
+      }
+      if (frameTimeNs >= batch.firstFrameTimeNs + m_flushIntervalNs) {
+        bytesSent += publishBatch(logs, logIndex, publisher);
+      } else {
+        oldestRemainingFrameTimeNs =
+            std::min(oldestRemainingFrameTimeNs, batch.firstFrameTimeNs);
+      }
+    }
+    m_oldestFrameTimeNs = oldestRemainingFrameTimeNs;
+  }
+  return bytesSent;
+}
+
+size_t SampleEnvBatcher::flush(const SampleEnvironmentLogs &logs,
+                               Publisher &publisher) {
+  size_t bytesSent = 0;
+  for (uint32_t logIndex = 0; logIndex < m_batches.size(); ++logIndex) {
+    if (!m_batches[logIndex].sampleIndices.empty()) {
+      bytesSent += publishBatch(logs, logIndex, publisher);
+    }
+  }
+  return bytesSent;
+}
+
+size_t SampleEnvBatcher::publishBatch(const SampleEnvironmentLogs &logs,
+                                      const uint32_t logIndex,
+                                      Publisher &publisher) {
+  auto &batch = m_batches[logIndex];
+  auto message = logs.getBatchBuffer(logIndex, batch.sampleIndices,
+                                     batch.messageCounter++,
+                                     m_patchableMessages);
+  publisher.sendSampleEnvMessage(message);
+  m_numberOfPendingSamples -= batch.sampleIndices.size();
+  batch.sampleIndices.clear();
+  return message.size();
+}
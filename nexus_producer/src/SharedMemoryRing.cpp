@@ -0,0 +1,132 @@
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SharedMemoryRing.h"
+
+namespace SharedMemoryRing {
+
+namespace {
+const char ringMagic[8] = {'N', 'S', 'R', 'I', 'N', 'G', '\0', '\0'};
+const uint32_t ringVersion = 1;
+} // namespace
+
+bool isRingFile(const FileHeader &header) {
+  return std::memcmp(header.magic, ringMagic, sizeof(ringMagic)) == 0 &&
+         header.version == ringVersion &&
+         header.numberOfLanes == numberOfLanes;
+}
+
+void initialiseFileHeader(FileHeader &header, const uint64_t laneCapacity) {
+  std::memcpy(header.magic, ringMagic, sizeof(ringMagic));
+  header.version = ringVersion;
+  header.numberOfLanes = numberOfLanes;
+  header.laneCapacity = laneCapacity;
+}
+
+/**
+ * Attach to a lane of a ring file, reading starts from the next message to be
+ * published
+ *
+ * @param filename - full path of the ring file
+ * @param lane - lane of the topic to read
+ */
+Reader::Reader(const std::string &filename, const Lane lane) {
+  const auto fileDescriptor = open(filename.c_str(), O_RDWR);
+  if (fileDescriptor < 0) {
+    throw std::runtime_error("Failed to open ring file " + filename);
+  }
+  struct stat fileStatus {};
+  if (fstat(fileDescriptor, &fileStatus) != 0 ||
+      static_cast<size_t>(fileStatus.st_size) < laneHeadersOffset) {
+    close(fileDescriptor);
+    throw std::runtime_error(filename + " is not a ring file");
+  }
+  m_mappingSize = static_cast<size_t>(fileStatus.st_size);
+  auto mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Failed to map ring file " + filename);
+  }
+  m_mapping = static_cast<uint8_t *>(mapping);
+
+  const auto header = reinterpret_cast<const FileHeader *>(m_mapping);
+  if (!isRingFile(*header) ||
+      getFileSize(header->laneCapacity) > m_mappingSize) {
+    munmap(m_mapping, m_mappingSize);
+    throw std::runtime_error(filename + " is not a ring file");
+  }
+  m_laneCapacity = header->laneCapacity;
+  const auto laneIndex = static_cast<uint32_t>(lane);
+  m_laneHeader = reinterpret_cast<LaneHeader *>(
+      m_mapping + laneHeadersOffset + laneIndex * sizeof(LaneHeader));
+  m_laneData = m_mapping + getLaneDataOffset(laneIndex, m_laneCapacity);
+
+  for (m_consumerSlot = 0; m_consumerSlot < maxConsumersPerLane;
+       ++m_consumerSlot) {
+    auto expected = noConsumer;
+    m_position = m_laneHeader->committedPosition.load();
+    if (m_laneHeader->consumerCursors[m_consumerSlot].compare_exchange_strong(
+            expected, m_position)) {
+      return;
+    }
+  }
+  munmap(m_mapping, m_mappingSize);
+  throw std::runtime_error("Too many consumers attached to ring file " +
+                           filename);
+}
+
+Reader::~Reader() {
+  // If this consumer was detached another one may have taken the slot since
+  auto position = m_position;
+  m_laneHeader->consumerCursors[m_consumerSlot].compare_exchange_strong(
+      position, noConsumer);
+  munmap(m_mapping, m_mappingSize);
+}
+
+size_t Reader::read(const MessageCallback &callback) {
+  // Throws before reading anything if this consumer has been detached
+  moveCursor(m_position);
+  auto position = m_position;
+  const auto committedPosition =
+      m_laneHeader->committedPosition.load(std::memory_order_acquire);
+
+  size_t numberOfMessages = 0;
+  while (position < committedPosition) {
+    const auto offset = position % m_laneCapacity;
+    const auto record =
+        reinterpret_cast<const RecordHeader *>(m_laneData + offset);
+    if (record->size == wrapMarker) {
+      position += m_laneCapacity - offset;
+      continue;
+    }
+    callback(m_laneData + offset + sizeof(RecordHeader), record->size);
+    position += sizeof(RecordHeader) + paddedSize(record->size);
+    // Only now can the publisher reuse the space
+    moveCursor(position);
+    ++numberOfMessages;
+  }
+  moveCursor(position);
+  return numberOfMessages;
+}
+
+/**
+ * Let the publisher know that everything before a position has been read
+ *
+ * @param position - the new position of the cursor
+ */
+void Reader::moveCursor(const uint64_t position) {
+  auto expected = m_position;
+  if (!m_laneHeader->consumerCursors[m_consumerSlot].compare_exchange_strong(
+          expected, position, std::memory_order_release,
+          std::memory_order_relaxed)) {
+    throw std::runtime_error(
+        "Consumer was detached from the ring file as it stopped reading");
+  }
+  m_position = position;
+}
+} // namespace SharedMemoryRing
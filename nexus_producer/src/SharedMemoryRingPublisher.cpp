@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../../core/include/Message.h"
+#include "SharedMemoryRingPublisher.h"
+
+using namespace SharedMemoryRing;
+
+/**
+ * Create a ring file, any existing file is replaced, consumers which are still
+ * attached to it keep reading the old file
+ *
+ * @param filename - full path of the ring file, for example in /dev/shm
+ * @param laneCapacityBytes - size of the ring buffer of each topic
+ * @param consumerTimeout - how long to wait for a consumer which is not
+ * reading before detaching it
+ */
+SharedMemoryRingPublisher::SharedMemoryRingPublisher(
+    std::string filename, const uint64_t laneCapacityBytes,
+    const std::chrono::milliseconds consumerTimeout)
+    : m_filename(std::move(filename)),
+      m_laneCapacity(paddedSize(laneCapacityBytes)),
+      m_consumerTimeout(consumerTimeout) {
+  unlink(m_filename.c_str());
+  const auto fileDescriptor =
+      open(m_filename.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+  if (fileDescriptor < 0) {
+    throw std::runtime_error("Failed to create ring file " + m_filename);
+  }
+  m_mappingSize = getFileSize(m_laneCapacity);
+  if (ftruncate(fileDescriptor, static_cast<off_t>(m_mappingSize)) != 0) {
+    close(fileDescriptor);
+    throw std::runtime_error("Failed to allocate ring file " + m_filename);
+  }
+  auto mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Failed to map ring file " + m_filename);
+  }
+  m_mapping = static_cast<uint8_t *>(mapping);
+
+  for (uint32_t laneIndex = 0; laneIndex < numberOfLanes; ++laneIndex) {
+    auto laneHeader = new (m_mapping + laneHeadersOffset +
+                           laneIndex * sizeof(LaneHeader)) LaneHeader;
+    laneHeader->reservedPosition.store(0);
+    laneHeader->committedPosition.store(0);
+    for (auto &cursor : laneHeader->consumerCursors) {
+      cursor.store(noConsumer);
+    }
+  }
+  // Consumers check the header, so write it once the lanes are ready
+  std::atomic_thread_fence(std::memory_order_release);
+  initialiseFileHeader(*reinterpret_cast<FileHeader *>(m_mapping),
+                       m_laneCapacity);
+}
+
+SharedMemoryRingPublisher::~SharedMemoryRingPublisher() {
+  munmap(m_mapping, m_mappingSize);
+}
+
+/// Nothing to set up as the ring file is created by the constructor
+void SharedMemoryRingPublisher::setUp(const std::string &,
+                                      const std::string &) {}
+
+void SharedMemoryRingPublisher::sendEventMessage(Streamer::Message &message) {
+  write(Lane::Event, message);
+  ++m_numberOfEventMessages;
+}
+
+void SharedMemoryRingPublisher::sendRunMessage(Streamer::Message &message) {
+  write(Lane::RunInfo, message);
+}
+
+void SharedMemoryRingPublisher::sendDetSpecMessage(
+    Streamer::Message &message) {
+  write(Lane::DetSpecMap, message);
+}
+
+void SharedMemoryRingPublisher::sendSampleEnvMessage(
+    Streamer::Message &message) {
+  write(Lane::SampleEnv, message);
+}
+
+void SharedMemoryRingPublisher::sendHistogramMessage(
+    Streamer::Message &message) {
+  write(Lane::Histogram, message);
+}
+
+/**
+ * Reserve space in the lane, copy the message in and make it visible to
+ * consumers once all messages reserved before it are visible
+ *
+ * @param lane - lane of the topic to publish to
+ * @param message - the message to publish
+ */
+void SharedMemoryRingPublisher::write(const Lane lane,
+                                      Streamer::Message &message) {
+  const auto recordSize = sizeof(RecordHeader) + paddedSize(message.size());
+  // A larger message could overwrite the wrap marker in front of it
+  if (recordSize > m_laneCapacity / 2) {
+    throw std::runtime_error("Message of " + std::to_string(message.size()) +
+                             " bytes is larger than half a ring file lane");
+  }
+  const auto laneIndex = static_cast<uint32_t>(lane);
+  auto &laneHeader = *reinterpret_cast<LaneHeader *>(
+      m_mapping + laneHeadersOffset + laneIndex * sizeof(LaneHeader));
+  auto laneData = m_mapping + getLaneDataOffset(laneIndex, m_laneCapacity);
+
+  // Messages are not split over the end of the buffer, skip to the start if
+  // the message does not fit
+  auto start = laneHeader.reservedPosition.load();
+  uint64_t recordStart;
+  uint64_t end;
+  do {
+    const auto offset = start % m_laneCapacity;
+    recordStart = offset + recordSize > m_laneCapacity
+                      ? start + (m_laneCapacity - offset)
+                      : start;
+    end = recordStart + recordSize;
+  } while (!laneHeader.reservedPosition.compare_exchange_weak(start, end));
+
+  waitForConsumers(laneHeader, laneIndex, end);
+
+  if (recordStart != start) {
+    reinterpret_cast<RecordHeader *>(laneData + start % m_laneCapacity)->size =
+        wrapMarker;
+  }
+  auto record = laneData + recordStart % m_laneCapacity;
+  RecordHeader header{static_cast<uint32_t>(message.size()), 0};
+  std::memcpy(record, &header, sizeof(header));
+  std::memcpy(record + sizeof(header), message.data(), message.size());
+
+  // Messages become visible in the order they were reserved
+  while (laneHeader.committedPosition.load(std::memory_order_acquire) !=
+         start) {
+    std::this_thread::yield();
+  }
+  laneHeader.committedPosition.store(end, std::memory_order_release);
+}
+
+/**
+ * Wait until every consumer has read what is about to be overwritten. If the
+ * slowest consumer does not move for the consumer timeout, the consumers which
+ * are in the way are assumed to have died or hung and are detached.
+ *
+ * @param laneHeader - header of the lane being written to
+ * @param laneIndex - index of the lane, for logging
+ * @param end - end of the record which is about to be written
+ */
+void SharedMemoryRingPublisher::waitForConsumers(LaneHeader &laneHeader,
+                                                 const uint32_t laneIndex,
+                                                 const uint64_t end) {
+  auto slowestPosition = getSlowestConsumerPosition(laneHeader);
+  auto lastProgressTime = std::chrono::steady_clock::now();
+  while (slowestPosition != noConsumer &&
+         end - slowestPosition > m_laneCapacity) {
+    std::this_thread::yield();
+    auto position = getSlowestConsumerPosition(laneHeader);
+    const auto now = std::chrono::steady_clock::now();
+    if (position != slowestPosition) {
+      lastProgressTime = now;
+    } else if (now - lastProgressTime > m_consumerTimeout) {
+      detachStalledConsumers(laneHeader, laneIndex, end);
+      position = getSlowestConsumerPosition(laneHeader);
+      lastProgressTime = now;
+    }
+    slowestPosition = position;
+  }
+}
+
+/**
+ * Detach every consumer which has not read what is about to be overwritten,
+ * the consumer finds out the next time it reads
+ *
+ * @param laneHeader - header of the lane being written to
+ * @param laneIndex - index of the lane, for logging
+ * @param end - end of the record which is about to be written
+ */
+void SharedMemoryRingPublisher::detachStalledConsumers(LaneHeader &laneHeader,
+                                                       const uint32_t laneIndex,
+                                                       const uint64_t end) {
+  for (uint32_t slot = 0; slot < maxConsumersPerLane; ++slot) {
+    auto position = laneHeader.consumerCursors[slot].load();
+    // The cursor is only cleared if the consumer has not moved it since
+    if (position != noConsumer && end - position > m_laneCapacity &&
+        laneHeader.consumerCursors[slot].compare_exchange_strong(position,
+                                                                 noConsumer)) {
+      m_logger->warn("Detached consumer {} of ring file {} lane {}, it has not "
+                     "read anything for {} ms",
+                     slot, m_filename, laneIndex, m_consumerTimeout.count());
+    }
+  }
+}
+
+/**
+ * @return - read cursor of the consumer furthest behind, or noConsumer if no
+ * consumers are attached
+ */
+uint64_t SharedMemoryRingPublisher::getSlowestConsumerPosition(
+    const LaneHeader &laneHeader) const {
+  auto slowestPosition = noConsumer;
+  for (const auto &cursor : laneHeader.consumerCursors) {
+    const auto position = cursor.load(std::memory_order_acquire);
+    slowestPosition = std::min(slowestPosition, position);
+  }
+  return slowestPosition;
+}
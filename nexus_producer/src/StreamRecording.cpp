@@ -0,0 +1,320 @@
+#include <6s4t_run_stop_generated.h>
+#include <cstring>
+#include <fcntl.h>
+#include <pl72_run_start_generated.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/DetectorSpectrumMapData.h"
+#include "../../serialisation/include/MessagePatching.h"
+#include "../../serialisation/include/RunData.h"
+#include "StreamRecording.h"
+
+namespace {
+const char recordingMagic[8] = {'N', 'S', 'R', 'E', 'C', '\0', '\0', '\0'};
+// Version 1 recorded run stop messages as run messages
+const uint32_t recordingVersion = 2;
+
+/// Start of the recording file, followed by the messages
+struct RecordingHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+/// Precedes each message, the message is padded to a multiple of 8 bytes so
+/// that every record header and message is 8 byte aligned
+struct RecordHeader {
+  uint64_t relativeTimeNs;
+  uint32_t size;
+  RecordedTopic topic;
+  uint8_t reserved[3];
+};
+
+size_t paddedSize(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+uint64_t getTimeNowInMilliseconds() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+uint64_t shiftTime(uint64_t timeMs, int64_t timeShiftMs) {
+  return timeMs == 0 ? 0 : static_cast<uint64_t>(timeMs + timeShiftMs);
+}
+
+/// Give the file a name of its own for each replay, keeping the extension
+std::string addSuffix(const std::string &filename, const std::string &suffix) {
+  const auto extension = filename.rfind('.');
+  if (extension == std::string::npos ||
+      (filename.rfind('/') != std::string::npos &&
+       filename.rfind('/') > extension)) {
+    return filename + suffix;
+  }
+  return filename.substr(0, extension) + suffix + filename.substr(extension);
+}
+
+/**
+ * Serialise a recorded run start or stop message again as a new run
+ *
+ * @param recordedMessage - the run message from the recording
+ * @param timeShiftMs - amount to shift the start and stop times by
+ * @param jobID - job ID of the new run
+ * @param suffix - appended to the run name and filename
+ * @return - the new run message
+ */
+Streamer::Message recreateRunMessage(const uint8_t *recordedMessage,
+                                     const int64_t timeShiftMs,
+                                     const std::string &jobID,
+                                     const std::string &suffix) {
+  if (flatbuffers::BufferHasIdentifier(recordedMessage,
+                                       RunStopIdentifier())) {
+    auto runData = deserialiseRunStopMessage(recordedMessage);
+    runData.stopTime = shiftTime(runData.stopTime, timeShiftMs);
+    runData.runID += suffix;
+    runData.jobID = jobID;
+    return serialiseRunStopMessage(runData);
+  }
+  auto runData = deserialiseRunStartMessage(recordedMessage);
+  runData.startTime = shiftTime(runData.startTime, timeShiftMs);
+  runData.stopTime = shiftTime(runData.stopTime, timeShiftMs);
+  runData.runID += suffix;
+  runData.jobID = jobID;
+  runData.filename = addSuffix(runData.filename, suffix);
+  nonstd::optional<DetectorSpectrumMapData> detSpecMap;
+  const auto recordedMap =
+      GetRunStart(recordedMessage)->detector_spectrum_map();
+  if (recordedMap != nullptr) {
+    detSpecMap = DetectorSpectrumMapData(recordedMap);
+  }
+  return serialiseRunStartMessage(runData, detSpecMap);
+}
+} // namespace
+
+/**
+ * Create a recording file, replacing any existing file
+ *
+ * @param filename - full path of the recording file
+ */
+StreamRecorder::StreamRecorder(const std::string &filename)
+    : m_file(filename, std::ios::binary | std::ios::trunc),
+      m_startTime(std::chrono::steady_clock::now()) {
+  if (!m_file) {
+    throw std::runtime_error("Failed to create stream recording file " +
+                             filename);
+  }
+  RecordingHeader header{};
+  std::memcpy(header.magic, recordingMagic, sizeof(recordingMagic));
+  header.version = recordingVersion;
+  m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+/// Nothing to set up as the topic names are decided when replaying
+void StreamRecorder::setUp(const std::string &, const std::string &) {}
+
+void StreamRecorder::sendEventMessage(Streamer::Message &message) {
+  writeMessage(message, RecordedTopic::Event);
+}
+
+void StreamRecorder::sendRunMessage(Streamer::Message &message) {
+  writeMessage(message, RecordedTopic::RunInfo);
+}
+
+void StreamRecorder::sendRunStopMessage(Streamer::Message &message) {
+  writeMessage(message, RecordedTopic::RunStop);
+}
+
+void StreamRecorder::sendDetSpecMessage(Streamer::Message &message) {
+  writeMessage(message, RecordedTopic::DetSpecMap);
+}
+
+void StreamRecorder::sendSampleEnvMessage(Streamer::Message &message) {
+  writeMessage(message, RecordedTopic::SampleEnv);
+}
+
+void StreamRecorder::sendHistogramMessage(Streamer::Message &message) {
+  writeMessage(message, RecordedTopic::Histogram);
+}
+
+void StreamRecorder::flushSendQueue() {
+  std::lock_guard<std::mutex> lock(m_fileMutex);
+  m_file.flush();
+}
+
+int64_t StreamRecorder::getCurrentOffset() { return 0; }
+
+void StreamRecorder::writeMessage(Streamer::Message &message,
+                                  const RecordedTopic topic) {
+  RecordHeader header{};
+  header.relativeTimeNs = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - m_startTime)
+          .count());
+  header.size = static_cast<uint32_t>(message.size());
+  header.topic = topic;
+
+  const char padding[8] = {};
+  std::lock_guard<std::mutex> lock(m_fileMutex);
+  m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_file.write(message.data(), message.size());
+  m_file.write(padding, paddedSize(message.size()) - message.size());
+  if (!m_file) {
+    throw std::runtime_error("Failed to write to stream recording file");
+  }
+}
+
+/**
+ * Memory map a recording file and check it is complete
+ *
+ * @param filename - full path of the recording file
+ */
+StreamRecording::StreamRecording(const std::string &filename) {
+  const auto fileDescriptor = open(filename.c_str(), O_RDONLY);
+  if (fileDescriptor < 0) {
+    throw std::runtime_error("Failed to open stream recording file " +
+                             filename);
+  }
+  struct stat fileStatus {};
+  if (fstat(fileDescriptor, &fileStatus) != 0 ||
+      static_cast<size_t>(fileStatus.st_size) < sizeof(RecordingHeader)) {
+    close(fileDescriptor);
+    throw std::runtime_error("Stream recording file " + filename +
+                             " is too short");
+  }
+  m_mappingSize = static_cast<size_t>(fileStatus.st_size);
+  // Timestamps are patched in a private copy of the pages, the file itself is
+  // never written
+  auto mapping = mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fileDescriptor, 0);
+  // The mapping remains valid after the file is closed
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Failed to map stream recording file " +
+                             filename);
+  }
+  m_mapping = static_cast<uint8_t *>(mapping);
+  // Messages are read in order
+  madvise(mapping, m_mappingSize, MADV_SEQUENTIAL);
+
+  const auto header = reinterpret_cast<const RecordingHeader *>(m_mapping);
+  if (std::memcmp(header->magic, recordingMagic, sizeof(recordingMagic)) !=
+          0 ||
+      header->version != recordingVersion) {
+    munmap(mapping, m_mappingSize);
+    throw std::runtime_error(filename + " is not a stream recording file");
+  }
+
+  // Count the complete records, a recording which was interrupted can end
+  // part way through a record
+  size_t position = sizeof(RecordingHeader);
+  while (position + sizeof(RecordHeader) <= m_mappingSize) {
+    const auto record =
+        reinterpret_cast<const RecordHeader *>(m_mapping + position);
+    const auto recordSize = sizeof(RecordHeader) + paddedSize(record->size);
+    if (position + recordSize > m_mappingSize) {
+      break;
+    }
+    const auto message = m_mapping + position + sizeof(RecordHeader);
+    if (record->topic == RecordedTopic::Event) {
+      ++m_numberOfEventMessages;
+    } else if (record->topic == RecordedTopic::RunInfo &&
+               m_recordedStartTimeMs == 0 &&
+               flatbuffers::BufferHasIdentifier(message,
+                                                RunStartIdentifier())) {
+      m_recordedStartTimeMs = GetRunStart(message)->start_time();
+    }
+    position += recordSize;
+    ++m_numberOfMessages;
+  }
+}
+
+StreamRecording::~StreamRecording() {
+  if (m_mapping != nullptr) {
+    munmap(m_mapping, m_mappingSize);
+  }
+}
+
+/**
+ * Publish every message in the recording to the topic it was recorded for, as
+ * a new run which starts now. Run messages are created again with a new job
+ * ID, and the run name and filename are given a suffix with the number of the
+ * replay. Pulse and log times are shifted by as much as the run start time and
+ * event message IDs continue from those of the previous replay.
+ *
+ * @param publisher - publisher to send the messages with
+ * @param realTime - if true, publish each message at the same time after the
+ * start of the replay as it was published after the start of the recording
+ * @return - total size of the messages
+ */
+size_t StreamRecording::replay(Publisher &publisher, const bool realTime) {
+  const auto startTime = std::chrono::steady_clock::now();
+  int64_t timeShiftMs = 0;
+  if (m_recordedStartTimeMs != 0) {
+    timeShiftMs = static_cast<int64_t>(getTimeNowInMilliseconds()) -
+                  static_cast<int64_t>(m_recordedStartTimeMs);
+  }
+  // The mapping contains the timestamps of the previous replay
+  const auto timeShiftNs = timeShiftMs * 1000000 - m_timeShiftNs;
+  const auto messageIDShift =
+      m_numberOfReplays > 0 ? static_cast<int64_t>(m_numberOfEventMessages) : 0;
+  m_timeShiftNs = timeShiftMs * 1000000;
+  ++m_numberOfReplays;
+  const auto jobID = generate_uuid(18);
+  const auto suffix = "_replay" + std::to_string(m_numberOfReplays);
+  m_runMessages.clear();
+
+  size_t totalSize = 0;
+  size_t position = sizeof(RecordingHeader);
+  for (uint64_t messageNumber = 0; messageNumber < m_numberOfMessages;
+       ++messageNumber) {
+    const auto record =
+        reinterpret_cast<const RecordHeader *>(m_mapping + position);
+    position += sizeof(RecordHeader);
+    if (realTime) {
+      std::this_thread::sleep_until(
+          startTime + std::chrono::nanoseconds(record->relativeTimeNs));
+    }
+
+    const auto data = m_mapping + position;
+    auto recordedMessage =
+        Streamer::Message::fromUnownedBuffer(data, record->size);
+    const auto isRunMessage =
+        flatbuffers::BufferHasIdentifier(data, RunStartIdentifier()) ||
+        flatbuffers::BufferHasIdentifier(data, RunStopIdentifier());
+    if (isRunMessage) {
+      m_runMessages.push_back(
+          recreateRunMessage(data, timeShiftMs, jobID, suffix));
+    } else if (timeShiftNs != 0 || messageIDShift != 0) {
+      patchMessage(data, timeShiftNs, messageIDShift);
+    }
+    auto &message = isRunMessage ? m_runMessages.back() : recordedMessage;
+    switch (record->topic) {
+    case RecordedTopic::Event:
+      publisher.sendEventMessage(message);
+      break;
+    case RecordedTopic::RunInfo:
+      publisher.sendRunMessage(message);
+      break;
+    case RecordedTopic::RunStop:
+      publisher.sendRunStopMessage(message);
+      break;
+    case RecordedTopic::DetSpecMap:
+      publisher.sendDetSpecMessage(message);
+      break;
+    case RecordedTopic::SampleEnv:
+      publisher.sendSampleEnvMessage(message);
+      break;
+    case RecordedTopic::Histogram:
+      publisher.sendHistogramMessage(message);
+      break;
+    }
+    position += paddedSize(record->size);
+    totalSize += message.size();
+  }
+  return totalSize;
+}
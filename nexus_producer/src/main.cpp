@@ -1,4 +1,5 @@
 #include <CLI/CLI.hpp>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -6,10 +7,16 @@
 
 #include "../../core/include/OptionalArgs.h"
 #include "../../nexus_file_reader/include/NexusFileReader.h"
+#include "../../nexus_file_reader/include/SyntheticFileReader.h"
 #include "../../serialisation/include/DetectorSpectrumMapData.h"
+#include "EventAmplifier.h"
+#include "FilePublisher.h"
 #include "JSONDescriptionLoader.h"
 #include "KafkaPublisher.h"
 #include "NexusPublisher.h"
+#include "NullPublisher.h"
+#include "SharedMemoryRingPublisher.h"
+#include "StreamRecording.h"
 #include "Version.h"
 
 uint64_t getTimeNowNanosecondsFromEpoch() {
@@ -31,9 +38,12 @@ std::vector<int32_t> getDetectorNumbers(const OptionalArgs &settings) {
     std::iota(detectorNumbers.begin(), detectorNumbers.end(),
               settings.minMaxDetectorNums.first);
   } else if (!settings.detSpecFilename.empty()) {
-    auto detSpecMap = DetectorSpectrumMapData(settings.detSpecFilename);
-    detectorNumbers = detSpecMap.getDetectors();
-  } else if (settings.fakeEventsPerPulse != 0) {
+    // The map is shared with the streamer, which puts it in the run start
+    detectorNumbers =
+        DetectorSpectrumMapData::loadShared(settings.detSpecFilename)
+            ->getDetectors();
+  } else if (settings.fakeEventsPerPulse != 0 &&
+             settings.fakeEventSampling == "uniform") {
     throw std::runtime_error("Generating fake events without giving detector "
                              "ID range or detector-spectrum map file is not "
                              "yet implemented. Please create an issue on "
@@ -55,6 +65,35 @@ std::string getJsonDescription(const OptionalArgs &settings,
   return jsonDescription;
 }
 
+std::shared_ptr<Publisher> createPublisher(const OptionalArgs &settings) {
+  if (!settings.recordFilename.empty()) {
+    return std::make_shared<StreamRecorder>(settings.recordFilename);
+  }
+  if (settings.publisherType == "file") {
+    return std::make_shared<FilePublisher>(settings.outputDirectory);
+  }
+  if (settings.publisherType == "null") {
+    return std::make_shared<NullPublisher>();
+  }
+  if (settings.publisherType == "shm") {
+    const auto ringFilename =
+        settings.ringFilename.empty()
+            ? "/dev/shm/" + settings.instrumentName + "_ring"
+            : settings.ringFilename;
+    return std::make_shared<SharedMemoryRingPublisher>(
+        ringFilename, uint64_t{settings.ringLaneSizeMB} * 1024 * 1024,
+        std::chrono::milliseconds(settings.ringConsumerTimeoutMs));
+  }
+  auto kafkaPublisher = std::make_shared<KafkaPublisher>(settings.compression);
+  for (const auto &option : settings.topicProducerOptions) {
+    kafkaPublisher->setTopicConfigOption(
+        KafkaPublisher::parseTopicConfigOption(option));
+  }
+  // Recordings are published straight from the mapped file
+  kafkaPublisher->setCopyPayloads(settings.replayFilename.empty());
+  return kafkaPublisher;
+}
+
 int main(int argc, char **argv) {
 
   CLI::App App{"Stream neutron detection event and sample environment data "
@@ -64,29 +103,116 @@ int main(int argc, char **argv) {
   bool printVersion{false};
 
   App.add_flag("--version", printVersion, "Print application version and exit");
-  App.add_option("-f,--filename", settings.filename,
-                 "Full path of the NeXus file")
-      ->check(CLI::ExistingFile)
-      ->required();
-  App.add_option("-d,--det-spec-map", settings.detSpecFilename,
-                 "Full path of the detector-spectrum map")
-      ->check(CLI::ExistingFile);
+  auto filenameOption =
+      App.add_option("-f,--filename", settings.filename,
+                     "Full path of the NeXus file, required unless --replay "
+                     "or --synthetic-pulse-rate is given")
+          ->check(CLI::ExistingFile);
+  auto detSpecMapOption =
+      App.add_option("-d,--det-spec-map", settings.detSpecFilename,
+                     "Full path of the detector-spectrum map")
+          ->check(CLI::ExistingFile);
+  App.add_flag("--det-spec-map-topic", settings.detSpecMapOnOwnTopic,
+               "Publish the detector-spectrum map to its own topic when it "
+               "changes, instead of in every run start message")
+      ->needs(detSpecMapOption);
   App.add_option("-b,--broker", settings.broker,
-                 "Hostname or IP of Kafka broker")
-      ->required();
+                 "Hostname or IP of Kafka broker, required unless --record or "
+                 "a publisher other than kafka is given");
   App.add_option("-i,--instrument", settings.instrumentName,
                  "Used as prefix for topic names")
       ->required();
   App.add_option("-m,--compression", settings.compression,
                  "Compression option for Kafka messages");
+  App.add_option("--topic-producer-option", settings.topicProducerOptions,
+                 "Kafka producer property for a single topic, given as "
+                 "TOPIC:NAME=VALUE where TOPIC is events, runInfo, sampleEnv, "
+                 "histograms or detSpecMap, for example events:linger.ms=100, "
+                 "topics with the same properties share a producer, can be "
+                 "given more than once");
   App.add_option("-e,--fake-events-per-pulse", settings.fakeEventsPerPulse,
                  "Generates this number of fake events per pulse per "
                  "NXevent_data instead of "
                  "publishing real data from file");
+  App.add_option("--fake-event-seed", settings.fakeEventSeed,
+                 "Seed for generating fake events, the same seed gives the "
+                 "same events, default 0");
+  App.add_option("--fake-event-sampling", settings.fakeEventSampling,
+                 "How fake detector IDs and times of flight are chosen: "
+                 "uniform, events (sampled from the event data in the file) "
+                 "or histogram (sampled from the NXdata histograms in the "
+                 "file), default uniform")
+      ->check(CLI::IsMember({"uniform", "events", "histogram"}));
+  App.add_option("--synthetic-pulse-rate", settings.syntheticPulseRateHz,
+                 "Generate an endless train of pulses at this frequency (in "
+                 "Hz, for example 14 or 50) instead of reading a NeXus file, "
+                 "requires --fake-events-per-pulse, pulses are only published "
+                 "at this rate with --slow")
+      ->check(CLI::PositiveNumber)
+      ->excludes(filenameOption);
+  App.add_option("--synthetic-run-duration", settings.syntheticRunDurationS,
+                 "Length of each run (in integer seconds) with "
+                 "--synthetic-pulse-rate, default 0 means runs never end");
+  App.add_option("--synthetic-event-distribution",
+                 settings.syntheticEventDistribution,
+                 "Number of events in each pulse with --synthetic-pulse-rate: "
+                 "constant (always --fake-events-per-pulse) or poisson (with "
+                 "mean --fake-events-per-pulse), default poisson")
+      ->check(CLI::IsMember({"constant", "poisson"}));
+  App.add_option("--amplify", settings.amplificationFactor,
+                 "Publish this many copies of each event, with the detector "
+                 "IDs of each copy moved to its own range, to simulate a "
+                 "larger detector, default 1 means no copies")
+      ->check(CLI::Range(1u, 1000u));
+  App.add_option("--amplify-detector-offset",
+                 settings.amplificationDetectorIDOffset,
+                 "Added to the detector IDs of each copy of the events with "
+                 "--amplify, default 0 means one more than the largest "
+                 "detector number from --disable-map or --det-spec-map");
+  App.add_option("--amplify-tof-jitter",
+                 settings.amplificationTimeOfFlightJitterNs,
+                 "Shift the time of flight of each copy of an event by a "
+                 "random amount of up to this many nanoseconds either way, "
+                 "seeded by --fake-event-seed, default 0");
   App.add_option("--histogram-update-period", settings.histogramUpdatePeriodMs,
                  "Publish a histogram data message with this period (in "
                  "integer milliseconds) default 0 means do not stream "
                  "histograms");
+  App.add_option("--max-events-per-message", settings.maxEventsPerMessage,
+                 "Split the events of a frame into messages of at most this "
+                 "many events, default 0 means no limit");
+  App.add_option("--split-detector-ids", settings.splitDetectorIDs,
+                 "Comma separated, increasing detector IDs at which to start "
+                 "a new event message, so that each message only contains "
+                 "events from one detector ID range")
+      ->delimiter(',');
+  App.add_flag("--ev44", settings.ev44,
+               "Publish events as ev44 messages, which can contain events "
+               "from several pulses, instead of ev42 messages");
+  App.add_option("--ev44-batch-window", settings.ev44BatchWindowMs,
+                 "Publish events from all pulses within this time (in integer "
+                 "milliseconds of pulse time) in one ev44 message, default 0 "
+                 "means one message per pulse");
+  App.add_option("--replay-cache-size", settings.replayCacheSizeMB,
+                 "Keep the messages of the first run in a cache of this size "
+                 "(in MB, larger runs spill to a temporary file) and publish "
+                 "later runs from it without reading the file again, default "
+                 "0 means do not cache");
+  App.add_option("--sample-env-batch-size", settings.sampleEnvBatchSize,
+                 "Publish sample environment logs as array-valued se00 "
+                 "messages of up to this many samples, default 0 means "
+                 "publish one f142 message per sample");
+  App.add_option("--sample-env-batch-interval",
+                 settings.sampleEnvBatchIntervalMs,
+                 "Maximum time (in integer milliseconds of pulse time) a "
+                 "sample waits in a batch before it is published, only used "
+                 "with --sample-env-batch-size, default 1000");
+  App.add_option("--log-filter", settings.logFilters,
+                 "Reduce the samples published from NXlogs whose name "
+                 "matches PATTERN (* and ? wildcards), given as "
+                 "PATTERN:deadband=X,rel-deadband=X,min-interval=X,every=N "
+                 "where each threshold is optional, the first matching "
+                 "filter is used, can be given more than once");
   App.add_option("--json-description", settings.jsonDescription,
                  "Optionally provide the path to a file containing a json "
                  "description of the NeXus file, "
@@ -113,9 +239,48 @@ int main(int argc, char **argv) {
   App.add_flag("-s,--slow", settings.slow,
                "Publish data at approx realistic rate (detected from file)");
   App.add_flag("-q,--quiet", settings.quietMode, "Less chatty on stdout");
+  App.add_flag("--merge-groups", settings.mergeGroups,
+               "Publish the events from all NXevent_data groups in a frame "
+               "as a single message instead of one message per group");
+  App.add_option("--publisher", settings.publisherType,
+                 "Where to publish messages: kafka, file (one file per topic "
+                 "in --output-directory), null (discard, for measuring "
+                 "throughput) or shm (shared memory ring file for consumers "
+                 "on the same host), default kafka")
+      ->check(CLI::IsMember({"kafka", "file", "null", "shm"}));
+  App.add_option("--output-directory", settings.outputDirectory,
+                 "Directory to write topic files to with --publisher file, "
+                 "default is the working directory")
+      ->check(CLI::ExistingDirectory);
+  App.add_option("--ring-file", settings.ringFilename,
+                 "Ring file to publish to with --publisher shm, default is "
+                 "/dev/shm/<instrument>_ring");
+  App.add_option("--ring-lane-size", settings.ringLaneSizeMB,
+                 "Size in MB of the ring buffer for each topic with "
+                 "--publisher shm, default 64")
+      ->check(CLI::Range(1u, 2048u));
+  App.add_option("--ring-consumer-timeout", settings.ringConsumerTimeoutMs,
+                 "Time in milliseconds to wait for a ring file consumer which "
+                 "has stopped reading before detaching it, default 5000");
+  auto recordOption = App.add_option(
+      "--record", settings.recordFilename,
+      "Write the messages of a single run to this stream recording file "
+      "instead of publishing them");
+  App.add_option("--replay", settings.replayFilename,
+                 "Publish the messages from this stream recording file "
+                 "instead of reading a NeXus file")
+      ->check(CLI::ExistingFile)
+      ->excludes(filenameOption)
+      ->excludes(recordOption);
+  App.add_flag("--sidecar-index", settings.useSidecarIndex,
+               "Write an index file next to the NeXus file on first use and "
+               "read it on later runs for faster start up");
   App.add_flag(
       "-z,--single-run", settings.singleRun,
       "Publish only a single run (otherwise repeats until interrupted)");
+  App.add_option("--run-pause", settings.runPauseMs,
+                 "Time in milliseconds from the end of one run to the start "
+                 "of the next, unless --single-run is given, default 2000");
   App.set_config("-c,--config-file", "", "Read configuration from an ini file",
                  false);
 
@@ -132,16 +297,89 @@ int main(int argc, char **argv) {
   App.clear();
 
   CLI11_PARSE(App, argc, argv);
+  const bool synthetic = settings.syntheticPulseRateHz > 0;
+  if (settings.filename.empty() && settings.replayFilename.empty() &&
+      !synthetic) {
+    return App.exit(CLI::RequiredError("--filename"));
+  }
+  if (synthetic && settings.fakeEventsPerPulse <= 0) {
+    return App.exit(CLI::RequiredError("--fake-events-per-pulse"));
+  }
+  if (settings.broker.empty() && settings.recordFilename.empty() &&
+      settings.publisherType == "kafka") {
+    return App.exit(CLI::RequiredError("--broker"));
+  }
+  for (const auto &option : settings.topicProducerOptions) {
+    try {
+      KafkaPublisher::parseTopicConfigOption(option);
+    } catch (const std::runtime_error &error) {
+      return App.exit(
+          CLI::ValidationError("--topic-producer-option", error.what()));
+    }
+  }
+  for (const auto &filterSpec : settings.logFilters) {
+    try {
+      LogFilter::parseFilterSpec(filterSpec);
+    } catch (const std::runtime_error &error) {
+      return App.exit(CLI::ValidationError("--log-filter", error.what()));
+    }
+  }
 
   auto logger = spdlog::stderr_color_mt("LOG");
   logger->info("Launched NeXus-Streamer version: {}", GetVersion());
 
+  if (!settings.replayFilename.empty()) {
+    auto publisher = createPublisher(settings);
+    publisher->setUp(settings.broker, settings.instrumentName);
+    StreamRecording recording(settings.replayFilename);
+    do {
+      const auto bytesSent = recording.replay(*publisher, settings.slow);
+      publisher->flushSendQueue();
+      logger->info("Messages sent: {}, Bytes sent: {}",
+                   recording.getNumberOfMessages(), bytesSent);
+      if (!settings.singleRun) {
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(settings.runPauseMs));
+      }
+    } while (!settings.singleRun);
+    return 0;
+  }
+  if (!settings.recordFilename.empty()) {
+    logger->info("Recording a single run to {}", settings.recordFilename);
+    settings.singleRun = true;
+  }
+
   const auto detectorNumbers = getDetectorNumbers(settings);
+  if (settings.amplificationFactor > 1 && !detectorNumbers.empty()) {
+    const auto maxDetectorNumber = static_cast<uint32_t>(
+        std::max(0, *std::max_element(detectorNumbers.cbegin(),
+                                      detectorNumbers.cend())));
+    if (settings.amplificationDetectorIDOffset == 0) {
+      settings.amplificationDetectorIDOffset = maxDetectorNumber + 1;
+    }
+    try {
+      EventAmplifier::checkDetectorIDRange(
+          settings.amplificationFactor, settings.amplificationDetectorIDOffset,
+          maxDetectorNumber);
+    } catch (const std::runtime_error &error) {
+      return App.exit(
+          CLI::ValidationError("--amplify-detector-offset", error.what()));
+    }
+  } else if (settings.amplificationFactor > 1 &&
+             settings.amplificationDetectorIDOffset == 0) {
+    return App.exit(CLI::RequiredError("--amplify-detector-offset"));
+  }
   auto runStartTime = getTimeNowNanosecondsFromEpoch();
-  auto fileReader = std::make_shared<NexusFileReader>(
-      hdf5::file::open(settings.filename), runStartTime,
-      settings.fakeEventsPerPulse, detectorNumbers, settings);
-  auto publisher = std::make_shared<KafkaPublisher>(settings.compression);
+  std::shared_ptr<FileReader> fileReader;
+  if (synthetic) {
+    fileReader = std::make_shared<SyntheticFileReader>(
+        runStartTime, detectorNumbers, settings);
+  } else {
+    fileReader = std::make_shared<NexusFileReader>(
+        hdf5::file::open(settings.filename), runStartTime,
+        settings.fakeEventsPerPulse, detectorNumbers, settings);
+  }
+  auto publisher = createPublisher(settings);
   publisher->setUp(settings.broker, settings.instrumentName);
   int runNumber = 1;
   NexusPublisher streamer(publisher, fileReader, settings);
@@ -154,7 +392,13 @@ int main(int argc, char **argv) {
     // Publish the same data repeatedly, with incrementing run numbers
     while (true) {
       streamer.streamData(runNumber, settings, jsonDescription);
-      std::this_thread::sleep_for(std::chrono::seconds(2));
+      // Prepare the next run during the pause between runs, rather than
+      // after it, while the end of this run is still being delivered
+      const auto nextRunStartTime =
+          std::chrono::steady_clock::now() +
+          std::chrono::milliseconds(settings.runPauseMs);
+      streamer.prepareRun();
+      std::this_thread::sleep_until(nextRunStartTime);
       runNumber++;
     }
   }
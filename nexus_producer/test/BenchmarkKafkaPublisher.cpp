@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include "../../core/include/Message.h"
+#include "../../core/include/OptionalArgs.h"
+#include "../../nexus_file_reader/include/NexusFileReader.h"
+#include "../../serialisation/include/EventData.h"
+#include "KafkaPublisher.h"
+#include "NexusPublisher.h"
+#include "benchmark/benchmark.h"
+
+/*
+ * Benchmarks of publishing to an in-process mock Kafka cluster provided by
+ * librdkafka, so that they can be run without a broker. The mock cluster
+ * shares the CPU with the producer, so the results are a lower bound on what
+ * a real cluster would give.
+ */
+
+namespace {
+const std::vector<std::string> compressionCodecs{"none", "gzip", "snappy",
+                                                 "lz4", "zstd"};
+
+/// Record delivery latency and size of every message reported by the producer
+class DeliveryRecorder : public RdKafka::DeliveryReportCb {
+public:
+  void dr_cb(RdKafka::Message &message) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (message.err() != RdKafka::ERR_NO_ERROR) {
+      ++m_numberOfFailures;
+      return;
+    }
+    m_latenciesMicroseconds.push_back(message.latency());
+    m_deliveredBytes += static_cast<int64_t>(message.len());
+  }
+
+  int64_t getNumberOfDelivered() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int64_t>(m_latenciesMicroseconds.size());
+  }
+
+  int64_t getDeliveredBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_deliveredBytes;
+  }
+
+  /// Add delivery statistics to the benchmark output and start recording
+  /// afresh
+  void report(benchmark::State &state) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    state.counters["delivered"] =
+        static_cast<double>(m_latenciesMicroseconds.size());
+    state.counters["failed"] = static_cast<double>(m_numberOfFailures);
+    if (!m_latenciesMicroseconds.empty()) {
+      std::sort(m_latenciesMicroseconds.begin(),
+                m_latenciesMicroseconds.end());
+      const auto total =
+          std::accumulate(m_latenciesMicroseconds.cbegin(),
+                          m_latenciesMicroseconds.cend(), int64_t{0});
+      state.counters["latency_mean_us"] =
+          static_cast<double>(total) / m_latenciesMicroseconds.size();
+      state.counters["latency_p99_us"] = static_cast<double>(
+          m_latenciesMicroseconds[m_latenciesMicroseconds.size() * 99 / 100]);
+    }
+    m_latenciesMicroseconds.clear();
+    m_numberOfFailures = 0;
+    m_deliveredBytes = 0;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<int64_t> m_latenciesMicroseconds;
+  int64_t m_numberOfFailures = 0;
+  int64_t m_deliveredBytes = 0;
+};
+
+std::shared_ptr<KafkaPublisher>
+createMockClusterPublisher(const std::string &codec,
+                           DeliveryRecorder &deliveryRecorder) {
+  auto publisher = std::make_shared<KafkaPublisher>(codec);
+  publisher->setConfigOption("test.mock.num.brokers", "3");
+  publisher->setDeliveryReportCallback(&deliveryRecorder);
+  // The broker address is replaced by the mock cluster's
+  publisher->setUp("mock", "benchmark");
+  return publisher;
+}
+} // namespace
+
+/**
+ * Publish event messages of a given size, arguments are the number of events
+ * per message and the index of the compression codec
+ */
+void PublishEventMessages(benchmark::State &state) {
+  const auto numberOfEvents = static_cast<uint32_t>(state.range(0));
+  const auto &codec = compressionCodecs[state.range(1)];
+  state.SetLabel(codec);
+
+  // Consecutive detector IDs and times of flight compress about as well as
+  // real data
+  std::vector<uint32_t> detIds(numberOfEvents);
+  std::vector<uint32_t> tofs(numberOfEvents);
+  std::iota(detIds.begin(), detIds.end(), 0);
+  std::iota(tofs.begin(), tofs.end(), 1000);
+  EventData events;
+  events.setDetId(detIds);
+  events.setTof(tofs);
+  events.setFrameTime(41389);
+  auto message = events.getBuffer(0);
+
+  DeliveryRecorder deliveryRecorder;
+  auto publisher = createMockClusterPublisher(codec, deliveryRecorder);
+
+  // Each iteration includes waiting for the messages to be delivered
+  const int64_t messagesPerIteration = 100;
+  while (state.KeepRunning()) {
+    for (int64_t messageNumber = 0; messageNumber < messagesPerIteration;
+         ++messageNumber) {
+      publisher->sendEventMessage(message);
+    }
+    publisher->flushSendQueue();
+  }
+  state.SetItemsProcessed(state.iterations() * messagesPerIteration);
+  state.SetBytesProcessed(state.iterations() * messagesPerIteration *
+                          static_cast<int64_t>(message.size()));
+  deliveryRecorder.report(state);
+}
+
+BENCHMARK(PublishEventMessages)
+    ->ArgsProduct({{100, 10000, 100000}, {0, 1, 2, 3, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/**
+ * Stream a whole run from a NeXus file in the data directory, the argument is
+ * the index of the compression codec. Every message of the run counts as an
+ * item, including run start, run stop and sample environment messages.
+ */
+void StreamFile(benchmark::State &state) {
+  const auto &codec = compressionCodecs[state.range(0)];
+  state.SetLabel(codec);
+
+  OptionalArgs settings;
+  settings.filename =
+      std::string(BENCHMARK_DATA_PATH) + "SANS_test_reduced.hdf5";
+  settings.quietMode = true;
+  settings.singleRun = true;
+
+  DeliveryRecorder deliveryRecorder;
+  auto publisher = createMockClusterPublisher(codec, deliveryRecorder);
+  auto fileReader = std::make_shared<NexusFileReader>(
+      hdf5::file::open(settings.filename), 0, 0, std::vector<int32_t>{0},
+      settings);
+  NexusPublisher streamer(publisher, fileReader, settings);
+
+  // Each iteration includes waiting for the messages to be delivered
+  int runNumber = 1;
+  while (state.KeepRunning()) {
+    streamer.streamData(runNumber++, settings, "");
+    publisher->flushSendQueue();
+  }
+  state.SetItemsProcessed(deliveryRecorder.getNumberOfDelivered());
+  state.SetBytesProcessed(deliveryRecorder.getDeliveredBytes());
+  state.counters["frames_per_run"] =
+      static_cast<double>(fileReader->getNumberOfFrames());
+  deliveryRecorder.report(state);
+}
+
+BENCHMARK(StreamFile)
+    ->DenseRange(0, 4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv) {
+  auto logger = spdlog::stderr_color_mt("LOG");
+  logger->set_level(spdlog::level::warn);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
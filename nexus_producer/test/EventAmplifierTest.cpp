@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "EventAmplifier.h"
+
+class EventAmplifierTest : public ::testing::Test {};
+
+TEST(EventAmplifierTest, amplifier_is_disabled_for_factor_of_one) {
+  EventAmplifier amplifier(1, 0, 0, 0);
+  EXPECT_FALSE(amplifier.isEnabled());
+}
+
+TEST(EventAmplifierTest, error_thrown_for_invalid_settings) {
+  EXPECT_THROW(EventAmplifier(0, 0, 0, 0), std::runtime_error);
+  // Copies would overlap the original detector IDs
+  EXPECT_THROW(EventAmplifier(2, 0, 0, 0), std::runtime_error);
+  // The last copy does not fit in 32 bits
+  EXPECT_THROW(EventAmplifier(3, 3000000000u, 0, 0), std::runtime_error);
+}
+
+TEST(EventAmplifierTest, detector_id_range_is_checked_against_largest_id) {
+  EXPECT_NO_THROW(EventAmplifier::checkDetectorIDRange(3, 101, 100));
+  // Copies would overlap the original detector IDs
+  EXPECT_THROW(EventAmplifier::checkDetectorIDRange(3, 100, 100),
+               std::runtime_error);
+  EXPECT_THROW(EventAmplifier::checkDetectorIDRange(3, 50, 100),
+               std::runtime_error);
+  // The offset alone fits, but not once added to the largest ID
+  EXPECT_NO_THROW(EventAmplifier::checkDetectorIDRange(2, 4000000000u, 0));
+  EXPECT_THROW(EventAmplifier::checkDetectorIDRange(2, 4000000000u, 300000000u),
+               std::runtime_error);
+  // Nothing to check without copies
+  EXPECT_NO_THROW(EventAmplifier::checkDetectorIDRange(1, 0, 100));
+}
+
+TEST(EventAmplifierTest, events_are_copied_to_disjoint_detector_ranges) {
+  EventAmplifier amplifier(3, 100, 0, 0);
+  EXPECT_TRUE(amplifier.isEnabled());
+  auto frame = amplifier.amplify(EventDataFrame({1, 42}, {10, 20}), 0, 0);
+  EXPECT_EQ(std::vector<uint32_t>({1, 42, 101, 142, 201, 242}),
+            frame.detectorIDs);
+  EXPECT_EQ(std::vector<uint32_t>({10, 20, 10, 20, 10, 20}),
+            frame.timeOfFlights);
+}
+
+TEST(EventAmplifierTest, copies_are_jittered_within_limits) {
+  const uint32_t jitter = 50;
+  EventAmplifier amplifier(4, 1000, jitter, 0);
+  const std::vector<uint32_t> timeOfFlights = {0, 500, 1000, 100000};
+  auto frame = amplifier.amplify(
+      EventDataFrame(std::vector<uint32_t>(4, 1), timeOfFlights), 0, 0);
+
+  // The original events are unchanged
+  EXPECT_EQ(timeOfFlights,
+            std::vector<uint32_t>(frame.timeOfFlights.cbegin(),
+                                  frame.timeOfFlights.cbegin() + 4));
+  bool anyJittered = false;
+  for (size_t i = 4; i < frame.timeOfFlights.size(); ++i) {
+    const auto original = static_cast<int64_t>(timeOfFlights[i % 4]);
+    const auto jittered = static_cast<int64_t>(frame.timeOfFlights[i]);
+    EXPECT_LE(std::abs(jittered - original), jitter);
+    anyJittered = anyJittered || jittered != original;
+  }
+  EXPECT_TRUE(anyJittered);
+}
+
+TEST(EventAmplifierTest, jitter_is_reproducible_for_the_same_seed) {
+  EventAmplifier amplifier(2, 10, 1000, 5);
+  EventAmplifier otherAmplifier(2, 10, 1000, 5);
+  const EventDataFrame frame({1, 2, 3}, {5000, 6000, 7000});
+  EXPECT_EQ(amplifier.amplify(frame, 3, 1).timeOfFlights,
+            otherAmplifier.amplify(frame, 3, 1).timeOfFlights);
+  // Amplifying other frames in between does not change the jitter of a frame
+  const auto firstTimeOfFlights = amplifier.amplify(frame, 0, 0).timeOfFlights;
+  amplifier.amplify(frame, 1, 0);
+  EXPECT_EQ(firstTimeOfFlights, amplifier.amplify(frame, 0, 0).timeOfFlights);
+}
+
+TEST(EventAmplifierTest, each_frame_and_group_is_jittered_differently) {
+  EventAmplifier amplifier(2, 10, 1000, 5);
+  const EventDataFrame frame(std::vector<uint32_t>(16, 1),
+                             std::vector<uint32_t>(16, 5000));
+  const auto timeOfFlights = amplifier.amplify(frame, 0, 0).timeOfFlights;
+  EXPECT_NE(timeOfFlights, amplifier.amplify(frame, 0, 1).timeOfFlights);
+  EXPECT_NE(timeOfFlights, amplifier.amplify(frame, 1, 0).timeOfFlights);
+}
+
+TEST(EventAmplifierTest, empty_frame_stays_empty) {
+  EventAmplifier amplifier(10, 100, 5, 0);
+  auto frame = amplifier.amplify(EventDataFrame({}, {}), 0, 0);
+  EXPECT_TRUE(frame.detectorIDs.empty());
+  EXPECT_TRUE(frame.timeOfFlights.empty());
+}
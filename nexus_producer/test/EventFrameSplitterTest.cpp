@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "EventFrameSplitter.h"
+
+class EventFrameSplitterTest : public ::testing::Test {};
+
+TEST(EventFrameSplitterTest, frame_is_not_split_if_splitting_is_disabled) {
+  EventFrameSplitter splitter(0, {});
+  EXPECT_FALSE(splitter.isEnabled());
+  auto frames = splitter.split(EventDataFrame({1, 2, 3}, {10, 20, 30}));
+  ASSERT_EQ(1u, frames.size());
+  EXPECT_EQ(3u, frames[0].detectorIDs.size());
+}
+
+TEST(EventFrameSplitterTest, frame_is_split_by_maximum_number_of_events) {
+  EventFrameSplitter splitter(2, {});
+  auto frames =
+      splitter.split(EventDataFrame({1, 2, 3, 4, 5}, {10, 20, 30, 40, 50}));
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(std::vector<uint32_t>({1, 2}), frames[0].detectorIDs);
+  EXPECT_EQ(std::vector<uint32_t>({30, 40}), frames[1].timeOfFlights);
+  EXPECT_EQ(std::vector<uint32_t>({5}), frames[2].detectorIDs);
+}
+
+TEST(EventFrameSplitterTest, frame_is_split_by_detector_id_range) {
+  EventFrameSplitter splitter(0, {100, 200, 300});
+  auto frames = splitter.split(
+      EventDataFrame({250, 5, 150, 99, 100, 260}, {1, 2, 3, 4, 5, 6}));
+
+  // No events in the range starting at 300, so only three messages
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(std::vector<uint32_t>({5, 99}), frames[0].detectorIDs);
+  EXPECT_EQ(std::vector<uint32_t>({2, 4}), frames[0].timeOfFlights);
+  EXPECT_EQ(std::vector<uint32_t>({150, 100}), frames[1].detectorIDs);
+  EXPECT_EQ(std::vector<uint32_t>({250, 260}), frames[2].detectorIDs);
+  EXPECT_EQ(std::vector<uint32_t>({1, 6}), frames[2].timeOfFlights);
+}
+
+TEST(EventFrameSplitterTest, detector_ranges_are_also_split_by_size) {
+  EventFrameSplitter splitter(1, {100});
+  auto frames = splitter.split(EventDataFrame({150, 5, 160}, {1, 2, 3}));
+  ASSERT_EQ(3u, frames.size());
+  EXPECT_EQ(5u, frames[0].detectorIDs[0]);
+  EXPECT_EQ(150u, frames[1].detectorIDs[0]);
+  EXPECT_EQ(160u, frames[2].detectorIDs[0]);
+}
+
+TEST(EventFrameSplitterTest, unsorted_detector_boundaries_throw) {
+  EXPECT_THROW(EventFrameSplitter(0, {200, 100}), std::runtime_error);
+}
@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/EventData.h"
+#include "FilePublisher.h"
+#include "MessageTestHelpers.h"
+
+using MessageTestHelpers::createEventMessage;
+
+class FilePublisherTest : public ::testing::Test {
+protected:
+  void TearDown() override {
+    for (const auto &topic : {"_events", "_runInfo", "_detSpecMap",
+                              "_sampleEnv", "_histograms"}) {
+      std::remove(
+          FilePublisher::getTopicFilename(".", m_instrumentName + topic)
+              .c_str());
+    }
+  }
+
+  const std::string m_instrumentName = "FilePublisherTest";
+};
+
+TEST_F(FilePublisherTest, messages_are_written_to_the_file_for_their_topic) {
+  FilePublisher publisher(".");
+  publisher.setUp("", m_instrumentName);
+  auto firstMessage = createEventMessage(1000);
+  auto secondMessage = createEventMessage(2000);
+  publisher.sendEventMessage(firstMessage);
+  publisher.sendEventMessage(secondMessage);
+  publisher.sendRunMessage(firstMessage);
+  publisher.flushSendQueue();
+  EXPECT_EQ(2, publisher.getCurrentOffset());
+
+  std::ifstream eventFile(
+      FilePublisher::getTopicFilename(".", m_instrumentName + "_events"),
+      std::ios::binary);
+  for (uint64_t frameTime : {1000u, 2000u}) {
+    uint32_t size = 0;
+    eventFile.read(reinterpret_cast<char *>(&size), sizeof(size));
+    ASSERT_EQ(firstMessage.size(), size);
+    std::vector<uint8_t> buffer(size);
+    eventFile.read(reinterpret_cast<char *>(buffer.data()), size);
+    EventData decoded;
+    decoded.decodeMessage(buffer.data());
+    EXPECT_EQ(frameTime, decoded.getFrameTime());
+  }
+  EXPECT_EQ(std::ifstream::traits_type::eof(), eventFile.peek());
+
+  std::ifstream sampleEnvFile(
+      FilePublisher::getTopicFilename(".", m_instrumentName + "_sampleEnv"),
+      std::ios::binary);
+  EXPECT_EQ(std::ifstream::traits_type::eof(), sampleEnvFile.peek());
+}
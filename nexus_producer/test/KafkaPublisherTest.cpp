@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+
+#include "../../core/include/Message.h"
+#include "KafkaPublisher.h"
+#include "MessageTestHelpers.h"
+
+namespace {
+/// Record the topic of each message in the order they are delivered
+class DeliveryOrderRecorder : public RdKafka::DeliveryReportCb {
+public:
+  void dr_cb(RdKafka::Message &message) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    EXPECT_EQ(RdKafka::ERR_NO_ERROR, message.err());
+    m_topicNames.push_back(message.topic_name());
+  }
+
+  std::vector<std::string> getTopicNames() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_topicNames;
+  }
+
+  size_t getNumberDelivered(const std::string &topicName) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(
+        std::count(m_topicNames.cbegin(), m_topicNames.cend(), topicName));
+  }
+
+private:
+  std::mutex m_mutex;
+  std::vector<std::string> m_topicNames;
+};
+} // namespace
+
+class KafkaPublisherTest : public ::testing::Test {};
+
+TEST(KafkaPublisherTest, run_stop_is_delivered_after_earlier_messages) {
+  auto message = MessageTestHelpers::createEventMessage(0);
+
+  DeliveryOrderRecorder deliveryRecorder;
+  KafkaPublisher publisher;
+  // Use a mock cluster inside librdkafka, so no broker is needed
+  publisher.setConfigOption("test.mock.num.brokers", "1");
+  publisher.setDeliveryReportCallback(&deliveryRecorder);
+  publisher.setUp("mock", "test");
+
+  const size_t numberOfEventMessages = 1000;
+  for (size_t messageNumber = 0; messageNumber < numberOfEventMessages;
+       ++messageNumber) {
+    publisher.sendEventMessage(message);
+  }
+  publisher.sendRunStopMessage(message);
+  // A run start of the next run must not overtake the run stop
+  publisher.sendRunMessage(message);
+  publisher.flushSendQueue();
+
+  const auto topicNames = deliveryRecorder.getTopicNames();
+  ASSERT_EQ(numberOfEventMessages + 2, topicNames.size());
+  for (size_t messageNumber = 0; messageNumber < numberOfEventMessages;
+       ++messageNumber) {
+    EXPECT_EQ("test_events", topicNames[messageNumber]);
+  }
+  EXPECT_EQ("test_runInfo", topicNames[numberOfEventMessages]);
+  EXPECT_EQ("test_runInfo", topicNames[numberOfEventMessages + 1]);
+}
+
+TEST(KafkaPublisherTest, only_event_messages_wait_to_be_batched) {
+  auto message = MessageTestHelpers::createEventMessage(0);
+
+  DeliveryOrderRecorder deliveryRecorder;
+  KafkaPublisher publisher;
+  publisher.setConfigOption("test.mock.num.brokers", "1");
+  // Messages would wait this long to be batched, unless they go through the
+  // priority producer which sends them immediately
+  publisher.setConfigOption("queue.buffering.max.ms", "60000");
+  publisher.setDeliveryReportCallback(&deliveryRecorder);
+  publisher.setUp("mock", "test");
+
+  publisher.sendEventMessage(message);
+  publisher.sendRunMessage(message);
+  publisher.sendDetSpecMessage(message);
+  publisher.sendHistogramMessage(message);
+
+  // Delivery reports are only received when a message is produced, so keep
+  // producing sample environment messages until the others are delivered
+  const auto timeout =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while ((deliveryRecorder.getNumberDelivered("test_runInfo") < 1 ||
+          deliveryRecorder.getNumberDelivered("test_detSpecMap") < 1 ||
+          deliveryRecorder.getNumberDelivered("test_histograms") < 1 ||
+          deliveryRecorder.getNumberDelivered("test_sampleEnv") < 1) &&
+         std::chrono::steady_clock::now() < timeout) {
+    publisher.sendSampleEnvMessage(message);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1u, deliveryRecorder.getNumberDelivered("test_runInfo"));
+  EXPECT_EQ(1u, deliveryRecorder.getNumberDelivered("test_detSpecMap"));
+  EXPECT_EQ(1u, deliveryRecorder.getNumberDelivered("test_histograms"));
+  EXPECT_LE(1u, deliveryRecorder.getNumberDelivered("test_sampleEnv"));
+  // The event message is still waiting to be batched
+  EXPECT_EQ(0u, deliveryRecorder.getNumberDelivered("test_events"));
+
+  publisher.flushSendQueue();
+  EXPECT_EQ(1u, deliveryRecorder.getNumberDelivered("test_events"));
+}
+
+TEST(KafkaPublisherTest, topic_options_only_apply_to_their_topic) {
+  auto message = MessageTestHelpers::createEventMessage(0);
+
+  DeliveryOrderRecorder deliveryRecorder;
+  KafkaPublisher publisher;
+  publisher.setConfigOption("test.mock.num.brokers", "1");
+  publisher.setTopicConfigOption(
+      KafkaPublisher::parseTopicConfigOption("histograms:linger.ms=60000"));
+  publisher.setDeliveryReportCallback(&deliveryRecorder);
+  publisher.setUp("mock", "test");
+
+  publisher.sendHistogramMessage(message);
+  const auto timeout =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (deliveryRecorder.getNumberDelivered("test_sampleEnv") < 1 &&
+         std::chrono::steady_clock::now() < timeout) {
+    publisher.sendSampleEnvMessage(message);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_LE(1u, deliveryRecorder.getNumberDelivered("test_sampleEnv"));
+  // The histogram message is still waiting to be batched
+  EXPECT_EQ(0u, deliveryRecorder.getNumberDelivered("test_histograms"));
+
+  publisher.flushSendQueue();
+  EXPECT_EQ(1u, deliveryRecorder.getNumberDelivered("test_histograms"));
+}
+
+TEST(KafkaPublisherTest,
+     run_stop_is_not_released_by_messages_produced_after_it) {
+  auto message = MessageTestHelpers::createEventMessage(0);
+
+  DeliveryOrderRecorder deliveryRecorder;
+  KafkaPublisher publisher;
+  publisher.setConfigOption("test.mock.num.brokers", "1");
+  publisher.setTopicConfigOption(
+      KafkaPublisher::parseTopicConfigOption("events:linger.ms=60000"));
+  publisher.setDeliveryReportCallback(&deliveryRecorder);
+  publisher.setUp("mock", "test");
+
+  publisher.sendEventMessage(message);
+  publisher.sendRunStopMessage(message);
+  // Sample environment messages go through a different producer, so they are
+  // delivered long before the event message
+  const auto timeout =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (deliveryRecorder.getNumberDelivered("test_sampleEnv") < 2 &&
+         std::chrono::steady_clock::now() < timeout) {
+    publisher.sendSampleEnvMessage(message);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_LE(2u, deliveryRecorder.getNumberDelivered("test_sampleEnv"));
+  EXPECT_EQ(0u, deliveryRecorder.getNumberDelivered("test_runInfo"));
+
+  publisher.flushSendQueue();
+  const auto topicNames = deliveryRecorder.getTopicNames();
+  const auto event =
+      std::find(topicNames.cbegin(), topicNames.cend(), "test_events");
+  const auto runStop =
+      std::find(topicNames.cbegin(), topicNames.cend(), "test_runInfo");
+  ASSERT_NE(topicNames.cend(), runStop);
+  EXPECT_LT(event, runStop);
+}
+
+TEST(KafkaPublisherTest, invalid_topic_options_throw) {
+  EXPECT_THROW(KafkaPublisher::parseTopicConfigOption("linger.ms=5"),
+               std::runtime_error);
+  EXPECT_THROW(KafkaPublisher::parseTopicConfigOption("events:linger.ms"),
+               std::runtime_error);
+  EXPECT_THROW(KafkaPublisher::parseTopicConfigOption("events:=5"),
+               std::runtime_error);
+  EXPECT_THROW(KafkaPublisher::parseTopicConfigOption("neutrons:linger.ms=5"),
+               std::runtime_error);
+
+  const auto option =
+      KafkaPublisher::parseTopicConfigOption("runInfo:batch.num.messages=1");
+  EXPECT_EQ("runInfo", option.topic);
+  EXPECT_EQ("batch.num.messages", option.name);
+  EXPECT_EQ("1", option.value);
+}
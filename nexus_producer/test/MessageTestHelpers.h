@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/EventData.h"
+
+namespace MessageTestHelpers {
+
+/// Serialise a small event message, the frame time tells messages apart
+inline Streamer::Message createEventMessage(uint64_t frameTime,
+                                            bool patchable = false) {
+  EventData events;
+  events.setDetId({1, 2, 3});
+  events.setTof({30, 20, 10});
+  events.setFrameTime(frameTime);
+  return events.getBuffer(0, patchable);
+}
+} // namespace MessageTestHelpers
@@ -1,9 +1,12 @@
+#include <cstdio>
+#include <fstream>
 #include <gmock/gmock.h>
 #include <memory>
 
 #include "../../core/include/EventDataFrame.h"
 #include "../../core/include/HistogramFrame.h"
 #include "../../core/include/OptionalArgs.h"
+#include "../../serialisation/include/DetectorSpectrumMapData.h"
 #include "../../serialisation/include/EventData.h"
 #include "MockPublisher.h"
 #include "NexusPublisher.h"
@@ -24,7 +27,13 @@ public:
   bool hasHistogramData() override { return m_histogramDataInFile; };
 
   std::vector<EventDataFrame> getEventData(hsize_t frameNumber) override {
-    std::vector<EventDataFrame> eventData{EventDataFrame({0, 1, 2}, {0, 1, 2})};
+    ++m_numberOfEventDataReads;
+    std::vector<EventDataFrame> eventData;
+    for (size_t groupNumber = 0; groupNumber < m_numberOfEventGroups;
+         ++groupNumber) {
+      eventData.emplace_back(std::vector<uint32_t>{0, 1, 2},
+                             std::vector<uint32_t>{0, 1, 2});
+    }
     return eventData;
   }
 
@@ -46,9 +55,7 @@ public:
   };
   uint64_t getFrameTime(hsize_t frameNumber) override { return 0; };
   std::string getInstrumentName() override { return "FAKE"; };
-  std::unordered_map<hsize_t, sEEventVector> getSEEventMap() override {
-    return {};
-  };
+  SampleEnvironmentLogs getSampleEnvLogs() override { return {}; };
   int32_t getNumberOfPeriods() override { return 1; };
   uint64_t getRelativeFrameTimeMilliseconds(hsize_t frameNumber) override {
     return 0;
@@ -60,6 +67,8 @@ public:
   uint32_t getRunDurationMs() override { return 100; };
 
   bool m_histogramDataInFile = true;
+  size_t m_numberOfEventGroups = 1;
+  size_t m_numberOfEventDataReads = 0;
 };
 
 class NexusPublisherTest : public ::testing::Test {
@@ -112,6 +121,137 @@ TEST_F(NexusPublisherTest, test_create_message_data) {
   EXPECT_EQ(0, receivedEventData.getPeriod());
 }
 
+TEST_F(NexusPublisherTest, test_event_groups_are_merged_into_one_message) {
+  auto settings = createSettings(true);
+  settings.mergeGroups = true;
+
+  auto publisher = std::make_shared<MockPublisher>();
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  fakeFileReader->m_numberOfEventGroups = 3;
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+
+  auto eventData = streamer.createMessageData(static_cast<hsize_t>(0));
+  ASSERT_EQ(1, eventData.size());
+  EXPECT_EQ(9, eventData[0].getNumberOfEvents());
+}
+
+TEST_F(NexusPublisherTest, test_events_are_amplified_before_splitting) {
+  auto settings = createSettings(true);
+  settings.amplificationFactor = 2;
+  settings.amplificationDetectorIDOffset = 10;
+  settings.splitDetectorIDs = {10};
+
+  auto publisher = std::make_shared<MockPublisher>();
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+
+  // One message for the original events and one for the copies
+  auto eventData = streamer.createMessageData(static_cast<hsize_t>(0));
+  ASSERT_EQ(2, eventData.size());
+  EXPECT_THAT(eventData[0].getDetId(), ::testing::ElementsAre(0, 1, 2));
+  EXPECT_THAT(eventData[1].getDetId(), ::testing::ElementsAre(10, 11, 12));
+  EXPECT_THAT(eventData[1].getTof(), ::testing::ElementsAre(0, 1, 2));
+  EXPECT_EQ(6, eventData[0].getTotalCounts());
+}
+
+TEST_F(NexusPublisherTest, test_ev44_batches_events_from_all_groups) {
+  auto settings = createSettings(true);
+  settings.ev44 = true;
+  settings.histogramUpdatePeriodMs = 0;
+
+  auto publisher = std::make_shared<MockPublisher>();
+  EXPECT_CALL(*publisher.get(), sendEventMessage(_)).Times(1);
+  EXPECT_CALL(*publisher.get(), sendRunMessage(_)).Times(2);
+
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  fakeFileReader->m_numberOfEventGroups = 3;
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+  EXPECT_NO_THROW(streamer.streamData(1, settings, ""));
+}
+
+TEST_F(NexusPublisherTest, test_later_runs_are_replayed_from_cache) {
+  auto settings = createSettings(true);
+  settings.histogramUpdatePeriodMs = 0;
+  settings.replayCacheSizeMB = 1;
+
+  auto publisher = std::make_shared<MockPublisher>();
+  EXPECT_CALL(*publisher.get(), sendEventMessage(_)).Times(6);
+  EXPECT_CALL(*publisher.get(), sendRunMessage(_)).Times(6);
+
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  fakeFileReader->m_numberOfEventGroups = 2;
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+  for (int runNumber = 1; runNumber <= 3; ++runNumber) {
+    EXPECT_NO_THROW(streamer.streamData(runNumber, settings, ""));
+  }
+  EXPECT_EQ(1u, fakeFileReader->m_numberOfEventDataReads);
+}
+
+TEST_F(NexusPublisherTest, test_prepared_frames_are_not_read_again) {
+  auto settings = createSettings(true);
+  settings.histogramUpdatePeriodMs = 0;
+
+  auto publisher = std::make_shared<MockPublisher>();
+  EXPECT_CALL(*publisher.get(), sendEventMessage(_)).Times(2);
+  EXPECT_CALL(*publisher.get(), sendRunMessage(_)).Times(4);
+
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+  EXPECT_NO_THROW(streamer.streamData(1, settings, ""));
+  streamer.prepareRun();
+  EXPECT_EQ(2u, fakeFileReader->m_numberOfEventDataReads);
+  EXPECT_NO_THROW(streamer.streamData(2, settings, ""));
+  EXPECT_EQ(2u, fakeFileReader->m_numberOfEventDataReads);
+}
+
+TEST_F(NexusPublisherTest, test_det_spec_map_is_published_once_on_own_topic) {
+  auto settings = createSettings(true);
+  settings.histogramUpdatePeriodMs = 0;
+  settings.detSpecMapOnOwnTopic = true;
+
+  auto publisher = std::make_shared<MockPublisher>();
+  EXPECT_CALL(*publisher.get(), sendEventMessage(_)).Times(2);
+  EXPECT_CALL(*publisher.get(), sendRunMessage(_)).Times(4);
+  EXPECT_CALL(*publisher.get(), sendDetSpecMessage(_)).Times(1);
+
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+  for (int runNumber = 1; runNumber <= 2; ++runNumber) {
+    EXPECT_NO_THROW(streamer.streamData(runNumber, settings, ""));
+  }
+}
+
+TEST_F(NexusPublisherTest, test_det_spec_map_is_published_again_if_changed) {
+  const std::string mapFilename = "publisher_test_detector_spectrum_map.dat";
+  const auto writeMapFile = [&mapFilename](int32_t numberOfEntries) {
+    std::ofstream mapFile(mapFilename);
+    mapFile << "Number_of_entries\n"
+            << numberOfEntries << "\nDetector  Spectrum\n";
+    for (int32_t entry = 1; entry <= numberOfEntries; ++entry) {
+      mapFile << "  " << entry << "  " << entry << "\n";
+    }
+  };
+  auto settings = createSettings(true);
+  settings.histogramUpdatePeriodMs = 0;
+  settings.detSpecMapOnOwnTopic = true;
+  settings.detSpecFilename = mapFilename;
+
+  auto publisher = std::make_shared<MockPublisher>();
+  EXPECT_CALL(*publisher.get(), sendEventMessage(_)).Times(2);
+  EXPECT_CALL(*publisher.get(), sendRunMessage(_)).Times(4);
+  EXPECT_CALL(*publisher.get(), sendDetSpecMessage(_)).Times(2);
+
+  auto fakeFileReader = std::make_shared<FakeFileReader>();
+  writeMapFile(2);
+  NexusPublisher streamer(publisher, fakeFileReader, settings);
+  EXPECT_NO_THROW(streamer.streamData(1, settings, ""));
+  writeMapFile(3);
+  EXPECT_NO_THROW(streamer.streamData(2, settings, ""));
+
+  std::remove(mapFilename.c_str());
+  std::remove(DetectorSpectrumMapData::getCacheFilename(mapFilename).c_str());
+}
+
 TEST_F(NexusPublisherTest, test_stream_data) {
   using ::testing::Sequence;
 
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/EventData.h"
+#include "NullPublisher.h"
+
+class NullPublisherTest : public ::testing::Test {};
+
+TEST(NullPublisherTest, messages_and_bytes_are_counted) {
+  EventData events;
+  events.setDetId({1, 2, 3});
+  events.setTof({30, 20, 10});
+  auto message = events.getBuffer(0);
+
+  NullPublisher publisher;
+  publisher.sendEventMessage(message);
+  publisher.sendEventMessage(message);
+  publisher.sendSampleEnvMessage(message);
+  publisher.sendHistogramMessage(message);
+  EXPECT_EQ(4, publisher.getNumberOfMessages());
+  EXPECT_EQ(static_cast<int64_t>(4 * message.size()),
+            publisher.getNumberOfBytes());
+  EXPECT_EQ(2, publisher.getCurrentOffset());
+}
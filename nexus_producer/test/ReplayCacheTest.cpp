@@ -0,0 +1,76 @@
+#include <ev42_events_generated.h>
+#include <gtest/gtest.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/EventData.h"
+#include "ReplayCache.h"
+
+class ReplayCacheTest : public ::testing::Test {
+public:
+  void recordEventMessages(ReplayCache &cache, size_t numberOfMessages) {
+    cache.startRecording(1000, 0);
+    for (size_t frameNumber = 0; frameNumber < numberOfMessages;
+         ++frameNumber) {
+      EventData events;
+      events.setDetId({static_cast<uint32_t>(frameNumber)});
+      events.setTof({10});
+      events.setFrameTime(1000 + frameNumber * 100);
+      auto buffer = events.getBuffer(frameNumber, true);
+      cache.addMessage(frameNumber, ReplayCache::MessageType::Event,
+                       reinterpret_cast<const uint8_t *>(buffer.data()),
+                       buffer.size());
+    }
+    cache.finishRecording();
+  }
+
+  /// Replay the cache, checking the messages are in the order recorded
+  void replayAndCheck(ReplayCache &cache, uint64_t firstFrameTime,
+                      uint64_t firstMessageID) {
+    size_t messageNumber = 0;
+    cache.replay(firstFrameTime, firstMessageID,
+                 [&](size_t frameNumber, ReplayCache::MessageType type,
+                     Streamer::Message &message) {
+                   EXPECT_EQ(messageNumber, frameNumber);
+                   EXPECT_EQ(ReplayCache::MessageType::Event, type);
+                   auto eventMessage = GetEventMessage(
+                       reinterpret_cast<const uint8_t *>(message.data()));
+                   EXPECT_EQ(firstFrameTime + messageNumber * 100,
+                             eventMessage->pulse_time());
+                   EXPECT_EQ(firstMessageID + messageNumber,
+                             eventMessage->message_id());
+                   EXPECT_EQ(messageNumber,
+                             eventMessage->detector_id()->Get(0));
+                   ++messageNumber;
+                 });
+    EXPECT_EQ(cache.getNumberOfMessages(), messageNumber);
+  }
+};
+
+TEST_F(ReplayCacheTest, cache_is_not_complete_until_recording_finishes) {
+  ReplayCache cache(1024);
+  EXPECT_FALSE(cache.isComplete());
+  cache.startRecording(0, 0);
+  EXPECT_FALSE(cache.isComplete());
+  cache.finishRecording();
+  EXPECT_TRUE(cache.isComplete());
+}
+
+TEST_F(ReplayCacheTest, replayed_messages_are_patched_for_each_run) {
+  ReplayCache cache(1024 * 1024);
+  recordEventMessages(cache, 5);
+  EXPECT_EQ(5u, cache.getNumberOfEventMessages());
+
+  replayAndCheck(cache, 1000, 0);
+  replayAndCheck(cache, 5000, 5);
+  replayAndCheck(cache, 3000, 10);
+}
+
+TEST_F(ReplayCacheTest, messages_beyond_memory_budget_are_replayed_from_file) {
+  // Only room for the first message or so in memory
+  ReplayCache cache(100);
+  recordEventMessages(cache, 20);
+  EXPECT_EQ(20u, cache.getNumberOfMessages());
+
+  replayAndCheck(cache, 2000, 20);
+  replayAndCheck(cache, 9000, 40);
+}
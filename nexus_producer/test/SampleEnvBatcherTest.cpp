@@ -0,0 +1,73 @@
+#include <gmock/gmock.h>
+
+#include "MockPublisher.h"
+#include "SampleEnvBatcher.h"
+
+// clang-format off
+using ::testing::_;
+// clang-format on
+
+class SampleEnvBatcherTest : public ::testing::Test {
+public:
+  /// Create logs with a single sample in each of numberOfFrames frames
+  static SampleEnvironmentLogs createLogs(uint32_t numberOfFrames) {
+    SampleEnvironmentLogs logs;
+    SampleEnvironmentLog log;
+    log.nameID = logs.internName("TEMP_1");
+    std::vector<double> values;
+    for (uint32_t frameNumber = 0; frameNumber < numberOfFrames;
+         ++frameNumber) {
+      log.times.push_back(0.1f * (frameNumber + 1));
+      values.push_back(frameNumber);
+    }
+    log.values = values;
+    auto logIndex = logs.addLog(std::move(log));
+    for (uint32_t frameNumber = 0; frameNumber < numberOfFrames;
+         ++frameNumber) {
+      logs.addSample(frameNumber, {logIndex, frameNumber});
+    }
+    logs.buildFrameIndex();
+    return logs;
+  }
+
+  static const uint64_t frameDurationNs = 100000000;
+};
+
+TEST_F(SampleEnvBatcherTest, full_batches_are_published_as_soon_as_full) {
+  auto logs = createLogs(5);
+  MockPublisher publisher;
+  SampleEnvBatcher batcher(2, 10000);
+
+  EXPECT_CALL(publisher, sendSampleEnvMessage(_)).Times(2);
+  for (uint32_t frameNumber = 0; frameNumber < 5; ++frameNumber) {
+    batcher.addSamples(logs, logs.getSamplesInFrame(frameNumber),
+                       frameNumber * frameDurationNs, publisher);
+  }
+  ::testing::Mock::VerifyAndClearExpectations(&publisher);
+
+  EXPECT_CALL(publisher, sendSampleEnvMessage(_)).Times(1);
+  EXPECT_GT(batcher.flush(logs, publisher), 0u);
+  ::testing::Mock::VerifyAndClearExpectations(&publisher);
+
+  // Nothing is left to flush
+  EXPECT_CALL(publisher, sendSampleEnvMessage(_)).Times(0);
+  EXPECT_EQ(0u, batcher.flush(logs, publisher));
+}
+
+TEST_F(SampleEnvBatcherTest, batches_older_than_flush_interval_are_published) {
+  auto logs = createLogs(4);
+  MockPublisher publisher;
+  // Interval of 250 ms with frames 100 ms apart
+  SampleEnvBatcher batcher(100, 250);
+
+  EXPECT_CALL(publisher, sendSampleEnvMessage(_)).Times(0);
+  for (uint32_t frameNumber = 0; frameNumber < 3; ++frameNumber) {
+    batcher.addSamples(logs, logs.getSamplesInFrame(frameNumber),
+                       frameNumber * frameDurationNs, publisher);
+  }
+  ::testing::Mock::VerifyAndClearExpectations(&publisher);
+
+  EXPECT_CALL(publisher, sendSampleEnvMessage(_)).Times(1);
+  batcher.addSamples(logs, logs.getSamplesInFrame(3), 3 * frameDurationNs,
+                     publisher);
+}
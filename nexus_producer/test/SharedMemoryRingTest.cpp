@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdio>
+#include <gtest/gtest.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/EventData.h"
+#include "MessageTestHelpers.h"
+#include "SharedMemoryRingPublisher.h"
+
+using namespace SharedMemoryRing;
+using MessageTestHelpers::createEventMessage;
+
+class SharedMemoryRingTest : public ::testing::Test {
+protected:
+  void TearDown() override { std::remove(m_ringFilename.c_str()); }
+
+  static std::vector<uint64_t> readFrameTimes(Reader &reader) {
+    std::vector<uint64_t> frameTimes;
+    reader.read([&frameTimes](const uint8_t *data, size_t) {
+      EventData decoded;
+      decoded.decodeMessage(data);
+      frameTimes.push_back(decoded.getFrameTime());
+    });
+    return frameTimes;
+  }
+
+  const std::string m_ringFilename = "shared_memory_ring_test.ring";
+};
+
+TEST_F(SharedMemoryRingTest,
+       consumer_reads_messages_published_after_attaching) {
+  SharedMemoryRingPublisher publisher(m_ringFilename, 64 * 1024);
+  auto firstMessage = createEventMessage(1000);
+  publisher.sendEventMessage(firstMessage);
+
+  Reader reader(m_ringFilename, Lane::Event);
+  Reader runReader(m_ringFilename, Lane::RunInfo);
+  auto secondMessage = createEventMessage(2000);
+  auto thirdMessage = createEventMessage(3000);
+  publisher.sendEventMessage(secondMessage);
+  publisher.sendEventMessage(thirdMessage);
+  publisher.sendRunMessage(firstMessage);
+
+  EXPECT_EQ(std::vector<uint64_t>({2000, 3000}), readFrameTimes(reader));
+  EXPECT_TRUE(readFrameTimes(reader).empty());
+  EXPECT_EQ(std::vector<uint64_t>({1000}), readFrameTimes(runReader));
+  EXPECT_EQ(3, publisher.getCurrentOffset());
+}
+
+TEST_F(SharedMemoryRingTest, messages_wrap_around_the_end_of_the_lane) {
+  auto message = createEventMessage(0);
+  // Room for a few messages in each lane
+  SharedMemoryRingPublisher publisher(m_ringFilename, 3 * message.size() + 64);
+  Reader reader(m_ringFilename, Lane::Event);
+
+  for (uint64_t frameTime = 1; frameTime <= 20; ++frameTime) {
+    auto frameMessage = createEventMessage(frameTime);
+    publisher.sendEventMessage(frameMessage);
+    EXPECT_EQ(std::vector<uint64_t>({frameTime}), readFrameTimes(reader));
+  }
+}
+
+TEST_F(SharedMemoryRingTest, stalled_consumer_is_detached_after_timeout) {
+  auto message = createEventMessage(0);
+  SharedMemoryRingPublisher publisher(m_ringFilename, 3 * message.size() + 64,
+                                      std::chrono::milliseconds(10));
+  Reader stalledReader(m_ringFilename, Lane::Event);
+  Reader reader(m_ringFilename, Lane::Event);
+
+  // Would wait forever for the stalled reader without the timeout
+  for (uint64_t frameTime = 1; frameTime <= 20; ++frameTime) {
+    auto frameMessage = createEventMessage(frameTime);
+    publisher.sendEventMessage(frameMessage);
+    EXPECT_EQ(std::vector<uint64_t>({frameTime}), readFrameTimes(reader));
+  }
+  EXPECT_THROW(readFrameTimes(stalledReader), std::runtime_error);
+}
+
+TEST_F(SharedMemoryRingTest, message_larger_than_half_a_lane_is_rejected) {
+  auto message = createEventMessage(0);
+  SharedMemoryRingPublisher publisher(m_ringFilename, message.size());
+  EXPECT_THROW(publisher.sendEventMessage(message), std::runtime_error);
+}
+
+TEST_F(SharedMemoryRingTest, file_which_is_not_a_ring_file_is_rejected) {
+  {
+    std::FILE *file = std::fopen(m_ringFilename.c_str(), "wb");
+    std::fputs("not a ring file, but long enough to have a header......", file);
+    std::fclose(file);
+  }
+  EXPECT_THROW(Reader(m_ringFilename, Lane::Event), std::runtime_error);
+}
@@ -0,0 +1,141 @@
+#include <cstdio>
+#include <ev42_events_generated.h>
+#include <fstream>
+#include <gmock/gmock.h>
+
+#include "../../core/include/Message.h"
+#include "../../serialisation/include/DetectorSpectrumMapData.h"
+#include "../../serialisation/include/EventData.h"
+#include "../../serialisation/include/RunData.h"
+#include "MessageTestHelpers.h"
+#include "MockPublisher.h"
+#include "StreamRecording.h"
+
+// clang-format off
+using ::testing::_;
+using ::testing::Invoke;
+// clang-format on
+
+using MessageTestHelpers::createEventMessage;
+
+class StreamRecordingTest : public ::testing::Test {
+protected:
+  void TearDown() override { std::remove(m_recordingFilename.c_str()); }
+
+  const std::string m_recordingFilename = "stream_recording_test.nsr";
+};
+
+TEST_F(StreamRecordingTest, messages_are_replayed_to_their_recorded_topic) {
+  {
+    StreamRecorder recorder(m_recordingFilename);
+    auto eventMessage = createEventMessage(1000);
+    auto sampleEnvMessage = createEventMessage(2000);
+    recorder.sendRunMessage(eventMessage);
+    recorder.sendEventMessage(eventMessage);
+    recorder.sendSampleEnvMessage(sampleEnvMessage);
+    recorder.sendRunMessage(eventMessage);
+  }
+
+  StreamRecording recording(m_recordingFilename);
+  EXPECT_EQ(4u, recording.getNumberOfMessages());
+
+  MockPublisher publisher;
+  EXPECT_CALL(publisher, sendRunMessage(_)).Times(2);
+  EXPECT_CALL(publisher, sendEventMessage(_)).Times(1);
+  EXPECT_CALL(publisher, sendSampleEnvMessage(_))
+      .WillOnce(Invoke([](Streamer::Message &message) {
+        EventData decoded;
+        decoded.decodeMessage(
+            reinterpret_cast<const uint8_t *>(message.data()));
+        EXPECT_EQ(2000u, decoded.getFrameTime());
+        EXPECT_EQ(3u, decoded.getNumberOfEvents());
+      }));
+  EXPECT_GT(recording.replay(publisher, false), 0u);
+}
+
+TEST_F(StreamRecordingTest, each_replay_is_published_as_a_new_run) {
+  {
+    StreamRecorder recorder(m_recordingFilename);
+    RunData runData;
+    runData.startTime = 1000;
+    runData.stopTime = 3000;
+    runData.runID = "7";
+    runData.jobID = "recorded_job";
+    runData.filename = "recorded.nxs";
+    auto runStart = serialiseRunStartMessage(runData, nonstd::nullopt);
+    recorder.sendRunMessage(runStart);
+    // Pulse one second after the run start
+    auto eventMessage = createEventMessage(2000000000, true);
+    recorder.sendEventMessage(eventMessage);
+    auto runStop = serialiseRunStopMessage(runData);
+    recorder.sendRunStopMessage(runStop);
+  }
+  StreamRecording recording(m_recordingFilename);
+
+  for (uint64_t replayNumber = 1; replayNumber <= 2; ++replayNumber) {
+    MockPublisher publisher;
+    RunData runStart;
+    EXPECT_CALL(publisher, sendEventMessage(_))
+        .WillOnce(Invoke([&runStart, replayNumber](Streamer::Message &message) {
+          const auto eventMessage = GetEventMessage(message.data());
+          EXPECT_EQ(runStart.startTime * 1000000 + 1000000000,
+                    eventMessage->pulse_time());
+          // Message IDs continue from the previous replay
+          EXPECT_EQ(replayNumber - 1, eventMessage->message_id());
+        }));
+    // The run stop is sent with sendRunStopMessage, which flushes by default
+    EXPECT_CALL(publisher, flushSendQueue()).Times(1);
+    EXPECT_CALL(publisher, sendRunMessage(_))
+        .WillOnce(Invoke([&runStart](Streamer::Message &message) {
+          runStart = deserialiseRunStartMessage(
+              reinterpret_cast<const uint8_t *>(message.data()));
+        }))
+        .WillOnce(Invoke([&runStart](Streamer::Message &message) {
+          const auto runStop = deserialiseRunStopMessage(
+              reinterpret_cast<const uint8_t *>(message.data()));
+          EXPECT_EQ(runStart.jobID, runStop.jobID);
+          EXPECT_EQ(runStart.runID, runStop.runID);
+          EXPECT_EQ(runStart.startTime + 2000, runStop.stopTime);
+        }));
+    recording.replay(publisher, false);
+
+    const auto suffix = "_replay" + std::to_string(replayNumber);
+    EXPECT_EQ("7" + suffix, runStart.runID);
+    EXPECT_EQ("recorded" + suffix + ".nxs", runStart.filename);
+    EXPECT_NE("recorded_job", runStart.jobID);
+    EXPECT_GT(runStart.startTime, 1000u);
+  }
+}
+
+TEST_F(StreamRecordingTest, incomplete_last_message_is_not_replayed) {
+  {
+    StreamRecorder recorder(m_recordingFilename);
+    auto message = createEventMessage(1000);
+    recorder.sendEventMessage(message);
+    recorder.sendEventMessage(message);
+  }
+  // Cut the recording off part way through the second message
+  std::ifstream recordingFile(m_recordingFilename, std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(recordingFile)),
+                       std::istreambuf_iterator<char>());
+  recordingFile.close();
+  std::ofstream truncatedFile(m_recordingFilename,
+                              std::ios::binary | std::ios::trunc);
+  truncatedFile.write(contents.data(), contents.size() - 10);
+  truncatedFile.close();
+
+  StreamRecording recording(m_recordingFilename);
+  EXPECT_EQ(1u, recording.getNumberOfMessages());
+  MockPublisher publisher;
+  EXPECT_CALL(publisher, sendEventMessage(_)).Times(1);
+  recording.replay(publisher, false);
+}
+
+TEST_F(StreamRecordingTest, file_which_is_not_a_recording_is_rejected) {
+  {
+    std::ofstream notARecording(m_recordingFilename, std::ios::binary);
+    notARecording << "not a stream recording file";
+  }
+  EXPECT_THROW(StreamRecording recording(m_recordingFilename),
+               std::runtime_error);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "../../core/include/Message.h"
 #include "df12_det_spec_map_generated.h"
 
@@ -10,19 +12,36 @@ public:
   explicit DetectorSpectrumMapData(
       const SpectraDetectorMapping *detSpecMapFromMessage);
 
-  int32_t getNumberOfEntries() { return m_numberOfEntries; }
-  std::vector<int32_t> getDetectors() { return m_detectors; }
-  std::vector<int32_t> getSpectra() { return m_spectra; }
+  /// Read a map file, from its binary cache if the cache is up to date,
+  /// otherwise from the text file, writing the cache for next time
+  static DetectorSpectrumMapData load(const std::string &filename);
+  /// Load a map file only once per process, later calls with the same
+  /// filename return the same map until the file's size or modification time
+  /// changes and the file no longer has the same contents
+  static std::shared_ptr<const DetectorSpectrumMapData>
+  loadShared(const std::string &filename);
+  static std::string getCacheFilename(const std::string &filename);
+
+  int32_t getNumberOfEntries() const { return m_numberOfEntries; }
+  const std::vector<int32_t> &getDetectors() const { return m_detectors; }
+  const std::vector<int32_t> &getSpectra() const { return m_spectra; }
 
   void setNumberOfEntries(int32_t numberOfEntries) {
     m_numberOfEntries = numberOfEntries;
   }
 
   flatbuffers::Offset<SpectraDetectorMapping>
-  addToBuffer(flatbuffers::FlatBufferBuilder &builder);
+  addToBuffer(flatbuffers::FlatBufferBuilder &builder) const;
+  /// Serialise the map as a message of its own
+  Streamer::Message getBuffer() const;
+  /// Hash of the detector and spectrum numbers, to tell whether the map has
+  /// changed without comparing every entry
+  uint64_t getContentHash() const;
 
 private:
   void readFile(const std::string &filename);
+  bool readCacheFile(const std::string &filename);
+  void writeCacheFile(const std::string &filename) const;
   int32_t m_numberOfEntries = 0;
   std::vector<int32_t> m_detectors;
   std::vector<int32_t> m_spectra;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Streamer {
+class Message;
+}
+
+/// Events from several pulses to be published as a single ev44 message
+class EventBatch {
+
+public:
+  // Add the events of a pulse to the end of the batch, events with the same
+  // pulse time as the last pulse in the batch are added to that pulse
+  void addPulse(uint64_t pulseTime, const std::vector<uint32_t> &detIds,
+                const std::vector<uint32_t> &tofs);
+  void clear();
+
+  bool empty() const { return m_referenceTimes.empty(); }
+  size_t getNumberOfPulses() const { return m_referenceTimes.size(); }
+  size_t getNumberOfEvents() const { return m_tof.size(); }
+  uint64_t getFirstPulseTime() const {
+    return static_cast<uint64_t>(m_referenceTimes.front());
+  }
+  uint64_t getLastPulseTime() const {
+    return static_cast<uint64_t>(m_referenceTimes.back());
+  }
+
+  /// @param patchable - keep the message ID in the buffer even if zero, so
+  /// that patchMessage can change it
+  Streamer::Message getBuffer(int64_t messageID, bool patchable = false) const;
+
+private:
+  /// Pulse time of each pulse in nanoseconds since epoch
+  std::vector<int64_t> m_referenceTimes;
+  /// Index of the first event of each pulse
+  std::vector<int32_t> m_referenceTimeIndices;
+  std::vector<int32_t> m_tof;
+  std::vector<int32_t> m_detId;
+};
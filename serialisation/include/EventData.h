@@ -26,20 +26,23 @@ public:
   void setFrameTime(uint64_t frameTime) { m_frameTime = frameTime; }
 
   // Getters
-  std::vector<uint32_t> getDetId() { return m_detId; }
-  std::vector<uint32_t> getTof() { return m_tof; }
-  uint32_t getNumberOfEvents() { return static_cast<uint32_t>(m_tof.size()); }
+  const std::vector<uint32_t> &getDetId() const { return m_detId; }
+  const std::vector<uint32_t> &getTof() const { return m_tof; }
+  uint32_t getNumberOfEvents() const {
+    return static_cast<uint32_t>(m_tof.size());
+  }
   uint64_t getTotalCounts() { return m_totalCounts; }
   float getProtonCharge() { return m_protonCharge; }
   uint32_t getPeriod() { return m_period; }
-  uint64_t getFrameTime() { return m_frameTime; }
+  uint64_t getFrameTime() const { return m_frameTime; }
 
-  Streamer::Message getBuffer(uint64_t messageID);
+  /// @param patchable - keep the pulse time and message ID in the buffer even
+  /// if zero, so that patchMessage can change them, at the cost of a larger
+  /// message
+  Streamer::Message getBuffer(uint64_t messageID, bool patchable = false);
 
 private:
   // Default values here should match default values in the schema
-  // if the values are then used to create the buffer they are omitted by
-  // flatbuffers to reduce the message size
   std::vector<uint32_t> m_detId = {};
   std::vector<uint32_t> m_tof = {};
   uint64_t m_totalCounts = 0;
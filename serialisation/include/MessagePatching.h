@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+/// Shift the timestamps and message ID of an already serialised ev42, ev44,
+/// f142 or se00 message in place, without rebuilding it
+///
+/// @return - false if the message is of another type or was serialised
+/// without the fields being present
+bool patchMessage(uint8_t *buffer, int64_t timeShiftNs,
+                  int64_t messageIDShift);
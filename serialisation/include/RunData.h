@@ -3,6 +3,7 @@
 #include <ctime>
 #include <fmt/format.h>
 #include <iomanip>
+#include <memory>
 #include <nonstd/optional.hpp>
 #include <sstream>
 
@@ -51,3 +52,40 @@ Streamer::Message serialiseRunStartMessage(
 Streamer::Message serialiseRunStopMessage(const RunData &runData);
 RunData deserialiseRunStartMessage(const uint8_t *buffer);
 RunData deserialiseRunStopMessage(const uint8_t *buffer);
+
+/// A run start message which is serialised once, including the NeXus
+/// structure and detector-spectrum map. Only the start time, run name, job ID
+/// and filename are patched in place for each run.
+class RunStartMessageTemplate {
+public:
+  RunStartMessageTemplate(
+      const RunData &runData,
+      std::shared_ptr<const DetectorSpectrumMapData> detSpecMap);
+
+  /// Create the run start message of a run which only differs from the
+  /// template in its start time, run name, job ID and filename
+  Streamer::Message createMessage(const RunData &runData);
+
+  /// The map included in the template, or nullptr
+  const std::shared_ptr<const DetectorSpectrumMapData> &getDetSpecMap() const {
+    return m_detSpecMap;
+  }
+
+private:
+  void build(const RunData &runData);
+  /// Location of the characters of a string in the buffer and how long the
+  /// string can be
+  struct StringField {
+    size_t offset;
+    size_t capacity;
+  };
+  StringField findStringField(const flatbuffers::String *string,
+                              size_t capacity) const;
+  void patchString(const StringField &field, const std::string &value);
+
+  std::shared_ptr<const DetectorSpectrumMapData> m_detSpecMap;
+  flatbuffers::DetachedBuffer m_buffer;
+  StringField m_runName{};
+  StringField m_jobID{};
+  StringField m_filename{};
+};
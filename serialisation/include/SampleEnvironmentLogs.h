@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <nonstd/variant.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../core/include/Message.h"
+
+/// Typed column of log values, all samples of a log share one type
+using LogValues =
+    nonstd::variant<std::vector<double>, std::vector<int32_t>,
+                    std::vector<int64_t>, std::vector<uint32_t>,
+                    std::vector<uint64_t>>;
+
+/// Struct-of-arrays storage for all samples of a single NXlog
+struct SampleEnvironmentLog {
+  uint32_t nameID = 0;
+  /// Time of each sample in seconds relative to the run start
+  std::vector<float> times;
+  LogValues values;
+};
+
+/// Identifies a single sample by the index of its log and its index in the log
+struct SampleEnvironmentSample {
+  uint32_t logIndex;
+  uint32_t sampleIndex;
+};
+
+/// Contiguous range of samples to publish in a frame
+struct SampleEnvironmentSampleRange {
+  const SampleEnvironmentSample *first = nullptr;
+  const SampleEnvironmentSample *last = nullptr;
+
+  const SampleEnvironmentSample *begin() const { return first; }
+  const SampleEnvironmentSample *end() const { return last; }
+  size_t size() const { return static_cast<size_t>(last - first); }
+  bool empty() const { return first == last; }
+};
+
+/*
+ * Stores the sample environment log data read from the file, one
+ * SampleEnvironmentLog per NXlog, and an index of the samples to be published
+ * in each frame
+ */
+class SampleEnvironmentLogs {
+public:
+  SampleEnvironmentLogs() = default;
+  explicit SampleEnvironmentLogs(uint64_t runStartNanosecondsPastUnixEpoch)
+      : m_runStartNanosecondsPastUnixEpoch(runStartNanosecondsPastUnixEpoch) {
+  }
+
+  uint32_t internName(const std::string &name);
+  const std::string &getName(uint32_t nameID) const {
+    return m_names[nameID];
+  }
+
+  uint32_t addLog(SampleEnvironmentLog log);
+  const SampleEnvironmentLog &getLog(uint32_t logIndex) const {
+    return m_logs[logIndex];
+  }
+  size_t getNumberOfLogs() const { return m_logs.size(); }
+
+  /// Samples must be added in the order they should be published within a
+  /// frame, buildFrameIndex() must be called once after the last sample is
+  /// added
+  void addSample(size_t frameNumber, SampleEnvironmentSample sample);
+  void buildFrameIndex();
+
+  SampleEnvironmentSampleRange getSamplesInFrame(size_t frameNumber) const;
+  size_t getNumberOfSamples() const { return m_samples.size(); }
+  bool empty() const { return m_samples.empty(); }
+
+  uint64_t getTimestamp(const SampleEnvironmentSample &sample) const;
+  /// Serialise a single sample as an f142 message, if patchable the timestamp
+  /// is kept in the buffer even if zero so that patchMessage can change it
+  Streamer::Message getBuffer(const SampleEnvironmentSample &sample,
+                              bool patchable = false) const;
+  /// Serialise several samples of one log as a single array-valued se00
+  /// message
+  Streamer::Message getBatchBuffer(uint32_t logIndex,
+                                   const std::vector<uint32_t> &sampleIndices,
+                                   int64_t messageCounter,
+                                   bool patchable = false) const;
+
+private:
+  uint64_t m_runStartNanosecondsPastUnixEpoch = 0;
+  std::vector<std::string> m_names;
+  std::unordered_map<std::string, uint32_t> m_nameIDs;
+  std::vector<SampleEnvironmentLog> m_logs;
+
+  /// Samples of frame n are m_samples[m_frameOffsets[n]] up to, but not
+  /// including, m_samples[m_frameOffsets[n + 1]]
+  std::vector<size_t> m_frameOffsets;
+  /// Grouped by frame, in frame order
+  std::vector<SampleEnvironmentSample> m_samples;
+  /// Frame number of each sample in m_samples, only held until the index is
+  /// built
+  std::vector<size_t> m_sampleFrameNumbers;
+};
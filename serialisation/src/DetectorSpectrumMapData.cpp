@@ -1,10 +1,118 @@
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <flatbuffers/flatbuffers.h>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <pl72_run_start_generated.h>
-#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "DetectorSpectrumMapData.h"
 
+namespace {
+const char cacheMagic[8] = {'N', 'S', 'D', 'S', 'M', 'A', 'P', '\0'};
+const uint32_t cacheVersion = 2;
+
+/// Start of the binary cache file, followed by the detector numbers and then
+/// the spectrum numbers
+struct CacheHeader {
+  char magic[8];
+  uint32_t version;
+  int32_t numberOfEntries;
+  /// Size and modification time (in nanoseconds) of the text file the cache
+  /// was made from
+  uint64_t textFileSize;
+  int64_t textModifiedTimeNs;
+};
+
+bool getFileStatus(const std::string &filename, uint64_t &sizeOutput,
+                   int64_t &modifiedTimeNsOutput) {
+  struct stat fileStatus {};
+  if (stat(filename.c_str(), &fileStatus) != 0) {
+    return false;
+  }
+  sizeOutput = static_cast<uint64_t>(fileStatus.st_size);
+  modifiedTimeNsOutput =
+      static_cast<int64_t>(fileStatus.st_mtim.tv_sec) * 1000000000 +
+      static_cast<int64_t>(fileStatus.st_mtim.tv_nsec);
+  return true;
+}
+
+void skipLine(const char *&position, const char *end) {
+  const auto newline = static_cast<const char *>(
+      std::memchr(position, '\n', static_cast<size_t>(end - position)));
+  position = newline == nullptr ? end : newline + 1;
+}
+
+bool isSpaceInLine(const char character) {
+  return character == ' ' || character == '\t' || character == '\r';
+}
+
+/**
+ * Move past the rest of a line, which must only contain whitespace
+ *
+ * @param position - where to start, moved to the start of the next line
+ * @param end - end of the text
+ * @return - false if there is anything else before the end of the line
+ */
+bool skipEndOfLine(const char *&position, const char *end) {
+  while (position != end && isSpaceInLine(*position)) {
+    ++position;
+  }
+  if (position == end) {
+    return true;
+  }
+  if (*position != '\n') {
+    return false;
+  }
+  ++position;
+  return true;
+}
+
+/**
+ * Parse a decimal integer after any spaces on the same line, std::from_chars
+ * would do this but needs C++17
+ *
+ * @param position - where to start parsing, moved past the integer
+ * @param end - end of the text
+ * @param valueOutput - the integer
+ * @return - false if there is no integer or it does not fit in 32 bits
+ */
+bool parseInteger(const char *&position, const char *end,
+                  int32_t &valueOutput) {
+  while (position != end && isSpaceInLine(*position)) {
+    ++position;
+  }
+  const bool negative = position != end && *position == '-';
+  if (position != end && (*position == '-' || *position == '+')) {
+    ++position;
+  }
+  if (position == end || !std::isdigit(static_cast<unsigned char>(*position))) {
+    return false;
+  }
+  int64_t value = 0;
+  while (position != end &&
+         std::isdigit(static_cast<unsigned char>(*position))) {
+    value = value * 10 + (*position - '0');
+    if (value > static_cast<int64_t>(INT32_MAX) + 1) {
+      return false;
+    }
+    ++position;
+  }
+  value = negative ? -value : value;
+  if (value > INT32_MAX) {
+    return false;
+  }
+  valueOutput = static_cast<int32_t>(value);
+  // The integer must be followed by a separator, not more characters
+  return position == end || std::isspace(static_cast<unsigned char>(*position));
+}
+} // namespace
+
 bool file_exists(const std::string &name) {
   if (FILE *file = fopen(name.c_str(), "r")) {
     fclose(file);
@@ -35,30 +143,224 @@ DetectorSpectrumMapData::DetectorSpectrumMapData(
   std::copy(specFBVector->cbegin(), specFBVector->cend(), m_spectra.begin());
 }
 
+/**
+ * Parse the text map file, which has a line giving the number of entries
+ * between two header lines, then a detector number and spectrum number on
+ * each line. The file is memory mapped and parsed in place.
+ *
+ * @param filename - full path of the map file
+ * @throw std::runtime_error - if a line does not contain exactly two integers
+ * or there are fewer lines than the number of entries
+ */
 void DetectorSpectrumMapData::readFile(const std::string &filename) {
-  std::ifstream infile(filename);
-  std::string line;
-  std::getline(infile, line); // discard first line
-  std::getline(infile, line); // line with the number of entries
-  std::istringstream iss(line);
-  iss >> m_numberOfEntries;
+  const auto fileDescriptor = open(filename.c_str(), O_RDONLY);
+  struct stat fileStatus {};
+  if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStatus) != 0) {
+    if (fileDescriptor >= 0) {
+      close(fileDescriptor);
+    }
+    throw std::runtime_error("Failed to open " + filename);
+  }
+  const auto fileSize = static_cast<size_t>(fileStatus.st_size);
+  if (fileSize == 0) {
+    close(fileDescriptor);
+    return;
+  }
+  auto mapping =
+      mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Failed to map " + filename);
+  }
+  madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+  const auto *position = static_cast<const char *>(mapping);
+  const auto end = position + fileSize;
+  skipLine(position, end); // discard first line
+  if (!parseInteger(position, end, m_numberOfEntries) ||
+      m_numberOfEntries < 0) {
+    m_numberOfEntries = 0;
+  }
+  skipLine(position, end); // rest of the line with the number of entries
+  skipLine(position, end); // discard third line
   m_detectors.resize(static_cast<size_t>(m_numberOfEntries));
   m_spectra.resize(static_cast<size_t>(m_numberOfEntries));
-  std::getline(infile, line); // discard third line
-  size_t entryNumber = 0;
-  while (std::getline(infile, line)) {
-    std::istringstream isstream(line);
-    if (!(isstream >> m_detectors[entryNumber] >> m_spectra[entryNumber])) {
-      break;
-    } // error
+  for (size_t entryNumber = 0; entryNumber < m_detectors.size();
+       ++entryNumber) {
+    if (!parseInteger(position, end, m_detectors[entryNumber]) ||
+        !parseInteger(position, end, m_spectra[entryNumber]) ||
+        !skipEndOfLine(position, end)) {
+      munmap(mapping, fileSize);
+      // The entries start on the fourth line
+      throw std::runtime_error(
+          filename + " line " + std::to_string(entryNumber + 4) +
+          " must contain a detector number and a spectrum number");
+    }
+  }
+  munmap(mapping, fileSize);
+}
 
-    entryNumber++;
+DetectorSpectrumMapData
+DetectorSpectrumMapData::load(const std::string &filename) {
+  DetectorSpectrumMapData detSpecMap;
+  if (detSpecMap.readCacheFile(filename)) {
+    return detSpecMap;
+  }
+  detSpecMap = DetectorSpectrumMapData(filename);
+  detSpecMap.writeCacheFile(filename);
+  return detSpecMap;
+}
+
+/**
+ * Load a map file, or return the map loaded by an earlier call if the size
+ * and modification time of the file are unchanged. If they have changed the
+ * file is read again, but the earlier map is still returned if the contents
+ * hash the same, so that touching or re-saving the file changes nothing.
+ *
+ * @param filename - full path of the map file
+ * @return - the map, a new object only if its contents changed
+ */
+std::shared_ptr<const DetectorSpectrumMapData>
+DetectorSpectrumMapData::loadShared(const std::string &filename) {
+  struct LoadedMap {
+    std::shared_ptr<const DetectorSpectrumMapData> detSpecMap;
+    uint64_t fileSize = 0;
+    int64_t modifiedTimeNs = 0;
+    uint64_t contentHash = 0;
+  };
+  static std::mutex loadedMapsMutex;
+  static std::map<std::string, LoadedMap> loadedMaps;
+  std::lock_guard<std::mutex> lock(loadedMapsMutex);
+  auto &loadedMap = loadedMaps[filename];
+  uint64_t fileSize = 0;
+  int64_t modifiedTimeNs = 0;
+  const bool haveFileStatus = getFileStatus(filename, fileSize, modifiedTimeNs);
+  // Keep using the loaded map if the file has been removed since
+  if (loadedMap.detSpecMap != nullptr &&
+      (!haveFileStatus || (fileSize == loadedMap.fileSize &&
+                           modifiedTimeNs == loadedMap.modifiedTimeNs))) {
+    return loadedMap.detSpecMap;
+  }
+  auto detSpecMap =
+      std::make_shared<const DetectorSpectrumMapData>(load(filename));
+  const auto contentHash = detSpecMap->getContentHash();
+  if (loadedMap.detSpecMap == nullptr || contentHash != loadedMap.contentHash) {
+    loadedMap.detSpecMap = std::move(detSpecMap);
+    loadedMap.contentHash = contentHash;
+  }
+  loadedMap.fileSize = fileSize;
+  loadedMap.modifiedTimeNs = modifiedTimeNs;
+  return loadedMap.detSpecMap;
+}
+
+std::string
+DetectorSpectrumMapData::getCacheFilename(const std::string &filename) {
+  return filename + ".detspec.bin";
+}
+
+/**
+ * Read the binary cache of a map file
+ *
+ * @param filename - full path of the text map file
+ * @return - false if there is no cache or it does not match the text file
+ */
+bool DetectorSpectrumMapData::readCacheFile(const std::string &filename) {
+  uint64_t textFileSize;
+  int64_t textModifiedTimeNs;
+  if (!getFileStatus(filename, textFileSize, textModifiedTimeNs)) {
+    return false;
+  }
+  std::ifstream cacheFile(getCacheFilename(filename), std::ios::binary);
+  CacheHeader header{};
+  if (!cacheFile.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+      header.version != cacheVersion || header.textFileSize != textFileSize ||
+      header.textModifiedTimeNs != textModifiedTimeNs ||
+      header.numberOfEntries < 0) {
+    return false;
+  }
+  std::vector<int32_t> detectors(static_cast<size_t>(header.numberOfEntries));
+  std::vector<int32_t> spectra(detectors.size());
+  const auto arraySize =
+      static_cast<std::streamsize>(detectors.size() * sizeof(int32_t));
+  if (!cacheFile.read(reinterpret_cast<char *>(detectors.data()), arraySize) ||
+      !cacheFile.read(reinterpret_cast<char *>(spectra.data()), arraySize)) {
+    return false;
+  }
+  m_numberOfEntries = header.numberOfEntries;
+  m_detectors = std::move(detectors);
+  m_spectra = std::move(spectra);
+  return true;
+}
+
+/**
+ * Write the binary cache of a map file, failing to write it is not an error
+ * as the text file can still be read, for example if its directory is read
+ * only
+ *
+ * @param filename - full path of the text map file
+ */
+void DetectorSpectrumMapData::writeCacheFile(
+    const std::string &filename) const {
+  CacheHeader header{};
+  std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+  header.version = cacheVersion;
+  header.numberOfEntries = m_numberOfEntries;
+  if (!getFileStatus(filename, header.textFileSize,
+                     header.textModifiedTimeNs)) {
+    return;
+  }
+
+  // Write to a temporary file and rename so that a partially written cache
+  // is never used
+  const auto cacheFilename = getCacheFilename(filename);
+  const auto temporaryFilename = cacheFilename + ".tmp";
+  bool written;
+  {
+    std::ofstream cacheFile(temporaryFilename, std::ios::binary);
+    cacheFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    cacheFile.write(reinterpret_cast<const char *>(m_detectors.data()),
+                    m_detectors.size() * sizeof(int32_t));
+    cacheFile.write(reinterpret_cast<const char *>(m_spectra.data()),
+                    m_spectra.size() * sizeof(int32_t));
+    written = static_cast<bool>(cacheFile);
+  }
+  if (!written ||
+      std::rename(temporaryFilename.c_str(), cacheFilename.c_str()) != 0) {
+    std::remove(temporaryFilename.c_str());
   }
 }
 
 flatbuffers::Offset<SpectraDetectorMapping>
-DetectorSpectrumMapData::addToBuffer(flatbuffers::FlatBufferBuilder &builder) {
+DetectorSpectrumMapData::addToBuffer(
+    flatbuffers::FlatBufferBuilder &builder) const {
   return CreateSpectraDetectorMapping(builder, builder.CreateVector(m_spectra),
                                       builder.CreateVector(m_detectors),
                                       m_numberOfEntries);
 }
+
+Streamer::Message DetectorSpectrumMapData::getBuffer() const {
+  flatbuffers::FlatBufferBuilder builder;
+  FinishSpectraDetectorMappingBuffer(builder, addToBuffer(builder));
+  return Streamer::Message(builder.Release());
+}
+
+/**
+ * 64-bit FNV-1a hash of the number of entries and the detector and spectrum
+ * numbers
+ *
+ * @return - the hash
+ */
+uint64_t DetectorSpectrumMapData::getContentHash() const {
+  uint64_t hash = 14695981039346656037ULL;
+  const auto addToHash = [&hash](const void *data, size_t size) {
+    const auto bytes = static_cast<const uint8_t *>(data);
+    for (size_t index = 0; index < size; ++index) {
+      hash = (hash ^ bytes[index]) * 1099511628211ULL;
+    }
+  };
+  addToHash(&m_numberOfEntries, sizeof(m_numberOfEntries));
+  addToHash(m_detectors.data(), m_detectors.size() * sizeof(int32_t));
+  addToHash(m_spectra.data(), m_spectra.size() * sizeof(int32_t));
+  return hash;
+}
@@ -0,0 +1,43 @@
+#include <ev44_events_generated.h>
+
+#include "../../core/include/Message.h"
+#include "EventBatch.h"
+
+void EventBatch::addPulse(const uint64_t pulseTime,
+                          const std::vector<uint32_t> &detIds,
+                          const std::vector<uint32_t> &tofs) {
+  // Each NXevent_data group of a frame is added separately
+  if (empty() || getLastPulseTime() != pulseTime) {
+    m_referenceTimes.push_back(static_cast<int64_t>(pulseTime));
+    m_referenceTimeIndices.push_back(static_cast<int32_t>(m_tof.size()));
+  }
+  // ev44 stores detector IDs and times-of-flight as signed integers
+  m_detId.insert(m_detId.end(), detIds.cbegin(), detIds.cend());
+  m_tof.insert(m_tof.end(), tofs.cbegin(), tofs.cend());
+}
+
+void EventBatch::clear() {
+  m_referenceTimes.clear();
+  m_referenceTimeIndices.clear();
+  m_tof.clear();
+  m_detId.clear();
+}
+
+Streamer::Message EventBatch::getBuffer(const int64_t messageID,
+                                       const bool patchable) const {
+  flatbuffers::FlatBufferBuilder builder;
+  builder.ForceDefaults(patchable);
+
+  auto sourceStr = builder.CreateString("NeXus-Streamer");
+  auto referenceTimeData = builder.CreateVector(m_referenceTimes);
+  auto referenceTimeIndexData = builder.CreateVector(m_referenceTimeIndices);
+  auto tofData = builder.CreateVector(m_tof);
+  auto detIDData = builder.CreateVector(m_detId);
+
+  auto eventMessage = CreateEvent44Message(
+      builder, sourceStr, messageID, referenceTimeData, referenceTimeIndexData,
+      tofData, detIDData);
+  FinishEvent44MessageBuffer(builder, eventMessage);
+
+  return Streamer::Message(builder.Release());
+}
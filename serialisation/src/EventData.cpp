@@ -27,8 +27,10 @@ bool EventData::decodeMessage(const uint8_t *buf) {
   return false; // this is not an ISIS facility event message
 }
 
-Streamer::Message EventData::getBuffer(uint64_t messageID) {
+Streamer::Message EventData::getBuffer(uint64_t messageID,
+                                       const bool patchable) {
   flatbuffers::FlatBufferBuilder builder;
+  builder.ForceDefaults(patchable);
 
   auto isisDataMessage =
       CreateISISData(builder, m_period, RunState::RUNNING, m_protonCharge);
@@ -0,0 +1,56 @@
+#include <ev42_events_generated.h>
+#include <ev44_events_generated.h>
+#include <f142_logdata_generated.h>
+#include <se00_data_generated.h>
+
+#include "MessagePatching.h"
+
+namespace {
+template <typename T>
+void shiftVector(flatbuffers::Vector<T> *values, int64_t shift) {
+  if (values == nullptr) {
+    return;
+  }
+  for (flatbuffers::uoffset_t index = 0; index < values->size(); ++index) {
+    values->Mutate(index, static_cast<T>(values->Get(index) + shift));
+  }
+}
+} // namespace
+
+/**
+ * Shift the timestamps and message ID of a serialised message in place using
+ * the flatbuffers mutation API. Fields can only be mutated if they are present
+ * in the buffer, so the messages must be serialised as patchable, with default
+ * values forced.
+ *
+ * @param buffer - the serialised message
+ * @param timeShiftNs - amount to add to each timestamp in nanoseconds
+ * @param messageIDShift - amount to add to the message ID, if the message has
+ * one
+ * @return - false if the message could not be patched
+ */
+bool patchMessage(uint8_t *buffer, const int64_t timeShiftNs,
+                  const int64_t messageIDShift) {
+  if (flatbuffers::BufferHasIdentifier(buffer, EventMessageIdentifier())) {
+    auto message = GetMutableEventMessage(buffer);
+    return message->mutate_pulse_time(message->pulse_time() + timeShiftNs) &&
+           message->mutate_message_id(message->message_id() + messageIDShift);
+  }
+  if (flatbuffers::BufferHasIdentifier(buffer, Event44MessageIdentifier())) {
+    auto message = GetMutableEvent44Message(buffer);
+    shiftVector(message->mutable_reference_time(), timeShiftNs);
+    return message->mutate_message_id(message->message_id() + messageIDShift);
+  }
+  if (flatbuffers::BufferHasIdentifier(buffer, LogDataIdentifier())) {
+    auto message = GetMutableLogData(buffer);
+    return message->mutate_timestamp(message->timestamp() + timeShiftNs);
+  }
+  if (flatbuffers::BufferHasIdentifier(buffer,
+                                       SampleEnvironmentDataIdentifier())) {
+    auto message = GetMutableSampleEnvironmentData(buffer);
+    shiftVector(message->mutable_timestamps(), timeShiftNs);
+    return message->mutate_packet_timestamp(message->packet_timestamp() +
+                                            timeShiftNs);
+  }
+  return false;
+}
@@ -1,6 +1,10 @@
 #include <6s4t_run_stop_generated.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <pl72_run_start_generated.h>
 #include <sstream>
+#include <stdexcept>
 
 #include "DetectorSpectrumMapData.h"
 #include "RunData.h"
@@ -21,25 +25,16 @@ uint64_t timeStringToUint64(const std::string &inputTime) {
   auto nsSinceEpoch = secondsToMilliseconds(timegm(&tmb));
   return nsSinceEpoch;
 }
-} // namespace
 
-void RunData::setStartTimeFromString(const std::string &inputTime) {
-  startTime = timeStringToUint64(inputTime);
-}
-
-void RunData::setStartTimeInSeconds(time_t inputTime) {
-  startTime = secondsToMilliseconds(inputTime);
-}
-
-void RunData::setStopTimeFromString(const std::string &inputTime) {
-  stopTime = timeStringToUint64(inputTime);
-}
-
-Streamer::Message serialiseRunStartMessage(
-    const RunData &runData,
-    const nonstd::optional<DetectorSpectrumMapData> &detSpecMap) {
-  flatbuffers::FlatBufferBuilder builder;
+/// Space reserved in a run start message template for the fields which are
+/// patched for each run
+const size_t runNameCapacity = 64;
+const size_t jobIDCapacity = 64;
+const size_t filenameCapacity = 256;
 
+void buildRunStartMessage(flatbuffers::FlatBufferBuilder &builder,
+                          const RunData &runData,
+                          const DetectorSpectrumMapData *detSpecMap) {
   const auto instrumentName = builder.CreateString(runData.instrumentName);
   const auto runID = builder.CreateString(runData.runID);
   const auto nexusStructure = builder.CreateString(runData.nexusStructure);
@@ -49,12 +44,11 @@ Streamer::Message serialiseRunStartMessage(
   const auto filename = builder.CreateString(runData.filename);
 
   flatbuffers::Offset<RunStart> messageRunStart;
-  if (detSpecMap) {
-    auto detectorSpectrumMap = *detSpecMap;
+  if (detSpecMap != nullptr) {
     messageRunStart = CreateRunStart(
         builder, runData.startTime, runData.stopTime, runID, instrumentName,
         nexusStructure, jobID, broker, serviceID, filename,
-        runData.numberOfPeriods, detectorSpectrumMap.addToBuffer(builder));
+        runData.numberOfPeriods, detSpecMap->addToBuffer(builder));
   } else {
     messageRunStart =
         CreateRunStart(builder, runData.startTime, runData.stopTime, runID,
@@ -63,7 +57,27 @@ Streamer::Message serialiseRunStartMessage(
   }
 
   FinishRunStartBuffer(builder, messageRunStart);
+}
+} // namespace
 
+void RunData::setStartTimeFromString(const std::string &inputTime) {
+  startTime = timeStringToUint64(inputTime);
+}
+
+void RunData::setStartTimeInSeconds(time_t inputTime) {
+  startTime = secondsToMilliseconds(inputTime);
+}
+
+void RunData::setStopTimeFromString(const std::string &inputTime) {
+  stopTime = timeStringToUint64(inputTime);
+}
+
+Streamer::Message serialiseRunStartMessage(
+    const RunData &runData,
+    const nonstd::optional<DetectorSpectrumMapData> &detSpecMap) {
+  flatbuffers::FlatBufferBuilder builder;
+  buildRunStartMessage(builder, runData,
+                       detSpecMap ? &detSpecMap.value() : nullptr);
   return Streamer::Message(builder.Release());
 }
 
@@ -108,3 +122,95 @@ RunData deserialiseRunStopMessage(const uint8_t *buffer) {
 
   return runData;
 }
+
+/**
+ * Serialise a run start message with space reserved in the fields which
+ * change from run to run
+ *
+ * @param runData - information about the run, the fields which are not patched
+ * for each run are taken from this
+ * @param detSpecMap - detector-spectrum map to include in the message, or
+ * nullptr
+ */
+RunStartMessageTemplate::RunStartMessageTemplate(
+    const RunData &runData,
+    std::shared_ptr<const DetectorSpectrumMapData> detSpecMap)
+    : m_detSpecMap(std::move(detSpecMap)) {
+  build(runData);
+}
+
+/**
+ * Serialise the template, reserving at least the default capacity for each
+ * string which is patched, or more if the current value is longer
+ *
+ * @param runData - information about the run
+ */
+void RunStartMessageTemplate::build(const RunData &runData) {
+  auto templateRunData = runData;
+  templateRunData.runID =
+      std::string(std::max(runNameCapacity, runData.runID.size()), ' ');
+  templateRunData.jobID =
+      std::string(std::max(jobIDCapacity, runData.jobID.size()), ' ');
+  templateRunData.filename =
+      std::string(std::max(filenameCapacity, runData.filename.size()), ' ');
+
+  // The start time can only be patched if it is present in the buffer, so it
+  // must not be the default of zero
+  templateRunData.startTime = std::numeric_limits<uint64_t>::max();
+
+  flatbuffers::FlatBufferBuilder builder;
+  buildRunStartMessage(builder, templateRunData, m_detSpecMap.get());
+  m_buffer = builder.Release();
+
+  const auto runStart = GetRunStart(m_buffer.data());
+  m_runName =
+      findStringField(runStart->run_name(), templateRunData.runID.size());
+  m_jobID = findStringField(runStart->job_id(), templateRunData.jobID.size());
+  m_filename =
+      findStringField(runStart->filename(), templateRunData.filename.size());
+}
+
+/**
+ * Patch the fields of the template and copy it, the template is serialised
+ * again with more space if a string does not fit
+ *
+ * @param runData - information about the run
+ * @return - the run start message
+ */
+Streamer::Message
+RunStartMessageTemplate::createMessage(const RunData &runData) {
+  if (runData.runID.size() > m_runName.capacity ||
+      runData.jobID.size() > m_jobID.capacity ||
+      runData.filename.size() > m_filename.capacity) {
+    build(runData);
+  }
+  GetMutableRunStart(m_buffer.data())->mutate_start_time(runData.startTime);
+  patchString(m_runName, runData.runID);
+  patchString(m_jobID, runData.jobID);
+  patchString(m_filename, runData.filename);
+  return Streamer::Message::fromCopy(m_buffer.data(), m_buffer.size());
+}
+
+RunStartMessageTemplate::StringField
+RunStartMessageTemplate::findStringField(const flatbuffers::String *string,
+                                         const size_t capacity) const {
+  const auto characters = reinterpret_cast<const uint8_t *>(string->c_str());
+  return {static_cast<size_t>(characters - m_buffer.data()), capacity};
+}
+
+/**
+ * Replace the value of a string in the buffer, the string can be shorter than
+ * the space reserved for it but not longer
+ *
+ * @param field - location of the string
+ * @param value - the new value
+ */
+void RunStartMessageTemplate::patchString(const StringField &field,
+                                          const std::string &value) {
+  auto characters = m_buffer.data() + field.offset;
+  flatbuffers::WriteScalar(characters - sizeof(flatbuffers::uoffset_t),
+                           static_cast<flatbuffers::uoffset_t>(value.size()));
+  std::memcpy(characters, value.data(), value.size());
+  // The string must be null terminated, the rest of the space is unused
+  std::memset(characters + value.size(), 0, field.capacity - value.size() + 1);
+}
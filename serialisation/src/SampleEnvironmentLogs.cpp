@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <f142_logdata_generated.h>
+#include <numeric>
+#include <se00_data_generated.h>
+
+#include "SampleEnvironmentLogs.h"
+
+namespace {
+/// Maps each log value type to its f142 union member at compile time
+template <typename T> struct LogDataValue;
+
+template <> struct LogDataValue<double> {
+  static constexpr Value type = Value::Double;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder, double value) {
+    return CreateDouble(builder, value).Union();
+  }
+};
+
+template <> struct LogDataValue<int32_t> {
+  static constexpr Value type = Value::Int;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder, int32_t value) {
+    return CreateInt(builder, value).Union();
+  }
+};
+
+template <> struct LogDataValue<int64_t> {
+  static constexpr Value type = Value::Long;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder, int64_t value) {
+    return CreateLong(builder, value).Union();
+  }
+};
+
+template <> struct LogDataValue<uint32_t> {
+  static constexpr Value type = Value::UInt;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder, uint32_t value) {
+    return CreateUInt(builder, value).Union();
+  }
+};
+
+template <> struct LogDataValue<uint64_t> {
+  static constexpr Value type = Value::ULong;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder, uint64_t value) {
+    return CreateULong(builder, value).Union();
+  }
+};
+
+template <typename T>
+Streamer::Message serialiseLogData(const std::string &name, T value,
+                                   uint64_t timestamp, bool patchable) {
+  flatbuffers::FlatBufferBuilder builder;
+  builder.ForceDefaults(patchable);
+
+  auto nameOffset = builder.CreateString(name);
+  auto valueOffset = LogDataValue<T>::create(builder, value);
+  auto logData = CreateLogData(builder, nameOffset, LogDataValue<T>::type,
+                               valueOffset, timestamp);
+  FinishLogDataBuffer(builder, logData);
+
+  return Streamer::Message(builder.Release());
+}
+
+/// Maps each log value type to its se00 array union member at compile time
+template <typename T> struct SampleEnvironmentDataValues;
+
+template <> struct SampleEnvironmentDataValues<double> {
+  static constexpr ValueUnion type = ValueUnion::DoubleArray;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder,
+         flatbuffers::Offset<flatbuffers::Vector<double>> values) {
+    return CreateDoubleArray(builder, values).Union();
+  }
+};
+
+template <> struct SampleEnvironmentDataValues<int32_t> {
+  static constexpr ValueUnion type = ValueUnion::Int32Array;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder,
+         flatbuffers::Offset<flatbuffers::Vector<int32_t>> values) {
+    return CreateInt32Array(builder, values).Union();
+  }
+};
+
+template <> struct SampleEnvironmentDataValues<int64_t> {
+  static constexpr ValueUnion type = ValueUnion::Int64Array;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder,
+         flatbuffers::Offset<flatbuffers::Vector<int64_t>> values) {
+    return CreateInt64Array(builder, values).Union();
+  }
+};
+
+template <> struct SampleEnvironmentDataValues<uint32_t> {
+  static constexpr ValueUnion type = ValueUnion::UInt32Array;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder,
+         flatbuffers::Offset<flatbuffers::Vector<uint32_t>> values) {
+    return CreateUInt32Array(builder, values).Union();
+  }
+};
+
+template <> struct SampleEnvironmentDataValues<uint64_t> {
+  static constexpr ValueUnion type = ValueUnion::UInt64Array;
+  static flatbuffers::Offset<void>
+  create(flatbuffers::FlatBufferBuilder &builder,
+         flatbuffers::Offset<flatbuffers::Vector<uint64_t>> values) {
+    return CreateUInt64Array(builder, values).Union();
+  }
+};
+
+template <typename T>
+Streamer::Message
+serialiseSampleEnvironmentData(const std::string &name,
+                               const std::vector<T> &values,
+                               const std::vector<int64_t> &timestamps,
+                               int64_t messageCounter, bool patchable) {
+  flatbuffers::FlatBufferBuilder builder;
+  builder.ForceDefaults(patchable);
+
+  auto nameOffset = builder.CreateString(name);
+  auto valuesOffset = SampleEnvironmentDataValues<T>::create(
+      builder, builder.CreateVector(values));
+  auto timestampsOffset = builder.CreateVector(timestamps);
+  // Samples from an NXlog are not evenly spaced, so the time delta is set
+  // negative to indicate it should be ignored in favour of the timestamps
+  const double timeDelta = -1.0;
+  auto sampleEnvData = CreateSampleEnvironmentData(
+      builder, nameOffset, 0, timestamps.front(), timeDelta, Location::Unknown,
+      SampleEnvironmentDataValues<T>::type, valuesOffset, timestampsOffset,
+      messageCounter);
+  FinishSampleEnvironmentDataBuffer(builder, sampleEnvData);
+
+  return Streamer::Message(builder.Release());
+}
+} // namespace
+
+uint32_t SampleEnvironmentLogs::internName(const std::string &name) {
+  auto existing = m_nameIDs.find(name);
+  if (existing != m_nameIDs.end()) {
+    return existing->second;
+  }
+  auto nameID = static_cast<uint32_t>(m_names.size());
+  m_names.push_back(name);
+  m_nameIDs.emplace(name, nameID);
+  return nameID;
+}
+
+uint32_t SampleEnvironmentLogs::addLog(SampleEnvironmentLog log) {
+  m_logs.push_back(std::move(log));
+  return static_cast<uint32_t>(m_logs.size() - 1);
+}
+
+void SampleEnvironmentLogs::addSample(size_t frameNumber,
+                                      SampleEnvironmentSample sample) {
+  m_samples.push_back(sample);
+  m_sampleFrameNumbers.push_back(frameNumber);
+}
+
+/**
+ * Group the samples by frame number with a counting sort, preserving the order
+ * in which they were added within each frame
+ */
+void SampleEnvironmentLogs::buildFrameIndex() {
+  size_t numberOfFrames = 0;
+  if (!m_sampleFrameNumbers.empty()) {
+    numberOfFrames = *std::max_element(m_sampleFrameNumbers.cbegin(),
+                                       m_sampleFrameNumbers.cend()) +
+                     1;
+  }
+
+  m_frameOffsets.assign(numberOfFrames + 1, 0);
+  for (auto frameNumber : m_sampleFrameNumbers) {
+    ++m_frameOffsets[frameNumber + 1];
+  }
+  std::partial_sum(m_frameOffsets.cbegin(), m_frameOffsets.cend(),
+                   m_frameOffsets.begin());
+
+  std::vector<size_t> nextPositionInFrame(m_frameOffsets.cbegin(),
+                                          m_frameOffsets.cend() - 1);
+  std::vector<SampleEnvironmentSample> sortedSamples(m_samples.size());
+  for (size_t sampleNumber = 0; sampleNumber < m_samples.size();
+       ++sampleNumber) {
+    auto frameNumber = m_sampleFrameNumbers[sampleNumber];
+    sortedSamples[nextPositionInFrame[frameNumber]++] = m_samples[sampleNumber];
+  }
+  m_samples = std::move(sortedSamples);
+  m_sampleFrameNumbers.clear();
+  m_sampleFrameNumbers.shrink_to_fit();
+}
+
+SampleEnvironmentSampleRange
+SampleEnvironmentLogs::getSamplesInFrame(size_t frameNumber) const {
+  if (frameNumber + 1 >= m_frameOffsets.size()) {
+    return {};
+  }
+  return {m_samples.data() + m_frameOffsets[frameNumber],
+          m_samples.data() + m_frameOffsets[frameNumber + 1]};
+}
+
+uint64_t SampleEnvironmentLogs::getTimestamp(
+    const SampleEnvironmentSample &sample) const {
+  auto time = m_logs[sample.logIndex].times[sample.sampleIndex];
+  auto nanosecondsPastRunStart = static_cast<uint64_t>(time * 1e9);
+  return nanosecondsPastRunStart + m_runStartNanosecondsPastUnixEpoch;
+}
+
+Streamer::Message
+SampleEnvironmentLogs::getBuffer(const SampleEnvironmentSample &sample,
+                                 const bool patchable) const {
+  const auto &log = m_logs[sample.logIndex];
+  const auto &name = m_names[log.nameID];
+  const auto timestamp = getTimestamp(sample);
+  return nonstd::visit(
+      [&name, &sample, timestamp, patchable](const auto &values) {
+        return serialiseLogData(name, values[sample.sampleIndex], timestamp,
+                                patchable);
+      },
+      log.values);
+}
+
+Streamer::Message SampleEnvironmentLogs::getBatchBuffer(
+    uint32_t logIndex, const std::vector<uint32_t> &sampleIndices,
+    int64_t messageCounter, const bool patchable) const {
+  const auto &log = m_logs[logIndex];
+  const auto &name = m_names[log.nameID];
+
+  std::vector<int64_t> timestamps(sampleIndices.size());
+  std::transform(sampleIndices.cbegin(), sampleIndices.cend(),
+                 timestamps.begin(), [this, logIndex](uint32_t sampleIndex) {
+                   return static_cast<int64_t>(
+                       getTimestamp({logIndex, sampleIndex}));
+                 });
+
+  return nonstd::visit(
+      [&name, &sampleIndices, &timestamps, messageCounter,
+       patchable](const auto &values) {
+        using ValueType = typename std::decay_t<decltype(values)>::value_type;
+        std::vector<ValueType> batchValues(sampleIndices.size());
+        std::transform(sampleIndices.cbegin(), sampleIndices.cend(),
+                       batchValues.begin(),
+                       [&values](uint32_t sampleIndex) {
+                         return values[sampleIndex];
+                       });
+        return serialiseSampleEnvironmentData(name, batchValues, timestamps,
+                                              messageCounter, patchable);
+      },
+      log.values);
+}
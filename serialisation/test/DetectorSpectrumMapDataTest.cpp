@@ -1,9 +1,42 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
 
 #include "../include/DetectorSpectrumMapData.h"
 
 class DetectorSpectrumMapDataTest : public ::testing::Test {};
 
+/// Writes map files for tests which need to control their contents
+class DetectorSpectrumMapFileTest : public ::testing::Test {
+protected:
+  void TearDown() override {
+    std::remove(m_mapFilename.c_str());
+    std::remove(
+        DetectorSpectrumMapData::getCacheFilename(m_mapFilename).c_str());
+  }
+
+  void writeMapFile(const std::vector<std::pair<int32_t, int32_t>> &entries) {
+    writeMapFileContents(entries.size(), [&entries](std::ofstream &mapFile) {
+      for (const auto &entry : entries) {
+        mapFile << "  " << entry.first << "  " << entry.second << "\n";
+      }
+    });
+  }
+
+  template <typename WriteEntries>
+  void writeMapFileContents(const size_t numberOfEntries,
+                            WriteEntries writeEntries) {
+    std::ofstream mapFile(m_mapFilename);
+    mapFile << "Number_of_entries\n"
+            << numberOfEntries << "\nDetector  Spectrum\n";
+    writeEntries(mapFile);
+  }
+
+  const std::string m_mapFilename = "detector_spectrum_map_test.dat";
+};
+
 TEST(DetectorSpectrumMapDataTest, read_detector_spectrum_map_file) {
   extern std::string testDataPath;
   EXPECT_NO_THROW(
@@ -39,3 +72,116 @@ TEST(DetectorSpectrumMapDataTest, read_detector_spectrum_map_spectra) {
   EXPECT_EQ(9, spectra[8]);
   EXPECT_EQ(122888, spectra[122887]);
 }
+
+TEST_F(DetectorSpectrumMapFileTest, cache_is_written_and_used) {
+  writeMapFile({{10, 1}, {-20, 2}});
+  auto detSpecMap = DetectorSpectrumMapData::load(m_mapFilename);
+  EXPECT_EQ((std::vector<int32_t>{10, -20}), detSpecMap.getDetectors());
+  EXPECT_TRUE(std::ifstream(
+      DetectorSpectrumMapData::getCacheFilename(m_mapFilename)));
+
+  auto cachedMap = DetectorSpectrumMapData::load(m_mapFilename);
+  EXPECT_EQ(2, cachedMap.getNumberOfEntries());
+  EXPECT_EQ((std::vector<int32_t>{10, -20}), cachedMap.getDetectors());
+  EXPECT_EQ((std::vector<int32_t>{1, 2}), cachedMap.getSpectra());
+}
+
+TEST_F(DetectorSpectrumMapFileTest, cache_is_not_used_if_map_file_changed) {
+  writeMapFile({{10, 1}, {20, 2}});
+  DetectorSpectrumMapData::load(m_mapFilename);
+
+  writeMapFile({{10, 1}, {20, 2}, {30, 3}});
+  auto detSpecMap = DetectorSpectrumMapData::load(m_mapFilename);
+  EXPECT_EQ((std::vector<int32_t>{10, 20, 30}), detSpecMap.getDetectors());
+}
+
+TEST_F(DetectorSpectrumMapFileTest,
+       cache_is_not_used_if_map_file_changed_within_a_second) {
+  // Same size and same modification time in seconds, only nanoseconds differ
+  const auto setModifiedTime = [this](long nanoseconds) {
+    const timespec times[2] = {{1600000000, 0}, {1600000000, nanoseconds}};
+    utimensat(AT_FDCWD, m_mapFilename.c_str(), times, 0);
+  };
+  writeMapFile({{10, 1}, {20, 2}});
+  setModifiedTime(100);
+  DetectorSpectrumMapData::load(m_mapFilename);
+
+  writeMapFile({{10, 1}, {20, 3}});
+  setModifiedTime(200);
+  auto detSpecMap = DetectorSpectrumMapData::load(m_mapFilename);
+  EXPECT_EQ((std::vector<int32_t>{1, 3}), detSpecMap.getSpectra());
+}
+
+TEST_F(DetectorSpectrumMapFileTest, shared_map_is_only_loaded_once) {
+  writeMapFile({{10, 1}});
+  auto detSpecMap = DetectorSpectrumMapData::loadShared(m_mapFilename);
+  EXPECT_EQ(detSpecMap, DetectorSpectrumMapData::loadShared(m_mapFilename));
+}
+
+TEST_F(DetectorSpectrumMapFileTest,
+       shared_map_is_loaded_again_if_file_changed) {
+  writeMapFile({{10, 1}});
+  auto detSpecMap = DetectorSpectrumMapData::loadShared(m_mapFilename);
+
+  writeMapFile({{10, 1}, {20, 2}});
+  auto changedMap = DetectorSpectrumMapData::loadShared(m_mapFilename);
+  EXPECT_NE(detSpecMap, changedMap);
+  EXPECT_EQ((std::vector<int32_t>{10, 20}), changedMap->getDetectors());
+}
+
+TEST_F(DetectorSpectrumMapFileTest,
+       shared_map_is_kept_if_file_is_saved_with_the_same_contents) {
+  writeMapFile({{10, 1}, {20, 2}});
+  auto detSpecMap = DetectorSpectrumMapData::loadShared(m_mapFilename);
+
+  // Different size and modification time, but the same entries
+  writeMapFileContents(2, [](std::ofstream &mapFile) {
+    mapFile << "10 1\n20 2\n";
+  });
+  EXPECT_EQ(detSpecMap, DetectorSpectrumMapData::loadShared(m_mapFilename));
+}
+
+TEST_F(DetectorSpectrumMapFileTest, map_is_serialised_as_its_own_message) {
+  writeMapFile({{10, 1}, {20, 2}});
+  auto detSpecMap = DetectorSpectrumMapData(m_mapFilename);
+  auto message = detSpecMap.getBuffer();
+
+  auto receivedMap = DetectorSpectrumMapData(GetSpectraDetectorMapping(
+      reinterpret_cast<const uint8_t *>(message.data())));
+  EXPECT_EQ(detSpecMap.getDetectors(), receivedMap.getDetectors());
+  EXPECT_EQ(detSpecMap.getSpectra(), receivedMap.getSpectra());
+  EXPECT_EQ(detSpecMap.getContentHash(), receivedMap.getContentHash());
+}
+
+TEST_F(DetectorSpectrumMapFileTest, error_thrown_for_line_with_missing_column) {
+  writeMapFileContents(3, [](std::ofstream &mapFile) {
+    mapFile << "  10  1\n  20\n  30  3\n";
+  });
+  EXPECT_THROW(DetectorSpectrumMapData::load(m_mapFilename),
+               std::runtime_error);
+}
+
+TEST_F(DetectorSpectrumMapFileTest, error_thrown_for_line_with_extra_column) {
+  writeMapFileContents(2, [](std::ofstream &mapFile) {
+    mapFile << "  10  1  5\n  20  2\n";
+  });
+  EXPECT_THROW(DetectorSpectrumMapData::load(m_mapFilename),
+               std::runtime_error);
+}
+
+TEST_F(DetectorSpectrumMapFileTest, error_thrown_for_too_few_lines) {
+  writeMapFileContents(3, [](std::ofstream &mapFile) {
+    mapFile << "  10  1\n  20  2\n";
+  });
+  EXPECT_THROW(DetectorSpectrumMapData::load(m_mapFilename),
+               std::runtime_error);
+}
+
+TEST_F(DetectorSpectrumMapFileTest, windows_line_endings_are_accepted) {
+  writeMapFileContents(2, [](std::ofstream &mapFile) {
+    mapFile << "  10  1\r\n  20  2\r\n";
+  });
+  auto detSpecMap = DetectorSpectrumMapData(m_mapFilename);
+  EXPECT_EQ((std::vector<int32_t>{10, 20}), detSpecMap.getDetectors());
+  EXPECT_EQ((std::vector<int32_t>{1, 2}), detSpecMap.getSpectra());
+}
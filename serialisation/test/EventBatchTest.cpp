@@ -0,0 +1,77 @@
+#include <ev44_events_generated.h>
+#include <gtest/gtest.h>
+
+#include "../../core/include/Message.h"
+#include "EventBatch.h"
+
+class EventBatchTest : public ::testing::Test {};
+
+TEST(EventBatchTest, new_batch_is_empty) {
+  EventBatch batch;
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(0, batch.getNumberOfEvents());
+}
+
+TEST(EventBatchTest, pulses_are_serialised_with_reference_times) {
+  EventBatch batch;
+  batch.addPulse(1000, {1, 2, 3}, {10, 20, 30});
+  batch.addPulse(2000, {}, {});
+  batch.addPulse(3000, {4}, {40});
+  EXPECT_EQ(3, batch.getNumberOfPulses());
+  EXPECT_EQ(4, batch.getNumberOfEvents());
+  EXPECT_EQ(1000, batch.getFirstPulseTime());
+
+  auto buffer = batch.getBuffer(7);
+  auto messageData =
+      GetEvent44Message(reinterpret_cast<const uint8_t *>(buffer.data()));
+  EXPECT_EQ(7, messageData->message_id());
+  EXPECT_EQ("NeXus-Streamer", messageData->source_name()->str());
+
+  const std::vector<int64_t> expectedReferenceTimes{1000, 2000, 3000};
+  const std::vector<int32_t> expectedReferenceTimeIndices{0, 3, 3};
+  const std::vector<int32_t> expectedDetIds{1, 2, 3, 4};
+  const std::vector<int32_t> expectedTofs{10, 20, 30, 40};
+  EXPECT_EQ(expectedReferenceTimes,
+            std::vector<int64_t>(messageData->reference_time()->begin(),
+                                 messageData->reference_time()->end()));
+  EXPECT_EQ(expectedReferenceTimeIndices,
+            std::vector<int32_t>(messageData->reference_time_index()->begin(),
+                                 messageData->reference_time_index()->end()));
+  EXPECT_EQ(expectedDetIds,
+            std::vector<int32_t>(messageData->pixel_id()->begin(),
+                                 messageData->pixel_id()->end()));
+  EXPECT_EQ(expectedTofs,
+            std::vector<int32_t>(messageData->time_of_flight()->begin(),
+                                 messageData->time_of_flight()->end()));
+}
+
+TEST(EventBatchTest, events_with_the_same_pulse_time_share_a_pulse) {
+  EventBatch batch;
+  batch.addPulse(1000, {1, 2}, {10, 20});
+  batch.addPulse(1000, {3}, {30});
+  batch.addPulse(2000, {4}, {40});
+  batch.addPulse(2000, {5}, {50});
+  EXPECT_EQ(2, batch.getNumberOfPulses());
+  EXPECT_EQ(5, batch.getNumberOfEvents());
+  EXPECT_EQ(2000, batch.getLastPulseTime());
+
+  auto buffer = batch.getBuffer(0);
+  auto messageData =
+      GetEvent44Message(reinterpret_cast<const uint8_t *>(buffer.data()));
+  const std::vector<int64_t> expectedReferenceTimes{1000, 2000};
+  const std::vector<int32_t> expectedReferenceTimeIndices{0, 3};
+  EXPECT_EQ(expectedReferenceTimes,
+            std::vector<int64_t>(messageData->reference_time()->begin(),
+                                 messageData->reference_time()->end()));
+  EXPECT_EQ(expectedReferenceTimeIndices,
+            std::vector<int32_t>(messageData->reference_time_index()->begin(),
+                                 messageData->reference_time_index()->end()));
+}
+
+TEST(EventBatchTest, cleared_batch_is_empty) {
+  EventBatch batch;
+  batch.addPulse(1000, {1}, {10});
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(0, batch.getNumberOfEvents());
+}
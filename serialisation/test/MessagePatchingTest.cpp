@@ -0,0 +1,92 @@
+#include <ev42_events_generated.h>
+#include <ev44_events_generated.h>
+#include <f142_logdata_generated.h>
+#include <gtest/gtest.h>
+#include <se00_data_generated.h>
+
+#include "../../core/include/Message.h"
+#include "EventBatch.h"
+#include "EventData.h"
+#include "MessagePatching.h"
+#include "SampleEnvironmentLogs.h"
+
+class MessagePatchingTest : public ::testing::Test {};
+
+TEST(MessagePatchingTest, ev42_pulse_time_and_message_id_are_shifted) {
+  EventData events;
+  events.setDetId({1, 2, 3});
+  events.setTof({30, 20, 10});
+  events.setFrameTime(1000);
+  auto buffer = events.getBuffer(5, true);
+  auto data = reinterpret_cast<uint8_t *>(buffer.data());
+
+  EXPECT_TRUE(patchMessage(data, 500, 10));
+  auto message = GetEventMessage(data);
+  EXPECT_EQ(1500, message->pulse_time());
+  EXPECT_EQ(15, message->message_id());
+  EXPECT_EQ(3, message->detector_id()->size());
+}
+
+TEST(MessagePatchingTest, fields_with_default_values_can_be_patched) {
+  EventData events;
+  events.setDetId({1});
+  events.setTof({1});
+  auto buffer = events.getBuffer(0, true);
+  auto data = reinterpret_cast<uint8_t *>(buffer.data());
+
+  EXPECT_TRUE(patchMessage(data, 100, 1));
+  auto message = GetEventMessage(data);
+  EXPECT_EQ(100, message->pulse_time());
+  EXPECT_EQ(1, message->message_id());
+}
+
+TEST(MessagePatchingTest, fields_with_default_values_are_left_out_by_default) {
+  EventData events;
+  events.setDetId({1});
+  events.setTof({1});
+  auto buffer = events.getBuffer(0);
+  auto patchableBuffer = events.getBuffer(0, true);
+  EXPECT_LT(buffer.size(), patchableBuffer.size());
+  EXPECT_FALSE(patchMessage(reinterpret_cast<uint8_t *>(buffer.data()), 0, 1));
+}
+
+TEST(MessagePatchingTest, ev44_reference_times_and_message_id_are_shifted) {
+  EventBatch batch;
+  batch.addPulse(1000, {1}, {10});
+  batch.addPulse(2000, {2}, {20});
+  auto buffer = batch.getBuffer(3, true);
+  auto data = reinterpret_cast<uint8_t *>(buffer.data());
+
+  EXPECT_TRUE(patchMessage(data, -500, 1));
+  auto message = GetEvent44Message(data);
+  ASSERT_EQ(2, message->reference_time()->size());
+  EXPECT_EQ(500, message->reference_time()->Get(0));
+  EXPECT_EQ(1500, message->reference_time()->Get(1));
+  EXPECT_EQ(4, message->message_id());
+}
+
+TEST(MessagePatchingTest, sample_env_timestamps_are_shifted) {
+  SampleEnvironmentLogs logs(1000);
+  SampleEnvironmentLog log;
+  log.nameID = logs.internName("TEMP_1");
+  log.times = {0.1f, 0.2f};
+  log.values = std::vector<int64_t>{10, 20};
+  auto logIndex = logs.addLog(std::move(log));
+  logs.addSample(0, {logIndex, 0});
+  logs.buildFrameIndex();
+
+  auto f142Buffer = logs.getBuffer(*logs.getSamplesInFrame(0).begin(), true);
+  auto f142Data = reinterpret_cast<uint8_t *>(f142Buffer.data());
+  const auto f142Timestamp = GetLogData(f142Data)->timestamp();
+  EXPECT_TRUE(patchMessage(f142Data, 100, 1));
+  EXPECT_EQ(f142Timestamp + 100, GetLogData(f142Data)->timestamp());
+
+  auto se00Buffer = logs.getBatchBuffer(logIndex, {0, 1}, 0, true);
+  auto se00Data = reinterpret_cast<uint8_t *>(se00Buffer.data());
+  const auto firstTimestamp =
+      GetSampleEnvironmentData(se00Data)->timestamps()->Get(0);
+  EXPECT_TRUE(patchMessage(se00Data, 100, 1));
+  auto message = GetSampleEnvironmentData(se00Data);
+  EXPECT_EQ(firstTimestamp + 100, message->timestamps()->Get(0));
+  EXPECT_EQ(firstTimestamp + 100, message->packet_timestamp());
+}
@@ -117,3 +117,60 @@ TEST(RunDataTest, check_start_message_includes_file_identifier) {
   EXPECT_TRUE(flatbuffers::BufferHasIdentifier(
       reinterpret_cast<const uint8_t *>(runMessage.data()), runIdentifier));
 }
+
+TEST(RunDataTest, run_start_template_is_patched_for_each_run) {
+  auto runData = RunData();
+  runData.setStartTimeFromString("2016-08-11T08:50:18");
+  runData.runID = "1";
+  runData.instrumentName = "SANS2D";
+  runData.nexusStructure = "{\"children\": []}";
+  runData.jobID = "job1";
+  runData.filename = "FromNeXusStreamer_1.nxs";
+  RunStartMessageTemplate runStartTemplate(runData, nullptr);
+
+  // A longer run then a shorter one, so that strings grow and shrink
+  for (const auto &runID : {"1234", "2"}) {
+    runData.setStartTimeFromString("2016-08-12T09:00:00");
+    runData.runID = runID;
+    runData.jobID = std::string("job") + runID;
+    runData.filename = fmt::format("FromNeXusStreamer_{}.nxs", runID);
+
+    auto runStartMessage = runStartTemplate.createMessage(runData);
+    auto verifier = flatbuffers::Verifier(
+        reinterpret_cast<const uint8_t *>(runStartMessage.data()),
+        runStartMessage.size());
+    EXPECT_TRUE(VerifyRunStartBuffer(verifier));
+    auto outputRunData = deserialiseRunStartMessage(
+        reinterpret_cast<const uint8_t *>(runStartMessage.data()));
+    EXPECT_EQ(runData.startTime, outputRunData.startTime);
+    EXPECT_EQ(runData.runID, outputRunData.runID);
+    EXPECT_EQ(runData.jobID, outputRunData.jobID);
+    EXPECT_EQ(runData.filename, outputRunData.filename);
+    EXPECT_EQ(runData.instrumentName, outputRunData.instrumentName);
+    EXPECT_EQ(runData.nexusStructure, outputRunData.nexusStructure);
+  }
+}
+
+TEST(RunDataTest, run_start_template_grows_for_strings_which_do_not_fit) {
+  auto runData = RunData();
+  runData.nexusStructure = "{\"children\": []}";
+  RunStartMessageTemplate runStartTemplate(runData, nullptr);
+
+  // Longer than the space reserved in the template, then short again
+  for (const auto length : {1000, 1}) {
+    runData.runID = std::string(length, '1');
+    runData.jobID = std::string(length, 'j');
+    runData.filename = std::string(length, 'f');
+
+    auto runStartMessage = runStartTemplate.createMessage(runData);
+    auto verifier = flatbuffers::Verifier(
+        reinterpret_cast<const uint8_t *>(runStartMessage.data()),
+        runStartMessage.size());
+    EXPECT_TRUE(VerifyRunStartBuffer(verifier));
+    auto outputRunData = deserialiseRunStartMessage(
+        reinterpret_cast<const uint8_t *>(runStartMessage.data()));
+    EXPECT_EQ(runData.runID, outputRunData.runID);
+    EXPECT_EQ(runData.jobID, outputRunData.jobID);
+    EXPECT_EQ(runData.filename, outputRunData.filename);
+  }
+}
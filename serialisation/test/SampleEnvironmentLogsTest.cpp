@@ -0,0 +1,142 @@
+#include <f142_logdata_generated.h>
+#include <gtest/gtest.h>
+#include <se00_data_generated.h>
+
+#include "SampleEnvironmentLogs.h"
+
+class SampleEnvironmentLogsTest : public ::testing::Test {
+public:
+  template <typename T>
+  void decodeSampleEnvMessage(Streamer::Message &messageBuffer,
+                              const std::string &inputName, T inputValue,
+                              uint64_t inputTimestamp) {
+    auto messageData =
+        GetLogData(reinterpret_cast<const uint8_t *>(messageBuffer.data()));
+    std::string name = messageData->source_name()->str();
+
+    EXPECT_EQ(inputName, name);
+    EXPECT_EQ(inputTimestamp, messageData->timestamp());
+
+    if (messageData->value_type() == Value::Int) {
+      auto value = static_cast<const Int *>(messageData->value());
+      EXPECT_EQ(inputValue, value->value());
+    } else if (messageData->value_type() == Value::Long) {
+      auto value = static_cast<const Long *>(messageData->value());
+      EXPECT_EQ(inputValue, value->value());
+    } else if (messageData->value_type() == Value::Double) {
+      auto value = static_cast<const Double *>(messageData->value());
+      EXPECT_EQ(inputValue, value->value());
+    } else if (messageData->value_type() == Value::UInt) {
+      auto value = static_cast<const UInt *>(messageData->value());
+      EXPECT_EQ(inputValue, value->value());
+    } else if (messageData->value_type() == Value::ULong) {
+      auto value = static_cast<const ULong *>(messageData->value());
+      EXPECT_EQ(inputValue, value->value());
+    } else {
+      throw std::runtime_error(
+          "Unexpected PV type which is not supported by this client");
+    }
+  }
+
+  template <typename T>
+  void testSerialiseSample(T value, const std::string &name = "TEMP_1") {
+    uint64_t runStart = 1000;
+    SampleEnvironmentLogs logs(runStart);
+    SampleEnvironmentLog log;
+    log.nameID = logs.internName(name);
+    log.times = {0.242f};
+    log.values = std::vector<T>{value};
+    auto logIndex = logs.addLog(std::move(log));
+    logs.addSample(0, {logIndex, 0});
+    logs.buildFrameIndex();
+
+    auto samples = logs.getSamplesInFrame(0);
+    ASSERT_EQ(1, samples.size());
+    auto buffer = logs.getBuffer(*samples.begin());
+    decodeSampleEnvMessage(buffer, name, value,
+                           static_cast<uint64_t>(0.242f * 1e9) + runStart);
+  }
+};
+
+TEST_F(SampleEnvironmentLogsTest, get_int_sample) {
+  testSerialiseSample(std::numeric_limits<int32_t>::max());
+}
+
+TEST_F(SampleEnvironmentLogsTest, get_long_sample) {
+  testSerialiseSample(std::numeric_limits<int64_t>::max());
+}
+
+TEST_F(SampleEnvironmentLogsTest, get_double_sample) {
+  testSerialiseSample(42.12);
+}
+
+TEST_F(SampleEnvironmentLogsTest, get_uint_sample) {
+  testSerialiseSample(std::numeric_limits<uint32_t>::max());
+}
+
+TEST_F(SampleEnvironmentLogsTest, get_ulong_sample) {
+  testSerialiseSample(std::numeric_limits<uint64_t>::max());
+}
+
+TEST_F(SampleEnvironmentLogsTest, log_names_are_interned) {
+  SampleEnvironmentLogs logs;
+  auto firstID = logs.internName("TEMP_1");
+  auto secondID = logs.internName("TEMP_2");
+  EXPECT_NE(firstID, secondID);
+  EXPECT_EQ(firstID, logs.internName("TEMP_1"));
+  EXPECT_EQ("TEMP_2", logs.getName(secondID));
+}
+
+TEST_F(SampleEnvironmentLogsTest,
+       samples_are_grouped_by_frame_in_the_order_they_were_added) {
+  SampleEnvironmentLogs logs;
+  SampleEnvironmentLog firstLog;
+  firstLog.nameID = logs.internName("TEMP_1");
+  firstLog.times = {0.05f, 0.15f, 0.25f};
+  firstLog.values = std::vector<double>{1.0, 2.0, 3.0};
+  auto firstLogIndex = logs.addLog(std::move(firstLog));
+  logs.addSample(0, {firstLogIndex, 0});
+  logs.addSample(1, {firstLogIndex, 1});
+  logs.addSample(2, {firstLogIndex, 2});
+
+  SampleEnvironmentLog secondLog;
+  secondLog.nameID = logs.internName("TEMP_2");
+  secondLog.times = {0.12f};
+  secondLog.values = std::vector<int32_t>{7};
+  auto secondLogIndex = logs.addLog(std::move(secondLog));
+  logs.addSample(1, {secondLogIndex, 0});
+  logs.buildFrameIndex();
+
+  EXPECT_EQ(4, logs.getNumberOfSamples());
+  auto frameSamples = logs.getSamplesInFrame(1);
+  ASSERT_EQ(2, frameSamples.size());
+  EXPECT_EQ(firstLogIndex, frameSamples.begin()[0].logIndex);
+  EXPECT_EQ(1, frameSamples.begin()[0].sampleIndex);
+  EXPECT_EQ(secondLogIndex, frameSamples.begin()[1].logIndex);
+  EXPECT_TRUE(logs.getSamplesInFrame(3).empty());
+}
+
+TEST_F(SampleEnvironmentLogsTest, batch_of_samples_is_serialised_as_arrays) {
+  uint64_t runStart = 1000;
+  SampleEnvironmentLogs logs(runStart);
+  SampleEnvironmentLog log;
+  log.nameID = logs.internName("TEMP_1");
+  log.times = {0.1f, 0.2f, 0.3f};
+  log.values = std::vector<int64_t>{10, 20, 30};
+  auto logIndex = logs.addLog(std::move(log));
+
+  auto buffer = logs.getBatchBuffer(logIndex, {1, 2}, 7);
+  auto messageData = GetSampleEnvironmentData(
+      reinterpret_cast<const uint8_t *>(buffer.data()));
+  EXPECT_EQ("TEMP_1", messageData->name()->str());
+  EXPECT_EQ(7, messageData->message_counter());
+  ASSERT_EQ(ValueUnion::Int64Array, messageData->values_type());
+  auto values = messageData->values_as_Int64Array()->value();
+  ASSERT_EQ(2, values->size());
+  EXPECT_EQ(20, values->Get(0));
+  EXPECT_EQ(30, values->Get(1));
+  auto timestamps = messageData->timestamps();
+  ASSERT_EQ(2, timestamps->size());
+  EXPECT_EQ(static_cast<int64_t>(0.2f * 1e9) + runStart, timestamps->Get(0));
+  EXPECT_EQ(messageData->packet_timestamp(), timestamps->Get(0));
+}